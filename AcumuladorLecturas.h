@@ -0,0 +1,318 @@
+/**
+ * @file AcumuladorLecturas.h
+ * @brief Agregados incrementales (conteo, suma, varianza, extremos) de un historial
+ * @author Eliezer Mores Oyervides
+ * @date 2025
+ */
+
+#ifndef ACUMULADORLECTURAS_H
+#define ACUMULADORLECTURAS_H
+
+#include <type_traits>
+
+/**
+ * @struct SumaCompensada
+ * @brief Suma en double con compensación de Neumaier
+ *
+ * Guarda el error de redondeo de cada suma en un término aparte, de modo
+ * que agregar y luego restar la misma lectura deja el total intacto.
+ */
+struct SumaCompensada {
+    double suma;          ///< Suma aproximada
+    double compensacion;  ///< Error acumulado pendiente de sumar
+
+    SumaCompensada() : suma(0.0), compensacion(0.0) {}
+
+    /**
+     * @brief Agrega un término a la suma
+     * @param x Término a sumar (negativo para restar)
+     */
+    void agregar(double x) {
+        double t = suma + x;
+        if ((suma >= 0 ? suma : -suma) >= (x >= 0 ? x : -x)) {
+            compensacion += (suma - t) + x;
+        } else {
+            compensacion += (x - t) + suma;
+        }
+        suma = t;
+    }
+
+    /**
+     * @brief Valor de la suma corregida
+     */
+    double valor() const {
+        return suma + compensacion;
+    }
+};
+
+/**
+ * @struct SumaEntera
+ * @brief Suma exacta para lecturas enteras en un acumulador ancho
+ */
+struct SumaEntera {
+    long long suma; ///< Suma exacta
+
+    SumaEntera() : suma(0) {}
+
+    /**
+     * @brief Agrega un término a la suma
+     * @param x Término a sumar (negativo para restar)
+     */
+    void agregar(long long x) {
+        suma += x;
+    }
+
+    /**
+     * @brief Valor de la suma
+     */
+    long long valor() const {
+        return suma;
+    }
+};
+
+/**
+ * @class AcumuladorLecturas
+ * @brief Mantiene conteo, suma, varianza, mínimo y máximo de forma incremental
+ * @tparam T Tipo de lectura
+ *
+ * Las lecturas enteras se suman en un long long exacto; las de punto
+ * flotante con suma compensada. La varianza se obtiene de las sumas de
+ * (x - K) y (x - K)², donde K es la primera lectura, para evitar la
+ * cancelación cuando la media es grande frente a la dispersión.
+ *
+ * El mínimo y el máximo los mantiene el dueño: al quitar una lectura que
+ * era un extremo, quien la quita debe indicar el nuevo valor (o invalidarlo).
+ */
+template <typename T>
+class AcumuladorLecturas {
+private:
+    typedef typename std::conditional<std::is_integral<T>::value,
+                                      SumaEntera, SumaCompensada>::type Suma;
+    typedef typename std::conditional<std::is_integral<T>::value,
+                                      long long, double>::type Ancho;
+
+    long cantidad;             ///< Número de lecturas acumuladas
+    Suma suma;                 ///< Suma exacta / compensada de las lecturas
+    T referencia;              ///< Desplazamiento K para la varianza
+    SumaCompensada sumaDesp;   ///< Suma de (x - K)
+    SumaCompensada sumaCuad;   ///< Suma de (x - K)²
+    T minimo;                  ///< Menor lectura acumulada
+    T maximo;                  ///< Mayor lectura acumulada
+    bool extremosValidos;      ///< false si min/max deben recalcularse
+
+public:
+    /**
+     * @brief Constructor por defecto (acumulador vacío)
+     */
+    AcumuladorLecturas() : cantidad(0), referencia(T(0)), minimo(T(0)), maximo(T(0)),
+                           extremosValidos(true) {}
+
+    /**
+     * @brief Registra una lectura nueva
+     * @param x Lectura
+     */
+    void agregar(T x) {
+        if (cantidad == 0) {
+            referencia = x;
+            minimo = x;
+            maximo = x;
+            extremosValidos = true;
+        } else if (extremosValidos) {
+            if (x < minimo) minimo = x;
+            if (maximo < x) maximo = x;
+        }
+        cantidad++;
+        suma.agregar((Ancho)x);
+        double d = (double)x - (double)referencia;
+        sumaDesp.agregar(d);
+        sumaCuad.agregar(d * d);
+    }
+
+    /**
+     * @brief Retira una lectura previamente agregada
+     * @param x Lectura a retirar
+     *
+     * Si x era el mínimo o el máximo los extremos quedan invalidados
+     * hasta que el dueño llame a establecerExtremos().
+     */
+    void quitar(T x) {
+        cantidad--;
+        if (cantidad == 0) {
+            *this = AcumuladorLecturas();
+            return;
+        }
+        suma.agregar(-(Ancho)x);
+        double d = (double)x - (double)referencia;
+        sumaDesp.agregar(-d);
+        sumaCuad.agregar(-(d * d));
+        if (!(minimo < x) || !(x < maximo)) {
+            extremosValidos = false;
+        }
+    }
+
+    /**
+     * @brief Incorpora las lecturas resumidas en otro acumulador, O(1)
+     * @param otro Acumulador de otro conjunto de lecturas
+     *
+     * Las sumas de desplazamientos del otro se trasladan a la referencia
+     * propia: sum(x - K) = sum(x - K') + n'(K' - K) y el cuadrado análogo.
+     */
+    void combinar(const AcumuladorLecturas& otro) {
+        if (otro.cantidad == 0) return;
+        if (cantidad == 0) {
+            *this = otro;
+            return;
+        }
+        double delta = (double)otro.referencia - (double)referencia;
+        double desp = otro.sumaDesp.valor();
+        double n = (double)otro.cantidad;
+        sumaDesp.agregar(desp);
+        sumaDesp.agregar(n * delta);
+        sumaCuad.agregar(otro.sumaCuad.valor());
+        sumaCuad.agregar(2.0 * delta * desp);
+        sumaCuad.agregar(n * delta * delta);
+        suma.agregar(otro.suma.valor());
+        cantidad += otro.cantidad;
+        if (extremosValidos && otro.extremosValidos) {
+            if (otro.minimo < minimo) minimo = otro.minimo;
+            if (maximo < otro.maximo) maximo = otro.maximo;
+        } else {
+            extremosValidos = false;
+        }
+    }
+
+    /**
+     * @brief Fija los extremos tras una eliminación
+     * @param min Nuevo mínimo
+     * @param max Nuevo máximo
+     */
+    void establecerExtremos(T min, T max) {
+        minimo = min;
+        maximo = max;
+        extremosValidos = true;
+    }
+
+    /**
+     * @brief Vacía el acumulador
+     */
+    void reiniciar() {
+        *this = AcumuladorLecturas();
+    }
+
+    /**
+     * @brief Número de lecturas acumuladas
+     */
+    long getCantidad() const {
+        return cantidad;
+    }
+
+    /**
+     * @brief Suma de las lecturas (exacta para enteros)
+     */
+    Ancho getSuma() const {
+        return suma.valor();
+    }
+
+    /**
+     * @brief Media aritmética en double
+     */
+    double media() const {
+        return cantidad == 0 ? 0.0 : (double)suma.valor() / (double)cantidad;
+    }
+
+    /**
+     * @brief Varianza poblacional de las lecturas
+     */
+    double varianza() const {
+        if (cantidad == 0) return 0.0;
+        double m = sumaDesp.valor() / (double)cantidad;
+        double v = sumaCuad.valor() / (double)cantidad - m * m;
+        return v < 0.0 ? 0.0 : v;
+    }
+
+    /**
+     * @brief Indica si el mínimo y el máximo están al día
+     */
+    bool extremosAlDia() const {
+        return extremosValidos;
+    }
+
+    /**
+     * @brief Menor lectura (válido si extremosAlDia())
+     */
+    T getMinimo() const {
+        return minimo;
+    }
+
+    /**
+     * @brief Mayor lectura (válido si extremosAlDia())
+     */
+    T getMaximo() const {
+        return maximo;
+    }
+};
+
+/**
+ * @struct VentanaLecturas
+ * @brief Conteo, suma y extremos de las lecturas de un intervalo de tiempo
+ * @tparam T Tipo de lectura
+ *
+ * Lo llenan ListaSensor::consultarVentana() y SerieComprimida::consultarVentana():
+ * lectura a lectura en los bloques que cruzan un borde del intervalo y con
+ * un solo tramo (agregarTramo) por cada bloque que cae entero dentro.
+ */
+template <typename T>
+struct VentanaLecturas {
+    typedef typename std::conditional<std::is_integral<T>::value,
+                                      long long, double>::type Ancho;
+
+    long cantidad;        ///< Lecturas en el intervalo
+    Ancho suma;           ///< Suma de esas lecturas (exacta para enteros)
+    T minimo;             ///< Menor lectura (T(0) si no hay)
+    T maximo;             ///< Mayor lectura (T(0) si no hay)
+    long long primera;    ///< Marca en ms de la primera lectura del intervalo
+    long long ultima;     ///< Marca en ms de la última lectura del intervalo
+
+    VentanaLecturas() : cantidad(0), suma(0), minimo(T(0)), maximo(T(0)), primera(0), ultima(0) {}
+
+    /**
+     * @brief Agrega una lectura (las marcas deben llegar en orden)
+     * @param x Lectura
+     * @param marca Milisegundos de la lectura
+     */
+    void agregar(T x, long long marca) {
+        agregarTramo(1, (Ancho)x, x, x, marca, marca);
+    }
+
+    /**
+     * @brief Agrega un bloque de lecturas ya resumido
+     * @param n Lecturas del bloque (> 0)
+     * @param sumaTramo Suma del bloque
+     * @param min Menor lectura del bloque
+     * @param max Mayor lectura del bloque
+     * @param desde Marca de la primera lectura del bloque
+     * @param hasta Marca de la última lectura del bloque
+     */
+    void agregarTramo(long n, Ancho sumaTramo, T min, T max, long long desde, long long hasta) {
+        if (cantidad == 0) {
+            minimo = min;
+            maximo = max;
+            primera = desde;
+        } else {
+            if (min < minimo) minimo = min;
+            if (maximo < max) maximo = max;
+        }
+        ultima = hasta;
+        cantidad += n;
+        suma += sumaTramo;
+    }
+
+    /**
+     * @brief Media de las lecturas del intervalo (0 si no hay)
+     */
+    double media() const {
+        return cantidad == 0 ? 0.0 : (double)suma / (double)cantidad;
+    }
+};
+
+#endif // ACUMULADORLECTURAS_H
@@ -0,0 +1,183 @@
+/**
+ * @file AlmacenPersistente.h
+ * @brief Directorio de segmentos: restaura los sensores al arrancar y persiste los nuevos
+ * @author Eliezer Mores Oyervides
+ * @date 2025
+ *
+ * Cada sensor tiene un archivo "<nombre>.seg" (SegmentoSensor.h) en el
+ * directorio de datos. Al arrancar, restaurar() abre y proyecta cada
+ * segmento y registra un sensor del tipo guardado en la cabecera, con la
+ * retención, la compresión y los resúmenes que tenía al cerrarse; las
+ * lecturas se incorporan al historial la primera vez que se usa el sensor,
+ * así que el arranque depende del número de sensores y no del de lecturas.
+ */
+
+#ifndef ALMACENPERSISTENTE_H
+#define ALMACENPERSISTENTE_H
+
+#include "ListaGestion.h"
+#include "SensorTemperatura.h"
+#include "SensorPresion.h"
+#include "SegmentoSensor.h"
+#include "Registro.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <sys/stat.h>
+
+/**
+ * @class AlmacenPersistente
+ * @brief Vincula los sensores de una ListaGestion con sus archivos de segmento
+ */
+class AlmacenPersistente {
+private:
+    static const int MAX_RUTA = 512;
+
+    ListaGestion& gestor;       ///< Sensores persistidos
+    char directorio[256];       ///< Directorio de datos
+
+    /**
+     * @brief Arma la ruta del segmento de un sensor
+     *
+     * Los caracteres que no son letras, dígitos, '-', '_' o '.' se
+     * reemplazan por '_'; el nombre real se guarda en la cabecera.
+     */
+    void rutaSegmento(const char* nombre, char* ruta) const {
+        char archivo[64];
+        int n = 0;
+        for (int i = 0; nombre[i] != '\0' && n < 47; i++) {
+            char c = nombre[i];
+            bool valido = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                          (c >= '0' && c <= '9') || c == '-' || c == '_' || c == '.';
+            archivo[n++] = valido ? c : '_';
+        }
+        archivo[n] = '\0';
+        snprintf(ruta, MAX_RUTA, "%s/%s.seg", directorio, archivo);
+    }
+
+public:
+    /**
+     * @brief Constructor - crea el directorio si no existe
+     * @param g Lista de gestión donde se restauran y desde donde se persisten los sensores
+     * @param dir Directorio de datos
+     */
+    AlmacenPersistente(ListaGestion& g, const char* dir) : gestor(g) {
+        strncpy(directorio, dir, sizeof(directorio) - 1);
+        directorio[sizeof(directorio) - 1] = '\0';
+        mkdir(directorio, 0755);
+    }
+
+    /**
+     * @brief Restaura en la lista los sensores de todos los segmentos del directorio
+     * @return Número de sensores restaurados
+     *
+     * Los sensores se registran en el orden en que se crearon originalmente,
+     * así conservan sus handles. Los segmentos ilegibles se ignoran con un aviso.
+     */
+    int restaurar() {
+        DIR* d = opendir(directorio);
+        if (d == nullptr) {
+            REGISTRO_ERROR("No se pudo abrir el directorio de datos " << directorio);
+            return 0;
+        }
+        int capacidad = 16;
+        int cantidad = 0;
+        SegmentoSensor** segmentos = new SegmentoSensor*[capacidad];
+        struct dirent* entrada;
+        while ((entrada = readdir(d)) != nullptr) {
+            int len = (int)strlen(entrada->d_name);
+            if (len < 5 || strcmp(entrada->d_name + len - 4, ".seg") != 0) continue;
+            char ruta[MAX_RUTA];
+            snprintf(ruta, MAX_RUTA, "%s/%s", directorio, entrada->d_name);
+            SegmentoSensor* s = new SegmentoSensor();
+            if (!s->recuperar(ruta)) {
+                REGISTRO_AVISO("Se ignora " << ruta << ": no es un segmento válido");
+                delete s;
+                continue;
+            }
+            if (cantidad == capacidad) {
+                SegmentoSensor** ampliado = new SegmentoSensor*[capacidad * 2];
+                for (int i = 0; i < cantidad; i++) {
+                    ampliado[i] = segmentos[i];
+                }
+                delete[] segmentos;
+                segmentos = ampliado;
+                capacidad *= 2;
+            }
+            segmentos[cantidad++] = s;
+        }
+        closedir(d);
+
+        std::sort(segmentos, segmentos + cantidad, [](const SegmentoSensor* a, const SegmentoSensor* b) {
+            return a->getOrden() < b->getOrden();
+        });
+        for (int i = 0; i < cantidad; i++) {
+            SensorBase* sensor;
+            if (segmentos[i]->getTipo() == 'f') {
+                sensor = new SensorTemperatura(segmentos[i]->getNombre());
+            } else {
+                sensor = new SensorPresion(segmentos[i]->getNombre());
+            }
+            // Antes de adjuntar: las lecturas recuperadas entran ya con la configuración
+            sensor->establecerRetencion(segmentos[i]->getMaxLecturas(), segmentos[i]->getMaxSegundos());
+            if (segmentos[i]->getOpciones() & SEGMENTO_COMPRIMIDO) {
+                sensor->activarCompresion();
+            }
+            if (segmentos[i]->getOpciones() & SEGMENTO_RESUMENES) {
+                sensor->activarResumenes();
+            }
+            sensor->adjuntarSegmento(segmentos[i]);
+            gestor.insertar(sensor);
+        }
+        delete[] segmentos;
+        return cantidad;
+    }
+
+    /**
+     * @brief Crea el segmento de un sensor nuevo
+     * @param sensor Sensor recién insertado en la lista
+     * @return true si el sensor quedó persistido
+     *
+     * Si ya existe un segmento con ese nombre (otro sensor homónimo), el
+     * sensor nuevo no se persiste.
+     */
+    bool adjuntar(SensorBase* sensor) {
+        char ruta[MAX_RUTA];
+        rutaSegmento(sensor->getNombre(), ruta);
+        SegmentoSensor* s = new SegmentoSensor();
+        if (!s->crear(ruta, sensor->getNombre(), sensor->getTipo(), gestor.getTamanio())) {
+            REGISTRO_AVISO("No se pudo crear " << ruta << "; el sensor " << sensor->getNombre()
+                           << " no se persistirá");
+            delete s;
+            return false;
+        }
+        sensor->adjuntarSegmento(s);
+        return true;
+    }
+
+    /**
+     * @brief Escribe en disco los lotes pendientes de todos los sensores
+     * @param confirmar true para además sincronizar y actualizar las cabeceras
+     */
+    void sincronizar(bool confirmar = false) {
+        for (int i = 0; i < gestor.getTamanio(); i++) {
+            SegmentoSensor* s = gestor.obtener(i)->getSegmento();
+            if (s == nullptr) continue;
+            if (confirmar) {
+                s->confirmar();
+            } else {
+                s->volcar();
+            }
+        }
+    }
+
+    /**
+     * @brief Directorio de datos
+     */
+    const char* getDirectorio() const {
+        return directorio;
+    }
+};
+
+#endif // ALMACENPERSISTENTE_H
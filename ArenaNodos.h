@@ -0,0 +1,303 @@
+/**
+ * @file ArenaNodos.h
+ * @brief Reservador por bloques (slab) para los nodos de las listas enlazadas
+ * @author Eliezer Mores Oyervides
+ * @date 2025
+ */
+
+#ifndef ARENANODOS_H
+#define ARENANODOS_H
+
+#include <new>
+#include <utility>
+
+/**
+ * @struct EstadisticasArena
+ * @brief Resumen del uso de memoria de una ArenaNodos
+ */
+struct EstadisticasArena {
+    long nodosVivos;       ///< Nodos entregados y aún no devueltos
+    long nodosLibres;      ///< Celdas reservadas disponibles (lista libre + sin estrenar)
+    long bloques;          ///< Bloques grandes pedidos al sistema
+    long bytesReservados;  ///< Bytes totales pedidos al sistema
+    double fragmentacion;  ///< Fracción de las celdas estrenadas que quedaron como huecos libres (0..1)
+};
+
+/**
+ * @class ArenaNodos
+ * @brief Arena que reparte nodos desde bloques grandes y los recicla con una lista libre
+ * @tparam Nodo Tipo de nodo a construir en la arena
+ *
+ * Cada lista posee su propia arena: los nodos se construyen dentro de bloques
+ * de tamaño creciente (8, 16, 32... hasta MAX_CELDAS celdas), los nodos
+ * devueltos se encadenan en una lista libre para reutilizarse, y todo el
+ * historial se libera devolviendo solo los bloques, en O(bloques).
+ *
+ * Una arena puede moverse o absorber a otra (absorber()): los nodos
+ * siguen en la misma dirección, así que las listas pueden ceder sus nodos
+ * sin copiarlos.
+ */
+template <typename Nodo>
+class ArenaNodos {
+private:
+    /**
+     * @union Celda
+     * @brief Espacio para un nodo o, si está libre, enlace al siguiente libre
+     */
+    union Celda {
+        Celda* siguienteLibre;                        ///< Enlace en la lista libre
+        alignas(Nodo) unsigned char memoria[sizeof(Nodo)]; ///< Almacenamiento del nodo
+    };
+
+    /**
+     * @struct Bloque
+     * @brief Cabecera de un bloque grande; las celdas van a continuación
+     */
+    struct Bloque {
+        Bloque* siguiente; ///< Bloque reservado anteriormente
+        int capacidad;     ///< Número de celdas del bloque
+    };
+
+    static const int MIN_CELDAS = 8;    ///< Celdas del primer bloque
+    static const int MAX_CELDAS = 4096; ///< Tope de celdas por bloque
+
+    Bloque* bloques;     ///< Bloque más reciente (cabeza de la cadena de bloques)
+    Bloque* primerBloque; ///< Bloque más antiguo (final de la cadena), para encadenar otra arena
+    Celda* libres;       ///< Lista libre de celdas devueltas
+    Celda* ultimoLibre;  ///< Final de la lista libre
+    int usadasUltimo;    ///< Celdas ya estrenadas del bloque más reciente
+    long nodosVivos;     ///< Nodos actualmente en uso
+    long huecos;         ///< Celdas en la lista libre
+    long capacidadTotal; ///< Suma de celdas de todos los bloques
+    long numBloques;     ///< Número de bloques reservados
+    long bytesTotales;   ///< Bytes pedidos al sistema
+
+    /**
+     * @brief Obtiene la celda i de un bloque
+     */
+    static Celda* celda(Bloque* b, int i) {
+        return reinterpret_cast<Celda*>(reinterpret_cast<unsigned char*>(b) + desplazamiento()) + i;
+    }
+
+    /**
+     * @brief Desplazamiento de la primera celda respecto a la cabecera del bloque
+     */
+    static long desplazamiento() {
+        long a = alignof(Celda);
+        return ((long)sizeof(Bloque) + a - 1) / a * a;
+    }
+
+    /**
+     * @brief Alineación con la que se piden los bloques
+     */
+    static std::align_val_t alineacion() {
+        return std::align_val_t(alignof(Celda) > alignof(Bloque) ? alignof(Celda) : alignof(Bloque));
+    }
+
+    /**
+     * @brief Reserva un bloque nuevo, el doble de grande que el anterior
+     */
+    void nuevoBloque() {
+        int capacidad = bloques == nullptr ? MIN_CELDAS : bloques->capacidad * 2;
+        if (capacidad > MAX_CELDAS) capacidad = MAX_CELDAS;
+
+        long bytes = desplazamiento() + (long)capacidad * (long)sizeof(Celda);
+        Bloque* b = static_cast<Bloque*>(::operator new(bytes, alineacion()));
+        if (bloques == nullptr) {
+            primerBloque = b;
+        }
+        b->siguiente = bloques;
+        b->capacidad = capacidad;
+        bloques = b;
+        usadasUltimo = 0;
+        capacidadTotal += capacidad;
+        numBloques++;
+        bytesTotales += bytes;
+    }
+
+    /**
+     * @brief Deja la arena vacía sin liberar nada (sus bloques pasaron a otra)
+     */
+    void soltar() {
+        bloques = nullptr;
+        primerBloque = nullptr;
+        libres = nullptr;
+        ultimoLibre = nullptr;
+        usadasUltimo = 0;
+        nodosVivos = 0;
+        huecos = 0;
+        capacidadTotal = 0;
+        numBloques = 0;
+        bytesTotales = 0;
+    }
+
+    /**
+     * @brief Toma los bloques y contadores de otra arena
+     */
+    void tomar(ArenaNodos& otra) {
+        bloques = otra.bloques;
+        primerBloque = otra.primerBloque;
+        libres = otra.libres;
+        ultimoLibre = otra.ultimoLibre;
+        usadasUltimo = otra.usadasUltimo;
+        nodosVivos = otra.nodosVivos;
+        huecos = otra.huecos;
+        capacidadTotal = otra.capacidadTotal;
+        numBloques = otra.numBloques;
+        bytesTotales = otra.bytesTotales;
+        otra.soltar();
+    }
+
+    /**
+     * @brief Agrega una celda a la lista libre
+     */
+    void liberarCelda(Celda* c) {
+        if (libres == nullptr) {
+            ultimoLibre = c;
+        }
+        c->siguienteLibre = libres;
+        libres = c;
+        huecos++;
+    }
+
+public:
+    /**
+     * @brief Constructor por defecto (no reserva memoria hasta el primer nodo)
+     */
+    ArenaNodos() : bloques(nullptr), primerBloque(nullptr), libres(nullptr), ultimoLibre(nullptr),
+                   usadasUltimo(0), nodosVivos(0), huecos(0), capacidadTotal(0), numBloques(0),
+                   bytesTotales(0) {}
+
+    /**
+     * @brief Destructor - Devuelve todos los bloques al sistema
+     */
+    ~ArenaNodos() {
+        liberarTodo();
+    }
+
+    ArenaNodos(const ArenaNodos&) = delete;
+    ArenaNodos& operator=(const ArenaNodos&) = delete;
+
+    /**
+     * @brief Constructor de movimiento: los nodos de otra pasan a esta arena sin moverse
+     * @param otra Arena que queda vacía
+     */
+    ArenaNodos(ArenaNodos&& otra) noexcept {
+        tomar(otra);
+    }
+
+    /**
+     * @brief Asignación de movimiento: libera los bloques propios y toma los de otra
+     * @param otra Arena que queda vacía
+     * @return Referencia a esta arena
+     */
+    ArenaNodos& operator=(ArenaNodos&& otra) noexcept {
+        if (this != &otra) {
+            liberarTodo();
+            tomar(otra);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Adopta los bloques de otra arena; sus nodos pasan a pertenecer a esta
+     * @param otra Arena que queda vacía
+     *
+     * Las cadenas de bloques y las listas libres se enlazan en O(1). Las
+     * celdas aún sin estrenar del bloque actual de la otra arena (a lo sumo
+     * MAX_CELDAS) pasan a la lista libre para que no queden perdidas.
+     */
+    void absorber(ArenaNodos& otra) {
+        if (this == &otra || otra.bloques == nullptr) return;
+        if (bloques == nullptr) {
+            tomar(otra);
+            return;
+        }
+        for (int i = otra.usadasUltimo; i < otra.bloques->capacidad; i++) {
+            otra.liberarCelda(celda(otra.bloques, i));
+        }
+        primerBloque->siguiente = otra.bloques;
+        primerBloque = otra.primerBloque;
+        if (otra.libres != nullptr) {
+            if (libres == nullptr) {
+                libres = otra.libres;
+            } else {
+                ultimoLibre->siguienteLibre = otra.libres;
+            }
+            ultimoLibre = otra.ultimoLibre;
+        }
+        nodosVivos += otra.nodosVivos;
+        huecos += otra.huecos;
+        capacidadTotal += otra.capacidadTotal;
+        numBloques += otra.numBloques;
+        bytesTotales += otra.bytesTotales;
+        otra.soltar();
+    }
+
+    /**
+     * @brief Construye un nodo dentro de la arena
+     * @param args Argumentos para el constructor del nodo
+     * @return Puntero al nodo construido
+     */
+    template <typename... Args>
+    Nodo* crear(Args&&... args) {
+        Celda* c;
+        if (libres != nullptr) {
+            c = libres;
+            libres = libres->siguienteLibre;
+            if (libres == nullptr) {
+                ultimoLibre = nullptr;
+            }
+            huecos--;
+        } else {
+            if (bloques == nullptr || usadasUltimo == bloques->capacidad) {
+                nuevoBloque();
+            }
+            c = celda(bloques, usadasUltimo++);
+        }
+        nodosVivos++;
+        return new (c->memoria) Nodo(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Destruye un nodo y deja su celda en la lista libre
+     * @param nodo Nodo obtenido previamente con crear()
+     */
+    void destruir(Nodo* nodo) {
+        nodo->~Nodo();
+        liberarCelda(reinterpret_cast<Celda*>(nodo));
+        nodosVivos--;
+    }
+
+    /**
+     * @brief Devuelve todos los bloques al sistema en O(bloques)
+     *
+     * No invoca destructores: el dueño de la arena debe haber destruido
+     * los nodos que lo requieran antes de llamar a este método.
+     */
+    void liberarTodo() {
+        while (bloques != nullptr) {
+            Bloque* temp = bloques;
+            bloques = bloques->siguiente;
+            ::operator delete(temp, alineacion());
+        }
+        soltar();
+    }
+
+    /**
+     * @brief Obtiene las estadísticas de uso de la arena
+     * @return Estructura con nodos vivos, bytes reservados y fragmentación
+     */
+    EstadisticasArena estadisticas() const {
+        EstadisticasArena e;
+        e.nodosVivos = nodosVivos;
+        e.nodosLibres = capacidadTotal - nodosVivos;
+        e.bloques = numBloques;
+        e.bytesReservados = bytesTotales;
+        e.fragmentacion = nodosVivos + huecos == 0 ? 0.0
+                        : (double)huecos / (double)(nodosVivos + huecos);
+        return e;
+    }
+};
+
+#endif // ARENANODOS_H
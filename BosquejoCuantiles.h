@@ -0,0 +1,385 @@
+/**
+ * @file BosquejoCuantiles.h
+ * @brief Bosquejo KLL de cuantiles: percentiles aproximados de un flujo sin límite, combinable
+ * @author Eliezer Mores Oyervides
+ * @date 2025
+ */
+
+#ifndef BOSQUEJOCUANTILES_H
+#define BOSQUEJOCUANTILES_H
+
+#include <algorithm>
+#include <cstdint>
+
+/**
+ * @class BosquejoCuantiles
+ * @brief Resume un flujo de lecturas en unas 3·K muestras ponderadas (KLL)
+ *
+ * Las muestras se guardan por niveles: una muestra del nivel h representa
+ * 2^h lecturas. Cuando un nivel llena su capacidad se ordena y la mitad de
+ * sus muestras (las de posición par o impar, al azar) sube al nivel
+ * siguiente con el doble de peso. Las capacidades decrecen en 2/3 hacia
+ * los niveles bajos (mínimo 8), de modo que la memoria queda en unas 3·K
+ * muestras sin importar cuántas lecturas se agreguen.
+ *
+ * Con K = 200 el error de rango es del orden de 1% de las lecturas (un p99
+ * estimado cae entre el p98 y el p100 reales); mínimo y máximo son exactos.
+ * agregar() cuesta O(1) amortizado, cuantil() O(s log s) con s muestras
+ * guardadas, y combinar() junta dos bosquejos en uno que resume la unión
+ * de ambos flujos con el mismo error (percentiles de toda la flota).
+ */
+class BosquejoCuantiles {
+public:
+    static const int K = 200;            ///< Capacidad del nivel más alto
+    static const int MIN_CAPACIDAD = 8;  ///< Capacidad mínima de un nivel
+    static const int MAX_NIVELES = 48;   ///< Pesos de hasta 2^47 lecturas por muestra
+
+private:
+    /**
+     * @struct Muestra
+     * @brief Valor y peso usados al consultar
+     */
+    struct Muestra {
+        double valor;
+        long long peso;
+
+        bool operator<(const Muestra& otra) const {
+            return valor < otra.valor;
+        }
+    };
+
+    double* niveles[MAX_NIVELES];    ///< Muestras de cada nivel
+    int tamNivel[MAX_NIVELES];       ///< Muestras guardadas por nivel
+    int reservaNivel[MAX_NIVELES];   ///< Capacidad reservada de cada arreglo
+    int capacidadNivel[MAX_NIVELES]; ///< Muestras a partir de las cuales se compacta cada nivel
+    int numNiveles;                  ///< Niveles en uso (>= 1)
+    long long cantidad;              ///< Lecturas resumidas
+    double minimo;                   ///< Menor lectura (exacta)
+    double maximo;                   ///< Mayor lectura (exacta)
+    uint64_t azar;                   ///< Estado xorshift para elegir pares o impares
+
+    /**
+     * @brief Recalcula las capacidades al cambiar el número de niveles: K·(2/3)^(altura sobre h)
+     */
+    void calcularCapacidades() {
+        double c = K;
+        for (int h = numNiveles - 1; h >= 0; h--) {
+            capacidadNivel[h] = c > MIN_CAPACIDAD ? (int)c : MIN_CAPACIDAD;
+            c *= 2.0 / 3.0;
+        }
+        for (int h = numNiveles; h < MAX_NIVELES; h++) {
+            capacidadNivel[h] = K;
+        }
+    }
+
+    /**
+     * @brief Asegura lugar para al menos minimo muestras en el nivel h
+     */
+    void reservar(int h, int minimo) {
+        if (minimo <= reservaNivel[h]) return;
+        int nueva = reservaNivel[h] == 0 ? MIN_CAPACIDAD : reservaNivel[h] * 2;
+        if (nueva < minimo) nueva = minimo;
+        double* ampliado = new double[nueva];
+        for (int i = 0; i < tamNivel[h]; i++) {
+            ampliado[i] = niveles[h][i];
+        }
+        delete[] niveles[h];
+        niveles[h] = ampliado;
+        reservaNivel[h] = nueva;
+    }
+
+    /**
+     * @brief Mezcla en el nivel h (ordenado) las muestras origen[inicio], origen[inicio + paso], ...
+     * @param fin Índice límite en origen (exclusivo)
+     *
+     * Los niveles superiores al 0 se mantienen ordenados, así que compactarlos
+     * no requiere ordenar: basta mezclar desde el final, sin búfer auxiliar.
+     */
+    void mezclar(int h, const double* origen, int inicio, int fin, int paso) {
+        if (inicio >= fin) return;
+        int m = (fin - inicio + paso - 1) / paso;
+        reservar(h, tamNivel[h] + m);
+        double* d = niveles[h];
+        int i = tamNivel[h] - 1;
+        int j = inicio + (m - 1) * paso;
+        int k = tamNivel[h] + m - 1;
+        // Sin saltos dependientes de los datos: el orden de las muestras es impredecible
+        while (j >= inicio && i >= 0) {
+            bool delNivel = origen[j] < d[i];
+            d[k--] = delNivel ? d[i] : origen[j];
+            i -= delNivel;
+            j -= delNivel ? 0 : paso;
+        }
+        while (j >= inicio) {
+            d[k--] = origen[j];
+            j -= paso;
+        }
+        tamNivel[h] += m;
+    }
+
+    /**
+     * @brief Sube la mitad de las muestras del nivel h al nivel h+1
+     *
+     * Solo el nivel 0, donde se anexan las lecturas, hay que ordenarlo. Si
+     * el nivel tiene un número impar de muestras la menor se queda.
+     */
+    void compactar(int h) {
+        if (h + 1 == numNiveles) {
+            numNiveles++;
+            calcularCapacidades();
+        }
+        double* d = niveles[h];
+        int n = tamNivel[h];
+        if (h == 0) {
+            std::sort(d, d + n);
+        }
+        azar ^= azar << 13;
+        azar ^= azar >> 7;
+        azar ^= azar << 17;
+        int resto = n % 2;
+        mezclar(h + 1, d, resto + (int)(azar & 1), n, 2);
+        tamNivel[h] = resto;
+        // Al crecer el bosquejo las capacidades bajas se reducen: devolver lo que sobra
+        if (reservaNivel[h] > 2 * capacidadNivel[h]) {
+            reservaNivel[h] = capacidadNivel[h];
+            niveles[h] = new double[reservaNivel[h]];
+            if (resto > 0) niveles[h][0] = d[0];
+            delete[] d;
+        }
+    }
+
+    /**
+     * @brief Compacta, de abajo hacia arriba, los niveles desde h que alcanzaron su capacidad
+     */
+    void compactarLlenos(int h) {
+        for (; h < numNiveles && h + 1 < MAX_NIVELES; h++) {
+            if (tamNivel[h] >= capacidadNivel[h]) {
+                compactar(h);
+            }
+        }
+    }
+
+    /**
+     * @brief Copia el contenido de otro bosquejo (this debe estar vacío de arreglos)
+     */
+    void copiar(const BosquejoCuantiles& otro) {
+        for (int h = 0; h < MAX_NIVELES; h++) {
+            capacidadNivel[h] = otro.capacidadNivel[h];
+            tamNivel[h] = otro.tamNivel[h];
+            reservaNivel[h] = otro.tamNivel[h];
+            niveles[h] = nullptr;
+            if (tamNivel[h] > 0) {
+                niveles[h] = new double[tamNivel[h]];
+                for (int i = 0; i < tamNivel[h]; i++) {
+                    niveles[h][i] = otro.niveles[h][i];
+                }
+            }
+        }
+        numNiveles = otro.numNiveles;
+        cantidad = otro.cantidad;
+        minimo = otro.minimo;
+        maximo = otro.maximo;
+        azar = otro.azar;
+    }
+
+    /**
+     * @brief Libera los arreglos de todos los niveles
+     */
+    void liberar() {
+        for (int h = 0; h < MAX_NIVELES; h++) {
+            delete[] niveles[h];
+            niveles[h] = nullptr;
+        }
+    }
+
+public:
+    /**
+     * @brief Constructor (bosquejo vacío, sin memoria reservada)
+     */
+    BosquejoCuantiles() : numNiveles(1), cantidad(0), minimo(0.0), maximo(0.0),
+                          azar(0x9E3779B97F4A7C15ULL) {
+        for (int h = 0; h < MAX_NIVELES; h++) {
+            niveles[h] = nullptr;
+            tamNivel[h] = 0;
+            reservaNivel[h] = 0;
+        }
+        calcularCapacidades();
+    }
+
+    /**
+     * @brief Constructor de copia
+     */
+    BosquejoCuantiles(const BosquejoCuantiles& otro) {
+        copiar(otro);
+    }
+
+    /**
+     * @brief Operador de asignación
+     */
+    BosquejoCuantiles& operator=(const BosquejoCuantiles& otro) {
+        if (this != &otro) {
+            liberar();
+            copiar(otro);
+        }
+        return *this;
+    }
+
+    ~BosquejoCuantiles() {
+        liberar();
+    }
+
+    /**
+     * @brief Agrega una lectura, O(1) amortizado
+     * @param x Lectura
+     */
+    void agregar(double x) {
+        if (cantidad == 0) {
+            minimo = x;
+            maximo = x;
+        } else {
+            if (x < minimo) minimo = x;
+            if (maximo < x) maximo = x;
+        }
+        cantidad++;
+        reservar(0, tamNivel[0] + 1);
+        niveles[0][tamNivel[0]++] = x;
+        if (tamNivel[0] >= capacidadNivel[0]) {
+            compactarLlenos(0);
+        }
+    }
+
+    /**
+     * @brief Incorpora las lecturas resumidas en otro bosquejo
+     * @param otro Bosquejo de otro flujo (p. ej. otro sensor)
+     *
+     * Las muestras de cada nivel se juntan con las del mismo nivel y luego
+     * se compactan los niveles que quedaron llenos.
+     */
+    void combinar(const BosquejoCuantiles& otro) {
+        if (otro.cantidad == 0 || this == &otro) return;
+        if (cantidad == 0) {
+            minimo = otro.minimo;
+            maximo = otro.maximo;
+        } else {
+            if (otro.minimo < minimo) minimo = otro.minimo;
+            if (maximo < otro.maximo) maximo = otro.maximo;
+        }
+        if (otro.numNiveles > numNiveles) {
+            numNiveles = otro.numNiveles;
+            calcularCapacidades();
+        }
+        reservar(0, tamNivel[0] + otro.tamNivel[0]);
+        for (int i = 0; i < otro.tamNivel[0]; i++) {
+            niveles[0][tamNivel[0]++] = otro.niveles[0][i];
+        }
+        for (int h = 1; h < otro.numNiveles; h++) {
+            mezclar(h, otro.niveles[h], 0, otro.tamNivel[h], 1);
+        }
+        cantidad += otro.cantidad;
+        compactarLlenos(0);
+    }
+
+    /**
+     * @brief Estima varios cuantiles con un solo ordenamiento de las muestras
+     * @param q Fracciones pedidas en [0, 1] (0.5 = mediana, 0.99 = p99)
+     * @param resultado Recibe un valor por fracción
+     * @param n Número de fracciones
+     *
+     * 0 y 1 devuelven el mínimo y el máximo exactos; sin lecturas, 0.
+     */
+    void cuantiles(const double* q, double* resultado, int n) const {
+        int total = 0;
+        for (int h = 0; h < numNiveles; h++) {
+            total += tamNivel[h];
+        }
+        if (cantidad == 0 || total == 0) {
+            for (int j = 0; j < n; j++) resultado[j] = 0.0;
+            return;
+        }
+        Muestra* muestras = new Muestra[total];
+        int k = 0;
+        for (int h = 0; h < numNiveles; h++) {
+            for (int i = 0; i < tamNivel[h]; i++) {
+                muestras[k].valor = niveles[h][i];
+                muestras[k].peso = 1LL << h;
+                k++;
+            }
+        }
+        std::sort(muestras, muestras + total);
+        for (int j = 0; j < n; j++) {
+            if (q[j] <= 0.0) {
+                resultado[j] = minimo;
+                continue;
+            }
+            if (q[j] >= 1.0) {
+                resultado[j] = maximo;
+                continue;
+            }
+            double objetivo = q[j] * (double)cantidad;
+            long long acumulado = 0;
+            int i = 0;
+            while (i < total - 1 && (double)(acumulado + muestras[i].peso) < objetivo) {
+                acumulado += muestras[i].peso;
+                i++;
+            }
+            resultado[j] = muestras[i].valor;
+        }
+        delete[] muestras;
+    }
+
+    /**
+     * @brief Estima un cuantil
+     * @param q Fracción en [0, 1]
+     * @return Valor cuyo rango aproximado es q·getCantidad()
+     */
+    double cuantil(double q) const {
+        double r;
+        cuantiles(&q, &r, 1);
+        return r;
+    }
+
+    /**
+     * @brief Lecturas resumidas
+     */
+    long long getCantidad() const {
+        return cantidad;
+    }
+
+    /**
+     * @brief Menor lectura (0 si no hay)
+     */
+    double getMinimo() const {
+        return minimo;
+    }
+
+    /**
+     * @brief Mayor lectura (0 si no hay)
+     */
+    double getMaximo() const {
+        return maximo;
+    }
+
+    /**
+     * @brief Muestras guardadas en todos los niveles
+     */
+    int getMuestras() const {
+        int total = 0;
+        for (int h = 0; h < numNiveles; h++) {
+            total += tamNivel[h];
+        }
+        return total;
+    }
+
+    /**
+     * @brief Memoria del bosquejo
+     */
+    long memoriaBytes() const {
+        long total = (long)sizeof(BosquejoCuantiles);
+        for (int h = 0; h < MAX_NIVELES; h++) {
+            total += (long)reservaNivel[h] * (long)sizeof(double);
+        }
+        return total;
+    }
+};
+
+#endif // BOSQUEJOCUANTILES_H
@@ -0,0 +1,109 @@
+/**
+ * @file ColaSpsc.h
+ * @brief Cola circular sin bloqueo para un productor y un consumidor
+ * @author Eliezer Mores Oyervides
+ * @date 2025
+ */
+
+#ifndef COLASPSC_H
+#define COLASPSC_H
+
+#include <atomic>
+
+/**
+ * @class ColaSpsc
+ * @brief Anillo de capacidad fija entre exactamente dos hilos
+ * @tparam T Tipo de elemento (se copia al encolar y al desencolar)
+ *
+ * Solo el productor escribe la cola y solo el consumidor escribe la cabeza,
+ * así que basta con cargas y almacenamientos acquire/release: no hay CAS ni
+ * candados. Cabeza y cola viven en líneas de caché distintas, y cada hilo
+ * guarda una copia de la posición del otro para leer la atómica compartida
+ * solo cuando el anillo parece lleno (productor) o vacío (consumidor).
+ */
+template <typename T>
+class ColaSpsc {
+private:
+    static const int LINEA_CACHE = 64;
+
+    T* ranuras;                  ///< Almacenamiento del anillo
+    unsigned long mascara;       ///< Capacidad - 1 (la capacidad es potencia de dos)
+
+    alignas(LINEA_CACHE) std::atomic<unsigned long> cabeza; ///< Próxima posición a leer (escribe el consumidor)
+    unsigned long colaVista;     ///< Última cola leída por el consumidor
+
+    alignas(LINEA_CACHE) std::atomic<unsigned long> cola;   ///< Próxima posición a escribir (escribe el productor)
+    unsigned long cabezaVista;   ///< Última cabeza leída por el productor
+
+public:
+    /**
+     * @brief Constructor
+     * @param capacidadMinima Elementos que debe admitir; se redondea a potencia de dos
+     */
+    ColaSpsc(int capacidadMinima) : cabeza(0), colaVista(0), cola(0), cabezaVista(0) {
+        unsigned long capacidad = 2;
+        while (capacidad < (unsigned long)capacidadMinima) capacidad *= 2;
+        ranuras = new T[capacidad];
+        mascara = capacidad - 1;
+    }
+
+    /**
+     * @brief Destructor - Libera el anillo (los elementos pendientes se descartan)
+     */
+    ~ColaSpsc() {
+        delete[] ranuras;
+    }
+
+    ColaSpsc(const ColaSpsc&) = delete;
+    ColaSpsc& operator=(const ColaSpsc&) = delete;
+
+    /**
+     * @brief Encola un elemento (solo el hilo productor)
+     * @param valor Elemento a copiar en el anillo
+     * @return false si el anillo está lleno
+     */
+    bool intentarEncolar(const T& valor) {
+        unsigned long c = cola.load(std::memory_order_relaxed);
+        if (c - cabezaVista > mascara) {
+            cabezaVista = cabeza.load(std::memory_order_acquire);
+            if (c - cabezaVista > mascara) return false;
+        }
+        ranuras[c & mascara] = valor;
+        cola.store(c + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Desencola el elemento más antiguo (solo el hilo consumidor)
+     * @param destino Recibe el elemento
+     * @return false si el anillo está vacío
+     */
+    bool intentarDesencolar(T& destino) {
+        unsigned long h = cabeza.load(std::memory_order_relaxed);
+        if (h == colaVista) {
+            colaVista = cola.load(std::memory_order_acquire);
+            if (h == colaVista) return false;
+        }
+        destino = ranuras[h & mascara];
+        cabeza.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Elementos pendientes (aproximado si los otros hilos siguen trabajando)
+     */
+    long profundidad() const {
+        unsigned long h = cabeza.load(std::memory_order_acquire);
+        unsigned long c = cola.load(std::memory_order_acquire);
+        return c >= h ? (long)(c - h) : 0;
+    }
+
+    /**
+     * @brief Elementos que caben en el anillo
+     */
+    long capacidad() const {
+        return (long)mascara + 1;
+    }
+};
+
+#endif // COLASPSC_H
@@ -0,0 +1,163 @@
+/**
+ * @file EnrutadorLineas.h
+ * @brief Enrutamiento de líneas etiquetadas "ID:valor" hacia los sensores de una ListaGestion
+ * @author Eliezer Mores Oyervides
+ * @date 2025
+ *
+ * Formato de línea etiquetada:
+ * @code
+ * T-001:23.5
+ * P-105:1013
+ * P-105:1012@184230
+ * @endcode
+ * El identificador se resuelve con la tabla hash de la ListaGestion
+ * (ListaGestion::internar) y el valor se interpreta con std::from_chars, sin
+ * copiar la línea ni depender de la configuración regional. El sufijo
+ * opcional "@marca" son los milisegundos del reloj del dispositivo en que se
+ * tomó la lectura (p. ej. millis() en un Arduino); se traducen al reloj de
+ * los historiales con un RelojDispositivo. Sin él la lectura se fecha al
+ * recibirla.
+ */
+
+#ifndef ENRUTADORLINEAS_H
+#define ENRUTADORLINEAS_H
+
+#include "ListaGestion.h"
+#include "RelojDispositivo.h"
+#include <charconv>
+#include <cstring>
+
+/**
+ * @enum ResultadoRuta
+ * @brief Resultado de EnrutadorLineas::enrutar()
+ */
+enum ResultadoRuta {
+    RUTA_ENTREGADA,      ///< La lectura se agregó al sensor indicado por el ID
+    RUTA_SIN_ETIQUETA,   ///< La línea no trae "ID:"; la decide quien llama
+    RUTA_ID_DESCONOCIDO, ///< Ningún sensor registrado tiene ese ID
+    RUTA_VALOR_INVALIDO  ///< El ID existe pero el valor no es numérico
+};
+
+/**
+ * @class EnrutadorLineas
+ * @brief Despacha lecturas etiquetadas al sensor de su ID en O(1)
+ *
+ * Un solo flujo puede alimentar a cualquier número de sensores. Los IDs
+ * desconocidos y los valores inválidos se cuentan en lugar de imprimirse,
+ * para no frenar la ingesta cuando el dispositivo envía sensores que aún no
+ * se crearon en el sistema.
+ */
+class EnrutadorLineas {
+private:
+    ListaGestion& gestor;   ///< Lista cuyos sensores reciben las lecturas
+    long entregadas;        ///< Lecturas entregadas
+    long desconocidas;      ///< Líneas con ID sin sensor
+    long invalidas;         ///< Líneas con valor no numérico
+    RelojDispositivo reloj; ///< Marcas "@ms" del dispositivo -> reloj de los historiales
+
+public:
+    /**
+     * @brief Constructor
+     * @param g Lista de gestión que resuelve los IDs
+     */
+    EnrutadorLineas(ListaGestion& g) : gestor(g), entregadas(0), desconocidas(0), invalidas(0) {}
+
+    /**
+     * @brief Entrega una línea "ID:valor" a su sensor
+     * @param linea Línea terminada en '\0' (se modifica: ':' se reemplaza por '\0')
+     * @return Resultado del enrutamiento
+     *
+     * Un valor con parte decimal o exponente se entrega con agregarFlotante();
+     * uno entero, con agregarEntero(). Cada sensor lo convierte a su tipo.
+     * Las marcas "@ms" se traducen con el reloj propio del enrutador, que
+     * supone un único dispositivo al otro lado.
+     */
+    ResultadoRuta enrutar(char* linea) {
+        return enrutar(linea, reloj);
+    }
+
+    /**
+     * @brief Entrega una línea "ID:valor" traduciendo su marca con el reloj de su origen
+     * @param linea Línea terminada en '\0' (se modifica: ':' se reemplaza por '\0')
+     * @param relojOrigen Reloj del dispositivo que envió la línea
+     * @return Resultado del enrutamiento
+     *
+     * Cada dispositivo tiene su propio desfase y sus propios reinicios; quien
+     * reciba de varios (MotorIngesta) debe pasar un reloj por punto para que
+     * uno no re-ancle las marcas del otro.
+     */
+    ResultadoRuta enrutar(char* linea, RelojDispositivo& relojOrigen) {
+        char* separador = strchr(linea, ':');
+        if (separador == nullptr) {
+            return RUTA_SIN_ETIQUETA;
+        }
+        *separador = '\0';
+        SensorBase* sensor = gestor.obtener(gestor.internar(linea));
+        if (sensor == nullptr) {
+            desconocidas++;
+            return RUTA_ID_DESCONOCIDO;
+        }
+
+        const char* valor = separador + 1;
+        const char* fin = valor + strlen(valor);
+        long long marca = 0;
+        const char* arroba = static_cast<const char*>(memchr(valor, '@', fin - valor));
+        if (arroba != nullptr) {
+            long long dispositivo;
+            std::from_chars_result m = std::from_chars(arroba + 1, fin, dispositivo);
+            if (m.ec != std::errc() || m.ptr != fin || dispositivo < 0) {
+                invalidas++;
+                sensor->getMetricas().registrarFalloAnalisis();
+                return RUTA_VALOR_INVALIDO;
+            }
+            marca = relojOrigen.convertir(dispositivo);
+            fin = arroba;
+        }
+        int entero;
+        std::from_chars_result r = std::from_chars(valor, fin, entero);
+        if (r.ec == std::errc() && r.ptr == fin) {
+            sensor->agregarEntero(entero, marca);
+        } else {
+            float flotante;
+            r = std::from_chars(valor, fin, flotante);
+            if (r.ec != std::errc() || r.ptr != fin) {
+                invalidas++;
+                sensor->getMetricas().registrarFalloAnalisis();
+                return RUTA_VALOR_INVALIDO;
+            }
+            sensor->agregarFlotante(flotante, marca);
+        }
+        entregadas++;
+        return RUTA_ENTREGADA;
+    }
+
+    /**
+     * @brief Lecturas entregadas a un sensor
+     */
+    long getEntregadas() const {
+        return entregadas;
+    }
+
+    /**
+     * @brief Líneas descartadas por ID desconocido
+     */
+    long getDesconocidas() const {
+        return desconocidas;
+    }
+
+    /**
+     * @brief Líneas descartadas por valor no numérico
+     */
+    long getInvalidas() const {
+        return invalidas;
+    }
+
+    /**
+     * @brief Reloj con que enrutar(linea) traduce las marcas "@ms"
+     */
+    const RelojDispositivo& getReloj() const {
+        return reloj;
+    }
+};
+
+#endif // ENRUTADORLINEAS_H
@@ -0,0 +1,189 @@
+/**
+ * @file ExportadorMetricas.h
+ * @brief Exportación periódica de las métricas a un archivo en formato de texto de Prometheus
+ * @author Eliezer Mores Oyervides
+ * @date 2025
+ *
+ * Un hilo de fondo reescribe el archivo cada cierto intervalo. El archivo
+ * se escribe completo en "<ruta>.tmp" y se renombra, así quien lo lea
+ * (p. ej. el recolector de archivos de node_exporter) nunca ve una
+ * exportación a medias. Ejemplo de salida:
+ * @code
+ * iot_lecturas_total{sensor="T-001"} 1520
+ * iot_latencia_ingesta_ns{sensor="T-001",quantile="0.99"} 8191
+ * @endcode
+ */
+
+#ifndef EXPORTADORMETRICAS_H
+#define EXPORTADORMETRICAS_H
+
+#include "ListaGestion.h"
+#include "Metricas.h"
+#include "Registro.h"
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <atomic>
+
+/**
+ * @class ExportadorMetricas
+ * @brief Escribe las métricas de una ListaGestion en un archivo cada intervalo
+ */
+class ExportadorMetricas {
+private:
+    const ListaGestion& gestor;     ///< Sensores exportados
+    char ruta[256];                 ///< Archivo destino
+    int intervaloMs;                ///< Periodo entre exportaciones
+    std::atomic<long> exportaciones; ///< Archivos escritos
+    bool terminar;                  ///< Pide al hilo que termine
+    std::mutex mutex;
+    std::mutex mutexArchivo;        ///< Una exportación a la vez (hilo de fondo o exportar())
+    std::condition_variable despertar;
+    std::thread hilo;
+
+    /**
+     * @brief Copia un nombre de sensor escapando '"' y '\\' para usarlo como etiqueta
+     */
+    static void escaparEtiqueta(const char* nombre, char* destino, int capacidad) {
+        int n = 0;
+        for (int i = 0; nombre[i] != '\0' && n < capacidad - 2; i++) {
+            if (nombre[i] == '"' || nombre[i] == '\\') destino[n++] = '\\';
+            destino[n++] = nombre[i];
+        }
+        destino[n] = '\0';
+    }
+
+    /**
+     * @brief Escribe una familia de métricas con un valor por sensor
+     * @param valor Función valor(const MetricasSensor&) -> unsigned long long
+     */
+    template <typename F>
+    void escribirFamilia(FILE* f, const char* metrica, const char* tipo, F valor) const {
+        fprintf(f, "# TYPE %s %s\n", metrica, tipo);
+        gestor.paraCadaSensor([f, metrica, &valor](const SensorBase* sensor) {
+            char nombre[104];
+            escaparEtiqueta(sensor->getNombre(), nombre, sizeof(nombre));
+            fprintf(f, "%s{sensor=\"%s\"} %llu\n", metrica, nombre,
+                    (unsigned long long)valor(sensor->getMetricas()));
+        });
+    }
+
+    /**
+     * @brief Escribe un histograma de cada sensor como resumen con cuantiles
+     * @param histograma Función histograma(const MetricasSensor&) -> const HistogramaLatencia&
+     */
+    template <typename F>
+    void escribirResumen(FILE* f, const char* metrica, F histograma) const {
+        fprintf(f, "# TYPE %s summary\n", metrica);
+        gestor.paraCadaSensor([f, metrica, &histograma](const SensorBase* sensor) {
+            char nombre[104];
+            escaparEtiqueta(sensor->getNombre(), nombre, sizeof(nombre));
+            const HistogramaLatencia& h = histograma(sensor->getMetricas());
+            const double cuantiles[] = {0.5, 0.9, 0.99};
+            for (int i = 0; i < 3; i++) {
+                fprintf(f, "%s{sensor=\"%s\",quantile=\"%g\"} %llu\n", metrica, nombre, cuantiles[i],
+                        (unsigned long long)h.percentil(cuantiles[i] * 100.0));
+            }
+            fprintf(f, "%s{sensor=\"%s\",quantile=\"1\"} %llu\n", metrica, nombre,
+                    (unsigned long long)h.getMaximo());
+            fprintf(f, "%s_sum{sensor=\"%s\"} %llu\n", metrica, nombre, (unsigned long long)h.getSuma());
+            fprintf(f, "%s_count{sensor=\"%s\"} %llu\n", metrica, nombre, (unsigned long long)h.getCantidad());
+        });
+    }
+
+    /**
+     * @brief Bucle del hilo de fondo
+     */
+    void ejecutar() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!terminar) {
+            despertar.wait_for(lock, std::chrono::milliseconds(intervaloMs), [this] { return terminar; });
+            lock.unlock();
+            exportar();
+            lock.lock();
+        }
+    }
+
+public:
+    /**
+     * @brief Constructor - arranca el hilo de exportación
+     * @param g Lista de gestión cuyas métricas se exportan
+     * @param archivo Ruta del archivo destino
+     * @param segundos Intervalo entre exportaciones
+     */
+    ExportadorMetricas(const ListaGestion& g, const char* archivo, double segundos)
+        : gestor(g), exportaciones(0), terminar(false) {
+        strncpy(ruta, archivo, sizeof(ruta) - 1);
+        ruta[sizeof(ruta) - 1] = '\0';
+        intervaloMs = segundos > 0.0 ? (int)(segundos * 1000.0) : 10000;
+        hilo = std::thread(&ExportadorMetricas::ejecutar, this);
+    }
+
+    /**
+     * @brief Destructor - hace una última exportación y detiene el hilo
+     */
+    ~ExportadorMetricas() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            terminar = true;
+        }
+        despertar.notify_one();
+        hilo.join();
+    }
+
+    ExportadorMetricas(const ExportadorMetricas&) = delete;
+    ExportadorMetricas& operator=(const ExportadorMetricas&) = delete;
+
+    /**
+     * @brief Escribe el archivo de métricas ahora
+     * @return true si el archivo se reemplazó
+     */
+    bool exportar() {
+        std::lock_guard<std::mutex> lock(mutexArchivo);
+        char temporal[sizeof(ruta) + 8];
+        snprintf(temporal, sizeof(temporal), "%s.tmp", ruta);
+        FILE* f = fopen(temporal, "w");
+        if (f == nullptr) {
+            REGISTRO_ERROR("No se pudo escribir el archivo de métricas " << temporal);
+            return false;
+        }
+        // El formato exige que las muestras de cada familia vayan juntas
+        escribirFamilia(f, "iot_lecturas_total", "counter",
+                        [](const MetricasSensor& m) { return m.getLecturas(); });
+        escribirFamilia(f, "iot_fallos_analisis_total", "counter",
+                        [](const MetricasSensor& m) { return m.getFallosAnalisis(); });
+        escribirFamilia(f, "iot_lecturas_por_segundo", "gauge",
+                        [](const MetricasSensor& m) { return m.lecturasPorSegundo(); });
+        escribirFamilia(f, "iot_bytes_historial", "gauge",
+                        [](const MetricasSensor& m) { return m.getBytesHistorial(); });
+        escribirResumen(f, "iot_latencia_ingesta_ns",
+                        [](const MetricasSensor& m) -> const HistogramaLatencia& { return m.latenciaIngesta; });
+        escribirResumen(f, "iot_duracion_proceso_ns",
+                        [](const MetricasSensor& m) -> const HistogramaLatencia& { return m.duracionProceso; });
+        const HistogramaLatencia& ronda = gestor.getDuracionRonda();
+        fprintf(f, "# TYPE iot_duracion_ronda_ns summary\n");
+        fprintf(f, "iot_duracion_ronda_ns{quantile=\"0.5\"} %llu\n", (unsigned long long)ronda.percentil(50));
+        fprintf(f, "iot_duracion_ronda_ns{quantile=\"1\"} %llu\n", (unsigned long long)ronda.getMaximo());
+        fprintf(f, "iot_duracion_ronda_ns_sum %llu\n", (unsigned long long)ronda.getSuma());
+        fprintf(f, "iot_duracion_ronda_ns_count %llu\n", (unsigned long long)ronda.getCantidad());
+        bool escrito = fclose(f) == 0;
+        if (!escrito || rename(temporal, ruta) != 0) {
+            REGISTRO_ERROR("No se pudo reemplazar el archivo de métricas " << ruta);
+            return false;
+        }
+        exportaciones++;
+        return true;
+    }
+
+    /**
+     * @brief Archivos de métricas escritos
+     */
+    long getExportaciones() const {
+        return exportaciones;
+    }
+};
+
+#endif // EXPORTADORMETRICAS_H
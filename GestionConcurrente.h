@@ -0,0 +1,329 @@
+/**
+ * @file GestionConcurrente.h
+ * @brief Registro de sensores seguro entre hilos, con candados por fragmento y por sensor
+ * @author Eliezer Mores Oyervides
+ * @date 2025
+ */
+
+#ifndef GESTIONCONCURRENTE_H
+#define GESTIONCONCURRENTE_H
+
+#include "SensorBase.h"
+#include "IndiceNombres.h"
+#include "Registro.h"
+#include <iostream>
+#include <atomic>
+#include <mutex>
+
+/**
+ * @class GestionConcurrente
+ * @brief Variante de ListaGestion para ingerir desde varios hilos a la vez
+ *
+ * ListaGestion y ListaSensor no se sincronizan: con un solo candado global
+ * todos los dispositivos quedarían en fila. Aquí:
+ *
+ * - Los nombres se reparten en FRAGMENTOS índices según su hash, cada uno
+ *   con su propio candado, así que insertar() desde varios hilos solo
+ *   compite cuando dos nombres caen en el mismo fragmento.
+ * - Los sensores viven en una tabla de segmentos que nunca se reubica: el
+ *   handle se reserva con un compare-exchange que nunca pasa de la
+ *   capacidad, y obtener(handle) no toma candados.
+ * - Cada sensor tiene su candado (en su propia línea de caché). Escrituras
+ *   en sensores distintos no compiten; en el mismo sensor se serializan.
+ * - imprimirTodos() fija cuántos sensores mostrar, toma de cada uno un
+ *   ResumenSensor reteniéndolo solo lo que dura la copia, e imprime sin
+ *   candados: los productores no esperan a la consola.
+ *
+ * Los sensores no se eliminan individualmente; se liberan con el registro.
+ */
+class GestionConcurrente {
+private:
+    static const int FRAGMENTOS = 16;        ///< Índices de nombres (potencia de dos)
+    static const int TAM_SEGMENTO = 1024;    ///< Sensores por segmento de la tabla
+    static const int MAX_SEGMENTOS = 1024;   ///< Hasta TAM_SEGMENTO * MAX_SEGMENTOS sensores
+
+    /**
+     * @struct Entrada
+     * @brief Sensor y su candado, en una línea de caché propia
+     */
+    struct alignas(64) Entrada {
+        std::mutex mutex;                   ///< Serializa las operaciones sobre el sensor
+        std::atomic<SensorBase*> sensor;    ///< nullptr hasta que insertar() lo publica
+
+        Entrada() : sensor(nullptr) {}
+    };
+
+    /**
+     * @struct Fragmento
+     * @brief Parte del índice de nombres con su candado
+     */
+    struct alignas(64) Fragmento {
+        std::mutex mutex;
+        IndiceNombres indice;
+    };
+
+    Fragmento fragmentos[FRAGMENTOS];                ///< Nombre -> handle, por hash
+    std::atomic<Entrada*> segmentos[MAX_SEGMENTOS];  ///< Handle -> entrada
+    std::atomic<int> reservados;                     ///< Handles entregados (nunca más que la capacidad)
+
+    /**
+     * @brief Fragmento de un nombre (bits altos del hash; el índice usa los bajos)
+     */
+    Fragmento& fragmentoDe(const char* nombre) {
+        return fragmentos[IndiceNombres::hashCadena(nombre) >> 28];
+    }
+
+    /**
+     * @brief Entrada de un handle, creando su segmento si hace falta
+     */
+    Entrada& entradaCreando(int handle) {
+        std::atomic<Entrada*>& ranura = segmentos[handle / TAM_SEGMENTO];
+        Entrada* segmento = ranura.load(std::memory_order_acquire);
+        if (segmento == nullptr) {
+            Entrada* nuevo = new Entrada[TAM_SEGMENTO];
+            // Si otro hilo lo creó primero se usa el suyo
+            if (ranura.compare_exchange_strong(segmento, nuevo, std::memory_order_acq_rel)) {
+                segmento = nuevo;
+            } else {
+                delete[] nuevo;
+            }
+        }
+        return segmento[handle % TAM_SEGMENTO];
+    }
+
+    /**
+     * @brief Reserva el siguiente handle sin pasar de la capacidad
+     * @return Handle o -1 si la tabla está llena
+     *
+     * Un fetch_add seguido de fetch_sub dejaría reservados por encima de la
+     * capacidad durante un instante, y un lector concurrente de entrada()
+     * podría indexar fuera de segmentos.
+     */
+    int reservarHandle() {
+        int handle = reservados.load(std::memory_order_relaxed);
+        do {
+            if (handle >= TAM_SEGMENTO * MAX_SEGMENTOS) return -1;
+        } while (!reservados.compare_exchange_weak(handle, handle + 1, std::memory_order_acq_rel,
+                                                   std::memory_order_relaxed));
+        return handle;
+    }
+
+    /**
+     * @brief Entrada de un handle ya reservado, o nullptr si aún no existe
+     */
+    Entrada* entrada(int handle) const {
+        if (handle < 0 || handle >= TAM_SEGMENTO * MAX_SEGMENTOS ||
+            handle >= reservados.load(std::memory_order_acquire)) return nullptr;
+        Entrada* segmento = segmentos[handle / TAM_SEGMENTO].load(std::memory_order_acquire);
+        return segmento == nullptr ? nullptr : &segmento[handle % TAM_SEGMENTO];
+    }
+
+public:
+    /**
+     * @brief Constructor por defecto (registro vacío)
+     */
+    GestionConcurrente() : reservados(0) {
+        for (int i = 0; i < MAX_SEGMENTOS; i++) {
+            segmentos[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Destructor - Libera todos los sensores (ningún hilo debe seguir usándolos)
+     */
+    ~GestionConcurrente() {
+        REGISTRO_INFO("--- Liberación de Memoria del Registro Concurrente ---");
+        int n = reservados.load(std::memory_order_acquire);
+        for (int i = 0; i < MAX_SEGMENTOS; i++) {
+            Entrada* segmento = segmentos[i].load(std::memory_order_acquire);
+            if (segmento == nullptr) continue;
+            for (int j = 0; j < TAM_SEGMENTO && i * TAM_SEGMENTO + j < n; j++) {
+                delete segmento[j].sensor.load(std::memory_order_acquire);
+            }
+            delete[] segmento;
+        }
+        REGISTRO_INFO("Sistema cerrado. Memoria limpia.");
+    }
+
+    GestionConcurrente(const GestionConcurrente&) = delete;
+    GestionConcurrente& operator=(const GestionConcurrente&) = delete;
+
+    /**
+     * @brief Registra un sensor; puede llamarse desde varios hilos a la vez
+     * @param sensor Sensor a registrar (el registro pasa a ser su dueño)
+     * @return Handle del sensor, o -1 si el registro está lleno (el sensor se libera)
+     *
+     * Si ya existía otro sensor con el mismo nombre, el nombre sigue
+     * resolviendo al primero que se registró.
+     */
+    int insertar(SensorBase* sensor) {
+        int handle = reservarHandle();
+        if (handle < 0) {
+            REGISTRO_ERROR("Registro concurrente lleno; se descarta el sensor '" << sensor->getNombre() << "'.");
+            delete sensor;
+            return -1;
+        }
+        entradaCreando(handle).sensor.store(sensor, std::memory_order_release);
+
+        Fragmento& f = fragmentoDe(sensor->getNombre());
+        {
+            std::lock_guard<std::mutex> lock(f.mutex);
+            f.indice.insertar(sensor->getNombre(), handle);
+        }
+        REGISTRO_INFO("Sensor '" << sensor->getNombre() << "' insertado en el registro concurrente.");
+        return handle;
+    }
+
+    /**
+     * @brief Convierte un nombre de sensor en su handle
+     * @param nombre Nombre del sensor
+     * @return Handle o -1 si no hay sensor con ese nombre
+     *
+     * Toma el candado de un solo fragmento; las rutas calientes deberían
+     * internar una vez y despachar por handle.
+     */
+    int internar(const char* nombre) {
+        Fragmento& f = fragmentoDe(nombre);
+        std::lock_guard<std::mutex> lock(f.mutex);
+        return f.indice.buscar(nombre);
+    }
+
+    /**
+     * @brief Obtiene un sensor por handle sin tomar candados
+     * @param handle Handle devuelto por insertar() o internar()
+     * @return Sensor o nullptr si el handle no es válido o aún no se publica
+     *
+     * Para operar sobre el sensor desde varios hilos usar conSensor().
+     */
+    SensorBase* obtener(int handle) const {
+        Entrada* e = entrada(handle);
+        return e == nullptr ? nullptr : e->sensor.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Ejecuta f sobre un sensor con su candado tomado
+     * @param handle Handle del sensor
+     * @param f Función f(SensorBase&)
+     * @return false si el handle no es válido
+     */
+    template <typename F>
+    bool conSensor(int handle, F f) {
+        Entrada* e = entrada(handle);
+        if (e == nullptr) return false;
+        SensorBase* sensor = e->sensor.load(std::memory_order_acquire);
+        if (sensor == nullptr) return false;
+        std::lock_guard<std::mutex> lock(e->mutex);
+        f(*sensor);
+        return true;
+    }
+
+    /**
+     * @brief Agrega una lectura en texto a un sensor (seguro entre hilos)
+     * @param handle Handle del sensor
+     * @param valor Lectura como texto
+     * @return false si el handle no es válido
+     */
+    bool agregarLectura(int handle, const char* valor) {
+        return conSensor(handle, [valor](SensorBase& s) { s.agregarLectura(valor); });
+    }
+
+    /**
+     * @brief Agrega una lectura entera a un sensor (seguro entre hilos)
+     * @param handle Handle del sensor
+     * @param valor Lectura ya decodificada
+     * @param marcaMs Milisegundos monótonos de la lectura (0 = instante de ingesta)
+     * @return false si el handle no es válido
+     */
+    bool agregarEntero(int handle, int valor, long long marcaMs = 0) {
+        return conSensor(handle, [valor, marcaMs](SensorBase& s) { s.agregarEntero(valor, marcaMs); });
+    }
+
+    /**
+     * @brief Agrega una lectura flotante a un sensor (seguro entre hilos)
+     * @param handle Handle del sensor
+     * @param valor Lectura ya decodificada
+     * @param marcaMs Milisegundos monótonos de la lectura (0 = instante de ingesta)
+     * @return false si el handle no es válido
+     */
+    bool agregarFlotante(int handle, float valor, long long marcaMs = 0) {
+        return conSensor(handle, [valor, marcaMs](SensorBase& s) { s.agregarFlotante(valor, marcaMs); });
+    }
+
+    /**
+     * @brief Procesa cada sensor con su candado e imprime el resultado sin él
+     *
+     * Produce la misma salida que ListaGestion::procesarTodos() para los
+     * sensores registrados al empezar.
+     */
+    void procesarTodos() {
+        int n = getTamanio();
+        std::cout << "\n--- Ejecutando Polimorfismo ---" << std::endl;
+        for (int i = 0; i < n; i++) {
+            ResultadoProceso r;
+            SensorBase* sensor = nullptr;
+            if (conSensor(i, [&r, &sensor](SensorBase& s) { r = s.procesar(); sensor = &s; })) {
+                sensor->imprimirResultado(r);
+            }
+        }
+    }
+
+    /**
+     * @brief Imprime un resumen de cada sensor sin bloquear a los productores
+     *
+     * Muestra los sensores registrados al empezar; cada resumen es una copia
+     * consistente del sensor tomada con su candado.
+     */
+    void imprimirTodos() {
+        int n = getTamanio();
+        ResumenSensor* resumenes = new ResumenSensor[n > 0 ? n : 1];
+        SensorBase** sensores = new SensorBase*[n > 0 ? n : 1];
+        for (int i = 0; i < n; i++) {
+            sensores[i] = nullptr;
+            conSensor(i, [&resumenes, &sensores, i](SensorBase& s) {
+                resumenes[i] = s.resumir();
+                sensores[i] = &s;
+            });
+        }
+
+        std::cout << "\n--- Información de Sensores Registrados ---" << std::endl;
+        for (int i = 0; i < n; i++) {
+            if (sensores[i] == nullptr) continue;
+            std::cout << "\nSensor #" << (i + 1) << ":" << std::endl;
+            sensores[i]->imprimirResumen(resumenes[i]);
+        }
+        delete[] resumenes;
+        delete[] sensores;
+    }
+
+    /**
+     * @brief Combina los bosquejos de cuantiles de todos los sensores
+     * @return Bosquejo del flujo de toda la flota
+     *
+     * Cada sensor se retiene solo mientras su bosquejo se suma al total.
+     */
+    BosquejoCuantiles combinarCuantiles() {
+        BosquejoCuantiles flota;
+        int n = getTamanio();
+        for (int i = 0; i < n; i++) {
+            conSensor(i, [&flota](SensorBase& s) { flota.combinar(s.getCuantiles()); });
+        }
+        return flota;
+    }
+
+    /**
+     * @brief Número de sensores registrados (o en vías de registrarse)
+     */
+    int getTamanio() const {
+        int n = reservados.load(std::memory_order_acquire);
+        return n < TAM_SEGMENTO * MAX_SEGMENTOS ? n : TAM_SEGMENTO * MAX_SEGMENTOS;
+    }
+
+    /**
+     * @brief Verifica si el registro está vacío
+     */
+    bool estaVacia() const {
+        return getTamanio() == 0;
+    }
+};
+
+#endif // GESTIONCONCURRENTE_H
@@ -0,0 +1,386 @@
+/**
+ * @file GestionTipada.h
+ * @brief Registro de sensores agrupados por tipo concreto, con despacho sin llamadas virtuales
+ * @author Eliezer Mores Oyervides
+ * @date 2025
+ */
+
+#ifndef GESTIONTIPADA_H
+#define GESTIONTIPADA_H
+
+#include "SensorBase.h"
+#include "ArenaNodos.h"
+#include "IndiceNombres.h"
+#include "Registro.h"
+#include "Metricas.h"
+#include <iostream>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+
+/**
+ * @class GestionTipada
+ * @brief Alternativa a ListaGestion que guarda cada tipo de sensor en su propio almacén
+ * @tparam Tipos Clases concretas de sensor admitidas (p. ej. SensorTemperatura, SensorPresion)
+ *
+ * ListaGestion recorre una lista de SensorBase* y cada operación es una
+ * llamada virtual sobre un objeto que puede estar en cualquier parte del
+ * heap. Aquí los sensores se construyen dentro de una ArenaNodos por tipo,
+ * consecutivos en memoria, y los recorridos se generan en compilación con
+ * una pasada por tipo: dentro de cada pasada el tipo es exacto, las
+ * llamadas se hacen calificadas (s.T::procesar()) y el compilador puede
+ * expandirlas en línea.
+ *
+ * Los sensores se crean con crear<T>(...) y nunca cambian de dirección,
+ * así que se conservan los handles y la interfaz polimórfica de
+ * ListaGestion (internar, obtener, buscar) para el código que solo conoce
+ * SensorBase*. visitar(handle, f) es el equivalente a std::visit: llama a
+ * f con el sensor convertido a su tipo concreto.
+ */
+template <typename... Tipos>
+class GestionTipada {
+private:
+    static_assert(sizeof...(Tipos) > 0 && sizeof...(Tipos) < 256, "Entre 1 y 255 tipos de sensor");
+
+    /**
+     * @struct Almacen
+     * @brief Sensores de un mismo tipo en orden de registro
+     */
+    template <typename T>
+    struct Almacen {
+        static_assert(std::is_base_of<SensorBase, T>::value, "Los tipos deben derivar de SensorBase");
+
+        ArenaNodos<T> arena;  ///< Memoria de los sensores (bloques consecutivos)
+        T** sensores;         ///< Sensores en orden de registro
+        int* handles;         ///< Handle de cada sensor
+        int tamanio;          ///< Sensores de este tipo
+        int capacidad;        ///< Capacidad de sensores y handles
+
+        Almacen() : sensores(nullptr), handles(nullptr), tamanio(0), capacidad(0) {}
+
+        ~Almacen() {
+            for (int i = 0; i < tamanio; i++) {
+                REGISTRO_DEPURACION("Liberando sensor: " << sensores[i]->getNombre() << ".");
+                arena.destruir(sensores[i]);
+            }
+            arena.liberarTodo();
+            delete[] sensores;
+            delete[] handles;
+        }
+
+        Almacen(const Almacen&) = delete;
+        Almacen& operator=(const Almacen&) = delete;
+
+        /**
+         * @brief Registra un sensor ya construido en la arena
+         */
+        void agregar(T* sensor, int handle) {
+            if (tamanio == capacidad) {
+                int nuevaCapacidad = capacidad == 0 ? 16 : capacidad * 2;
+                T** s = new T*[nuevaCapacidad];
+                int* h = new int[nuevaCapacidad];
+                for (int i = 0; i < tamanio; i++) {
+                    s[i] = sensores[i];
+                    h[i] = handles[i];
+                }
+                delete[] sensores;
+                delete[] handles;
+                sensores = s;
+                handles = h;
+                capacidad = nuevaCapacidad;
+            }
+            sensores[tamanio] = sensor;
+            handles[tamanio] = handle;
+            tamanio++;
+        }
+    };
+
+    /**
+     * @struct Ubicacion
+     * @brief Dónde vive el sensor de un handle
+     */
+    struct Ubicacion {
+        unsigned char tipo;  ///< Posición del tipo en Tipos...
+        int posicion;        ///< Índice dentro del almacén de ese tipo
+    };
+
+    std::tuple<Almacen<Tipos>...> almacenes; ///< Un almacén por tipo
+    IndiceNombres indiceNombres;  ///< Nombre -> handle
+    SensorBase** porHandle;       ///< Handle -> sensor (interfaz polimórfica)
+    Ubicacion* ubicaciones;       ///< Handle -> almacén y posición
+    int tamanio;                  ///< Sensores registrados
+    int capacidadHandles;         ///< Capacidad de porHandle y ubicaciones
+    HistogramaLatencia duracionRonda; ///< Duración de cada procesarTodos
+
+    /**
+     * @brief Posición de T en Tipos... (error de compilación si no está)
+     */
+    template <typename T>
+    static constexpr int indiceTipo() {
+        constexpr bool coincide[] = {std::is_same<T, Tipos>::value...};
+        for (int i = 0; i < (int)sizeof...(Tipos); i++) {
+            if (coincide[i]) return i;
+        }
+        return -1;
+    }
+
+    /**
+     * @brief Amplía porHandle y ubicaciones si están llenos
+     */
+    void reservarHandle() {
+        if (tamanio < capacidadHandles) return;
+        int nuevaCapacidad = capacidadHandles == 0 ? 16 : capacidadHandles * 2;
+        SensorBase** s = new SensorBase*[nuevaCapacidad];
+        Ubicacion* u = new Ubicacion[nuevaCapacidad];
+        for (int i = 0; i < tamanio; i++) {
+            s[i] = porHandle[i];
+            u[i] = ubicaciones[i];
+        }
+        delete[] porHandle;
+        delete[] ubicaciones;
+        porHandle = s;
+        ubicaciones = u;
+        capacidadHandles = nuevaCapacidad;
+    }
+
+    /**
+     * @brief Llama a f con el sensor de la ubicación si su tipo es el I-ésimo
+     */
+    template <std::size_t I, typename F>
+    bool visitarSi(const Ubicacion& u, F& f) {
+        if (u.tipo != I) return false;
+        f(*std::get<I>(almacenes).sensores[u.posicion]);
+        return true;
+    }
+
+    template <typename F, std::size_t... I>
+    void visitarEn(const Ubicacion& u, F& f, std::index_sequence<I...>) {
+        // Se detiene en el primer tipo que coincide
+        (visitarSi<I>(u, f) || ...);
+    }
+
+public:
+    /**
+     * @brief Constructor por defecto (registro vacío)
+     */
+    GestionTipada() : porHandle(nullptr), ubicaciones(nullptr), tamanio(0), capacidadHandles(0) {}
+
+    /**
+     * @brief Destructor - Destruye los sensores y libera los almacenes
+     */
+    ~GestionTipada() {
+        REGISTRO_INFO("--- Liberación de Memoria por Tipo ---");
+        delete[] porHandle;
+        delete[] ubicaciones;
+    }
+
+    GestionTipada(const GestionTipada&) = delete;
+    GestionTipada& operator=(const GestionTipada&) = delete;
+
+    /**
+     * @brief Construye un sensor dentro del almacén de su tipo y lo registra
+     * @tparam T Tipo concreto (uno de Tipos...)
+     * @param args Argumentos del constructor de T (normalmente el nombre)
+     * @return Sensor creado; el registro es su dueño
+     *
+     * El sensor recibe como handle su posición de registro, igual que en
+     * ListaGestion. Si ya existía otro con el mismo nombre, el nombre sigue
+     * resolviendo al primero.
+     */
+    template <typename T, typename... Args>
+    T* crear(Args&&... args) {
+        constexpr int tipo = indiceTipo<T>();
+        static_assert(tipo >= 0, "El tipo no es uno de los tipos del registro");
+        Almacen<T>& almacen = std::get<tipo>(almacenes);
+        T* sensor = almacen.arena.crear(std::forward<Args>(args)...);
+
+        reservarHandle();
+        porHandle[tamanio] = sensor;
+        ubicaciones[tamanio].tipo = (unsigned char)tipo;
+        ubicaciones[tamanio].posicion = almacen.tamanio;
+        almacen.agregar(sensor, tamanio);
+        indiceNombres.insertar(sensor->getNombre(), tamanio);
+        tamanio++;
+        REGISTRO_INFO("Sensor '" << sensor->getNombre() << "' insertado en el registro por tipo.");
+        return sensor;
+    }
+
+    /**
+     * @brief Convierte un nombre de sensor en su handle
+     * @param nombre Nombre del sensor
+     * @return Handle (0 .. getTamanio()-1) o -1 si no hay sensor con ese nombre
+     */
+    int internar(const char* nombre) const {
+        return indiceNombres.buscar(nombre);
+    }
+
+    /**
+     * @brief Obtiene un sensor por handle a través de la interfaz polimórfica
+     * @param handle Handle devuelto por internar()
+     * @return Puntero al sensor o nullptr si el handle no es válido
+     */
+    SensorBase* obtener(int handle) const {
+        if (handle < 0 || handle >= tamanio) return nullptr;
+        return porHandle[handle];
+    }
+
+    /**
+     * @brief Busca un sensor por su nombre en O(1) esperado
+     * @param nombre Nombre del sensor
+     * @return Puntero al sensor o nullptr si no existe
+     */
+    SensorBase* buscar(const char* nombre) const {
+        return obtener(internar(nombre));
+    }
+
+    /**
+     * @brief Llama a f con el sensor del handle en su tipo concreto
+     * @param handle Handle devuelto por internar()
+     * @param f Función genérica f(T&), p. ej. [](auto& s) { ... }
+     * @return false si el handle no es válido
+     *
+     * El despacho es una cadena de comparaciones generada en compilación;
+     * dentro de f el tipo es exacto y las llamadas calificadas no son virtuales.
+     */
+    template <typename F>
+    bool visitar(int handle, F f) {
+        if (handle < 0 || handle >= tamanio) return false;
+        visitarEn(ubicaciones[handle], f, std::index_sequence_for<Tipos...>());
+        return true;
+    }
+
+    /**
+     * @brief Recorre los sensores de un tipo en orden de registro
+     * @tparam T Tipo concreto
+     * @param f Función f(T&, int handle)
+     */
+    template <typename T, typename F>
+    void paraCadaDe(F f) {
+        Almacen<T>& almacen = std::get<indiceTipo<T>()>(almacenes);
+        for (int i = 0; i < almacen.tamanio; i++) {
+            f(*almacen.sensores[i], almacen.handles[i]);
+        }
+    }
+
+    /**
+     * @brief Recorre todos los sensores, un tipo tras otro
+     * @param f Función genérica f(T&, int handle), instanciada una vez por tipo
+     *
+     * El orden es por tipo y, dentro de cada tipo, por registro.
+     */
+    template <typename F>
+    void paraCada(F f) {
+        (paraCadaDe<Tipos>(f), ...);
+    }
+
+    /**
+     * @brief Entrega una lectura en texto al sensor de un handle
+     * @param handle Handle del sensor
+     * @param valor Lectura como texto
+     * @return false si el handle no es válido
+     */
+    bool agregarLectura(int handle, const char* valor) {
+        return visitar(handle, [valor](auto& s) {
+            typedef typename std::decay<decltype(s)>::type T;
+            s.T::agregarLectura(valor);
+        });
+    }
+
+    /**
+     * @brief Entrega una lectura entera al sensor de un handle
+     * @param handle Handle del sensor
+     * @param valor Lectura ya decodificada
+     * @param marcaMs Milisegundos monótonos de la lectura (0 = instante de ingesta)
+     * @return false si el handle no es válido
+     */
+    bool agregarEntero(int handle, int valor, long long marcaMs = 0) {
+        return visitar(handle, [valor, marcaMs](auto& s) {
+            typedef typename std::decay<decltype(s)>::type T;
+            s.T::agregarEntero(valor, marcaMs);
+        });
+    }
+
+    /**
+     * @brief Entrega una lectura flotante al sensor de un handle
+     * @param handle Handle del sensor
+     * @param valor Lectura ya decodificada
+     * @param marcaMs Milisegundos monótonos de la lectura (0 = instante de ingesta)
+     * @return false si el handle no es válido
+     */
+    bool agregarFlotante(int handle, float valor, long long marcaMs = 0) {
+        return visitar(handle, [valor, marcaMs](auto& s) {
+            typedef typename std::decay<decltype(s)>::type T;
+            s.T::agregarFlotante(valor, marcaMs);
+        });
+    }
+
+    /**
+     * @brief Procesa todos los sensores sin escribir en consola, un bucle por tipo
+     * @param resultados Arreglo de getTamanio() elementos, indexado por handle
+     */
+    void procesarLote(ResultadoProceso* resultados) {
+        paraCada([resultados](auto& s, int handle) {
+            typedef typename std::decay<decltype(s)>::type T;
+            resultados[handle] = s.T::procesar();
+        });
+    }
+
+    /**
+     * @brief Procesa todos los sensores e imprime los resultados en orden de registro
+     *
+     * Produce la misma salida que ListaGestion::procesarTodos().
+     */
+    void procesarTodos() {
+        CronometroLatencia cronometro(duracionRonda);
+        ResultadoProceso* resultados = new ResultadoProceso[tamanio];
+        procesarLote(resultados);
+        std::cout << "\n--- Ejecutando Polimorfismo ---" << std::endl;
+        for (int i = 0; i < tamanio; i++) {
+            porHandle[i]->imprimirResultado(resultados[i]);
+        }
+        delete[] resultados;
+    }
+
+    /**
+     * @brief Imprime información de todos los sensores en orden de registro
+     */
+    void imprimirTodos() const {
+        std::cout << "\n--- Información de Sensores Registrados ---" << std::endl;
+        for (int i = 0; i < tamanio; i++) {
+            std::cout << "\nSensor #" << (i + 1) << ":" << std::endl;
+            porHandle[i]->imprimirInfo();
+        }
+    }
+
+    /**
+     * @brief Duración de las rondas de procesamiento
+     */
+    const HistogramaLatencia& getDuracionRonda() const {
+        return duracionRonda;
+    }
+
+    /**
+     * @brief Número de sensores de un tipo
+     * @tparam T Tipo concreto
+     */
+    template <typename T>
+    int getCantidad() const {
+        return std::get<indiceTipo<T>()>(almacenes).tamanio;
+    }
+
+    /**
+     * @brief Número total de sensores
+     */
+    int getTamanio() const {
+        return tamanio;
+    }
+
+    /**
+     * @brief Verifica si el registro está vacío
+     */
+    bool estaVacia() const {
+        return tamanio == 0;
+    }
+};
+
+#endif // GESTIONTIPADA_H
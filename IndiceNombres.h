@@ -0,0 +1,147 @@
+/**
+ * @file IndiceNombres.h
+ * @brief Tabla hash de direccionamiento abierto de nombres de sensor a handles
+ * @author Eliezer Mores Oyervides
+ * @date 2025
+ */
+
+#ifndef INDICENOMBRES_H
+#define INDICENOMBRES_H
+
+#include <cstring>
+#include <cstdint>
+
+/**
+ * @class IndiceNombres
+ * @brief Asocia cadenas (identificadores de sensor) con handles enteros compactos
+ *
+ * Sondeo lineal sobre una tabla de tamaño potencia de dos, con factor de
+ * carga máximo de 1/2. Cada casilla guarda el hash completo para descartar
+ * colisiones sin comparar cadenas. La tabla no copia las claves: las cadenas
+ * deben vivir al menos tanto como el índice (ListaGestion usa el nombre
+ * almacenado dentro de cada SensorBase).
+ */
+class IndiceNombres {
+private:
+    /**
+     * @struct Casilla
+     * @brief Entrada de la tabla hash
+     */
+    struct Casilla {
+        uint32_t hash;      ///< Hash completo de la clave
+        int handle;         ///< Handle asociado (-1 si la casilla está vacía)
+        const char* clave;  ///< Clave (no se copia)
+    };
+
+    Casilla* tabla;   ///< Arreglo de casillas
+    int capacidad;    ///< Número de casillas (potencia de dos)
+    int ocupadas;     ///< Casillas con clave
+
+    /**
+     * @brief Busca la casilla de una clave o la primera vacía de su secuencia
+     */
+    int sondear(const char* clave, uint32_t h) const {
+        int mascara = capacidad - 1;
+        int i = (int)(h & (uint32_t)mascara);
+        while (tabla[i].handle != -1) {
+            if (tabla[i].hash == h && strcmp(tabla[i].clave, clave) == 0) {
+                return i;
+            }
+            i = (i + 1) & mascara;
+        }
+        return i;
+    }
+
+    /**
+     * @brief Duplica la tabla y reubica las claves
+     */
+    void crecer() {
+        Casilla* vieja = tabla;
+        int capVieja = capacidad;
+        capacidad *= 2;
+        tabla = new Casilla[capacidad];
+        for (int i = 0; i < capacidad; i++) {
+            tabla[i].handle = -1;
+        }
+        for (int i = 0; i < capVieja; i++) {
+            if (vieja[i].handle != -1) {
+                tabla[sondear(vieja[i].clave, vieja[i].hash)] = vieja[i];
+            }
+        }
+        delete[] vieja;
+    }
+
+public:
+    /**
+     * @brief Hash FNV-1a de 32 bits
+     * @param clave Cadena terminada en '\0'
+     * @return Valor hash
+     */
+    static uint32_t hashCadena(const char* clave) {
+        uint32_t h = 2166136261u;
+        for (const unsigned char* p = (const unsigned char*)clave; *p != '\0'; p++) {
+            h ^= *p;
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    /**
+     * @brief Constructor - tabla inicial de 16 casillas
+     */
+    IndiceNombres() : tabla(new Casilla[16]), capacidad(16), ocupadas(0) {
+        for (int i = 0; i < capacidad; i++) {
+            tabla[i].handle = -1;
+        }
+    }
+
+    /**
+     * @brief Destructor - libera la tabla (las claves no son propias)
+     */
+    ~IndiceNombres() {
+        delete[] tabla;
+    }
+
+    IndiceNombres(const IndiceNombres&) = delete;
+    IndiceNombres& operator=(const IndiceNombres&) = delete;
+
+    /**
+     * @brief Registra una clave si aún no existe
+     * @param clave Cadena a registrar (debe seguir viva mientras exista el índice)
+     * @param handle Handle que se asociará a la clave
+     * @return true si se registró; false si la clave ya tenía handle
+     */
+    bool insertar(const char* clave, int handle) {
+        if ((ocupadas + 1) * 2 > capacidad) {
+            crecer();
+        }
+        uint32_t h = hashCadena(clave);
+        int i = sondear(clave, h);
+        if (tabla[i].handle != -1) {
+            return false;
+        }
+        tabla[i].hash = h;
+        tabla[i].handle = handle;
+        tabla[i].clave = clave;
+        ocupadas++;
+        return true;
+    }
+
+    /**
+     * @brief Obtiene el handle de una clave
+     * @param clave Cadena a buscar
+     * @return Handle o -1 si la clave no está registrada
+     */
+    int buscar(const char* clave) const {
+        return tabla[sondear(clave, hashCadena(clave))].handle;
+    }
+
+    /**
+     * @brief Número de claves registradas
+     */
+    int getTamanio() const {
+        return ocupadas;
+    }
+};
+
+#endif // INDICENOMBRES_H
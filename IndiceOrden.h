@@ -0,0 +1,264 @@
+/**
+ * @file IndiceOrden.h
+ * @brief Índice de estadísticos de orden (treap con tamaños de subárbol)
+ * @author Eliezer Mores Oyervides
+ * @date 2025
+ */
+
+#ifndef INDICEORDEN_H
+#define INDICEORDEN_H
+
+#include "ArenaNodos.h"
+#include <algorithm>
+#include <cstdint>
+
+/**
+ * @class IndiceOrden
+ * @brief Multiconjunto ordenado de pares (valor, referencia) con acceso por rango
+ * @tparam T Tipo de valor indexado
+ *
+ * Treap aleatorizado: cada nodo guarda el tamaño de su subárbol, así que
+ * insertar, eliminar, mínimo, máximo y k-ésimo cuestan O(log n) esperado.
+ * La referencia es un puntero opaco que el dueño usa para localizar el
+ * valor en su propia estructura (ListaSensor guarda el nodo que lo contiene)
+ * y desempata valores iguales.
+ */
+template <typename T>
+class IndiceOrden {
+public:
+    /**
+     * @struct Entrada
+     * @brief Par devuelto por las consultas del índice
+     */
+    struct Entrada {
+        T valor;          ///< Valor indexado
+        const void* ref;  ///< Referencia asociada al valor
+    };
+
+private:
+    /**
+     * @struct NodoArbol
+     * @brief Nodo del treap
+     */
+    struct NodoArbol {
+        Entrada entrada;     ///< Clave del nodo
+        uint32_t prioridad;  ///< Prioridad aleatoria (montículo máximo)
+        int tam;             ///< Nodos en el subárbol
+        NodoArbol* izq;      ///< Subárbol de claves menores
+        NodoArbol* der;      ///< Subárbol de claves mayores o iguales
+
+        NodoArbol(const Entrada& e, uint32_t p) : entrada(e), prioridad(p), tam(1),
+                                                  izq(nullptr), der(nullptr) {}
+    };
+
+    NodoArbol* raiz;              ///< Raíz del treap
+    uint32_t semilla;             ///< Estado del generador xorshift
+    ArenaNodos<NodoArbol> arena;  ///< Reservador de nodos del árbol
+
+    uint32_t aleatorio() {
+        semilla ^= semilla << 13;
+        semilla ^= semilla >> 17;
+        semilla ^= semilla << 5;
+        return semilla;
+    }
+
+    static int tam(NodoArbol* n) {
+        return n == nullptr ? 0 : n->tam;
+    }
+
+    static void actualizar(NodoArbol* n) {
+        n->tam = 1 + tam(n->izq) + tam(n->der);
+    }
+
+    /**
+     * @brief Orden total sobre (valor, referencia)
+     */
+    static bool menor(const Entrada& a, const Entrada& b) {
+        if (a.valor < b.valor) return true;
+        if (b.valor < a.valor) return false;
+        return (uintptr_t)a.ref < (uintptr_t)b.ref;
+    }
+
+    /**
+     * @brief Divide n en claves < e (izq) y claves >= e (der)
+     */
+    static void dividir(NodoArbol* n, const Entrada& e, NodoArbol*& izq, NodoArbol*& der) {
+        if (n == nullptr) {
+            izq = der = nullptr;
+        } else if (menor(n->entrada, e)) {
+            dividir(n->der, e, n->der, der);
+            izq = n;
+            actualizar(n);
+        } else {
+            dividir(n->izq, e, izq, n->izq);
+            der = n;
+            actualizar(n);
+        }
+    }
+
+    /**
+     * @brief Une dos treaps donde todas las claves de a preceden a las de b
+     */
+    static NodoArbol* unir(NodoArbol* a, NodoArbol* b) {
+        if (a == nullptr) return b;
+        if (b == nullptr) return a;
+        if (a->prioridad > b->prioridad) {
+            a->der = unir(a->der, b);
+            actualizar(a);
+            return a;
+        }
+        b->izq = unir(a, b->izq);
+        actualizar(b);
+        return b;
+    }
+
+    /**
+     * @brief Quita un nodo con clave exactamente igual a e
+     * @return true si se encontró y eliminó
+     */
+    bool quitar(NodoArbol*& n, const Entrada& e) {
+        if (n == nullptr) return false;
+        bool ok;
+        if (menor(e, n->entrada)) {
+            ok = quitar(n->izq, e);
+        } else if (menor(n->entrada, e)) {
+            ok = quitar(n->der, e);
+        } else {
+            NodoArbol* viejo = n;
+            n = unir(n->izq, n->der);
+            arena.destruir(viejo);
+            return true;
+        }
+        if (ok) actualizar(n);
+        return ok;
+    }
+
+    /**
+     * @brief Arma un subárbol equilibrado con entradas[desde, hasta) ya ordenadas
+     *
+     * La prioridad de cada nodo es al menos la de sus hijos, así el árbol
+     * cumple la propiedad de montículo y las operaciones posteriores lo
+     * tratan como cualquier treap.
+     */
+    NodoArbol* construirRango(const Entrada* entradas, int desde, int hasta) {
+        if (desde >= hasta) return nullptr;
+        int medio = desde + (hasta - desde) / 2;
+        NodoArbol* n = arena.crear(entradas[medio], aleatorio());
+        n->izq = construirRango(entradas, desde, medio);
+        n->der = construirRango(entradas, medio + 1, hasta);
+        if (n->izq != nullptr && n->prioridad < n->izq->prioridad) n->prioridad = n->izq->prioridad;
+        if (n->der != nullptr && n->prioridad < n->der->prioridad) n->prioridad = n->der->prioridad;
+        actualizar(n);
+        return n;
+    }
+
+public:
+    /**
+     * @brief Constructor por defecto (índice vacío)
+     */
+    IndiceOrden() : raiz(nullptr), semilla(2463534242u) {}
+
+    IndiceOrden(const IndiceOrden&) = delete;
+    IndiceOrden& operator=(const IndiceOrden&) = delete;
+
+    /**
+     * @brief Agrega un par al índice en O(log n)
+     * @param valor Valor a indexar
+     * @param ref Referencia asociada
+     */
+    void insertar(T valor, const void* ref) {
+        Entrada e = {valor, ref};
+        NodoArbol* nuevo = arena.crear(e, aleatorio());
+        NodoArbol* izq;
+        NodoArbol* der;
+        dividir(raiz, e, izq, der);
+        raiz = unir(unir(izq, nuevo), der);
+    }
+
+    /**
+     * @brief Reemplaza el contenido por las entradas dadas
+     * @param entradas Pares a indexar (se reordenan)
+     * @param n Número de pares
+     *
+     * Ordena y arma el árbol equilibrado de una vez: O(n log n) con una
+     * ordenación, mucho más rápido que n inserciones en posiciones al azar.
+     */
+    void reconstruir(Entrada* entradas, int n) {
+        limpiar();
+        std::sort(entradas, entradas + n, menor);
+        raiz = construirRango(entradas, 0, n);
+    }
+
+    /**
+     * @brief Elimina una ocurrencia del par en O(log n)
+     * @param valor Valor indexado
+     * @param ref Referencia con la que se insertó
+     * @return true si el par existía
+     */
+    bool eliminar(T valor, const void* ref) {
+        Entrada e = {valor, ref};
+        return quitar(raiz, e);
+    }
+
+    /**
+     * @brief Obtiene el k-ésimo par en orden ascendente (0 = mínimo)
+     * @param k Rango buscado, 0 <= k < getTamanio()
+     * @return Entrada en esa posición
+     */
+    Entrada kesimo(int k) const {
+        NodoArbol* n = raiz;
+        while (true) {
+            int izquierdos = tam(n->izq);
+            if (k < izquierdos) {
+                n = n->izq;
+            } else if (k == izquierdos) {
+                return n->entrada;
+            } else {
+                k -= izquierdos + 1;
+                n = n->der;
+            }
+        }
+    }
+
+    /**
+     * @brief Par con el menor valor (índice no vacío)
+     */
+    Entrada minimo() const {
+        NodoArbol* n = raiz;
+        while (n->izq != nullptr) n = n->izq;
+        return n->entrada;
+    }
+
+    /**
+     * @brief Par con el mayor valor (índice no vacío)
+     */
+    Entrada maximo() const {
+        NodoArbol* n = raiz;
+        while (n->der != nullptr) n = n->der;
+        return n->entrada;
+    }
+
+    /**
+     * @brief Número de pares indexados
+     */
+    int getTamanio() const {
+        return tam(raiz);
+    }
+
+    /**
+     * @brief Vacía el índice liberando sus nodos en O(bloques)
+     */
+    void limpiar() {
+        raiz = nullptr;
+        arena.liberarTodo();
+    }
+
+    /**
+     * @brief Estadísticas del reservador de nodos del índice
+     */
+    EstadisticasArena estadisticasMemoria() const {
+        return arena.estadisticas();
+    }
+};
+
+#endif // INDICEORDEN_H
@@ -0,0 +1,438 @@
+/**
+ * @file KernelesSimd.h
+ * @brief Reducciones vectorizadas (SSE4.1 / AVX2 / escalar) sobre arreglos de lecturas
+ * @author Eliezer Mores Oyervides
+ * @date 2025
+ *
+ * Cada reducción tiene tres versiones y se elige en ejecución según la CPU
+ * (__builtin_cpu_supports); el binario no necesita compilarse con -mavx2.
+ * Las versiones vectoriales usan el atributo target de GCC/Clang, así que
+ * fuera de x86 solo existe la versión escalar.
+ *
+ * ListaSensor aplica estos kernels bloque a bloque (cada nodo guarda un
+ * arreglo contiguo de lecturas) o sobre el arreglo de ListaSensor::exportar().
+ */
+
+#ifndef KERNELESSIMD_H
+#define KERNELESSIMD_H
+
+#if defined(__x86_64__) || defined(__i386__)
+#define KERNELES_X86 1
+#include <immintrin.h>
+#else
+#define KERNELES_X86 0
+#endif
+
+/**
+ * @enum NivelSimd
+ * @brief Conjunto de instrucciones con que se ejecutan los kernels
+ */
+enum NivelSimd {
+    SIMD_ESCALAR = 0,  ///< Bucles escalares (cualquier arquitectura)
+    SIMD_SSE41 = 1,    ///< Vectores de 128 bits
+    SIMD_AVX2 = 2      ///< Vectores de 256 bits
+};
+
+/**
+ * @brief Mejor nivel SIMD que soporta la CPU actual
+ */
+inline NivelSimd detectarSimd() {
+#if KERNELES_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SIMD_AVX2;
+    if (__builtin_cpu_supports("sse4.1")) return SIMD_SSE41;
+#endif
+    return SIMD_ESCALAR;
+}
+
+/**
+ * @brief Nivel SIMD en uso (se detecta en la primera llamada)
+ */
+inline NivelSimd& nivelSimd() {
+    static NivelSimd nivel = detectarSimd();
+    return nivel;
+}
+
+/**
+ * @brief Fuerza un nivel SIMD (p. ej. escalar para comparar en el benchmark)
+ * @param nivel Nivel pedido; se limita al que soporta la CPU
+ */
+inline void establecerNivelSimd(NivelSimd nivel) {
+    NivelSimd maximo = detectarSimd();
+    nivelSimd() = nivel < maximo ? nivel : maximo;
+}
+
+/**
+ * @brief Nombre legible de un nivel SIMD
+ */
+inline const char* nombreSimd(NivelSimd nivel) {
+    return nivel == SIMD_AVX2 ? "AVX2" : nivel == SIMD_SSE41 ? "SSE4.1" : "escalar";
+}
+
+// ---------------------------------------------------------------------------
+// Versiones escalares
+// ---------------------------------------------------------------------------
+
+template <typename T, typename S>
+inline S sumarEscalar(const T* d, long n) {
+    S suma = 0;
+    for (long i = 0; i < n; i++) suma += d[i];
+    return suma;
+}
+
+template <typename T>
+inline void extremosEscalar(const T* d, long n, T& min, T& max) {
+    for (long i = 0; i < n; i++) {
+        if (d[i] < min) min = d[i];
+        if (max < d[i]) max = d[i];
+    }
+}
+
+template <typename T>
+inline long contarMayoresEscalar(const T* d, long n, T umbral) {
+    long cuenta = 0;
+    for (long i = 0; i < n; i++) cuenta += umbral < d[i];
+    return cuenta;
+}
+
+template <typename T>
+inline long buscarEscalar(const T* d, long n, T valor) {
+    for (long i = 0; i < n; i++) {
+        if (!(d[i] < valor) && !(valor < d[i])) return i;
+    }
+    return -1;
+}
+
+#if KERNELES_X86
+
+// ---------------------------------------------------------------------------
+// SSE4.1 (128 bits)
+// ---------------------------------------------------------------------------
+
+__attribute__((target("sse4.1")))
+inline long long sumarSse(const int* d, long n) {
+    __m128i a0 = _mm_setzero_si128();
+    __m128i a1 = _mm_setzero_si128();
+    long i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(d + i));
+        a0 = _mm_add_epi64(a0, _mm_cvtepi32_epi64(v));
+        a1 = _mm_add_epi64(a1, _mm_cvtepi32_epi64(_mm_srli_si128(v, 8)));
+    }
+    long long t[2];
+    _mm_storeu_si128((__m128i*)t, _mm_add_epi64(a0, a1));
+    return t[0] + t[1] + sumarEscalar<int, long long>(d + i, n - i);
+}
+
+__attribute__((target("sse4.1")))
+inline double sumarSse(const float* d, long n) {
+    __m128d a0 = _mm_setzero_pd();
+    __m128d a1 = _mm_setzero_pd();
+    long i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_loadu_ps(d + i);
+        a0 = _mm_add_pd(a0, _mm_cvtps_pd(v));
+        a1 = _mm_add_pd(a1, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+    }
+    double t[2];
+    _mm_storeu_pd(t, _mm_add_pd(a0, a1));
+    return t[0] + t[1] + sumarEscalar<float, double>(d + i, n - i);
+}
+
+__attribute__((target("sse4.1")))
+inline void extremosSse(const int* d, long n, int& min, int& max) {
+    long i = 0;
+    if (n >= 4) {
+        __m128i vmin = _mm_set1_epi32(min);
+        __m128i vmax = _mm_set1_epi32(max);
+        for (; i + 4 <= n; i += 4) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(d + i));
+            vmin = _mm_min_epi32(vmin, v);
+            vmax = _mm_max_epi32(vmax, v);
+        }
+        int tmin[4], tmax[4];
+        _mm_storeu_si128((__m128i*)tmin, vmin);
+        _mm_storeu_si128((__m128i*)tmax, vmax);
+        extremosEscalar(tmin, 4, min, max);
+        extremosEscalar(tmax, 4, min, max);
+    }
+    extremosEscalar(d + i, n - i, min, max);
+}
+
+__attribute__((target("sse4.1")))
+inline void extremosSse(const float* d, long n, float& min, float& max) {
+    long i = 0;
+    if (n >= 4) {
+        __m128 vmin = _mm_set1_ps(min);
+        __m128 vmax = _mm_set1_ps(max);
+        for (; i + 4 <= n; i += 4) {
+            __m128 v = _mm_loadu_ps(d + i);
+            vmin = _mm_min_ps(vmin, v);
+            vmax = _mm_max_ps(vmax, v);
+        }
+        float tmin[4], tmax[4];
+        _mm_storeu_ps(tmin, vmin);
+        _mm_storeu_ps(tmax, vmax);
+        extremosEscalar(tmin, 4, min, max);
+        extremosEscalar(tmax, 4, min, max);
+    }
+    extremosEscalar(d + i, n - i, min, max);
+}
+
+__attribute__((target("sse4.1")))
+inline long contarMayoresSse(const int* d, long n, int umbral) {
+    __m128i u = _mm_set1_epi32(umbral);
+    __m128i cuenta = _mm_setzero_si128();
+    long i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(d + i));
+        cuenta = _mm_sub_epi32(cuenta, _mm_cmpgt_epi32(v, u));
+    }
+    int t[4];
+    _mm_storeu_si128((__m128i*)t, cuenta);
+    return (long)t[0] + t[1] + t[2] + t[3] + contarMayoresEscalar(d + i, n - i, umbral);
+}
+
+__attribute__((target("sse4.1")))
+inline long contarMayoresSse(const float* d, long n, float umbral) {
+    __m128 u = _mm_set1_ps(umbral);
+    __m128i cuenta = _mm_setzero_si128();
+    long i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_loadu_ps(d + i);
+        cuenta = _mm_sub_epi32(cuenta, _mm_castps_si128(_mm_cmpgt_ps(v, u)));
+    }
+    int t[4];
+    _mm_storeu_si128((__m128i*)t, cuenta);
+    return (long)t[0] + t[1] + t[2] + t[3] + contarMayoresEscalar(d + i, n - i, umbral);
+}
+
+// ---------------------------------------------------------------------------
+// AVX2 (256 bits)
+// ---------------------------------------------------------------------------
+
+__attribute__((target("avx2")))
+inline long long sumarAvx2(const int* d, long n) {
+    __m256i a0 = _mm256_setzero_si256();
+    __m256i a1 = _mm256_setzero_si256();
+    long i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(d + i));
+        a0 = _mm256_add_epi64(a0, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+        a1 = _mm256_add_epi64(a1, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+    }
+    long long t[4];
+    _mm256_storeu_si256((__m256i*)t, _mm256_add_epi64(a0, a1));
+    return t[0] + t[1] + t[2] + t[3] + sumarEscalar<int, long long>(d + i, n - i);
+}
+
+__attribute__((target("avx2")))
+inline double sumarAvx2(const float* d, long n) {
+    __m256d a0 = _mm256_setzero_pd();
+    __m256d a1 = _mm256_setzero_pd();
+    long i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(d + i);
+        a0 = _mm256_add_pd(a0, _mm256_cvtps_pd(_mm256_castps256_ps128(v)));
+        a1 = _mm256_add_pd(a1, _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)));
+    }
+    double t[4];
+    _mm256_storeu_pd(t, _mm256_add_pd(a0, a1));
+    return t[0] + t[1] + t[2] + t[3] + sumarEscalar<float, double>(d + i, n - i);
+}
+
+__attribute__((target("avx2")))
+inline void extremosAvx2(const int* d, long n, int& min, int& max) {
+    long i = 0;
+    if (n >= 8) {
+        __m256i vmin = _mm256_set1_epi32(min);
+        __m256i vmax = _mm256_set1_epi32(max);
+        for (; i + 8 <= n; i += 8) {
+            __m256i v = _mm256_loadu_si256((const __m256i*)(d + i));
+            vmin = _mm256_min_epi32(vmin, v);
+            vmax = _mm256_max_epi32(vmax, v);
+        }
+        int tmin[8], tmax[8];
+        _mm256_storeu_si256((__m256i*)tmin, vmin);
+        _mm256_storeu_si256((__m256i*)tmax, vmax);
+        extremosEscalar(tmin, 8, min, max);
+        extremosEscalar(tmax, 8, min, max);
+    }
+    extremosEscalar(d + i, n - i, min, max);
+}
+
+__attribute__((target("avx2")))
+inline void extremosAvx2(const float* d, long n, float& min, float& max) {
+    long i = 0;
+    if (n >= 8) {
+        __m256 vmin = _mm256_set1_ps(min);
+        __m256 vmax = _mm256_set1_ps(max);
+        for (; i + 8 <= n; i += 8) {
+            __m256 v = _mm256_loadu_ps(d + i);
+            vmin = _mm256_min_ps(vmin, v);
+            vmax = _mm256_max_ps(vmax, v);
+        }
+        float tmin[8], tmax[8];
+        _mm256_storeu_ps(tmin, vmin);
+        _mm256_storeu_ps(tmax, vmax);
+        extremosEscalar(tmin, 8, min, max);
+        extremosEscalar(tmax, 8, min, max);
+    }
+    extremosEscalar(d + i, n - i, min, max);
+}
+
+__attribute__((target("avx2")))
+inline long contarMayoresAvx2(const int* d, long n, int umbral) {
+    __m256i u = _mm256_set1_epi32(umbral);
+    __m256i cuenta = _mm256_setzero_si256();
+    long i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(d + i));
+        cuenta = _mm256_sub_epi32(cuenta, _mm256_cmpgt_epi32(v, u));
+    }
+    int t[8];
+    _mm256_storeu_si256((__m256i*)t, cuenta);
+    long total = 0;
+    for (int k = 0; k < 8; k++) total += t[k];
+    return total + contarMayoresEscalar(d + i, n - i, umbral);
+}
+
+__attribute__((target("avx2")))
+inline long contarMayoresAvx2(const float* d, long n, float umbral) {
+    __m256 u = _mm256_set1_ps(umbral);
+    __m256i cuenta = _mm256_setzero_si256();
+    long i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(d + i);
+        cuenta = _mm256_sub_epi32(cuenta, _mm256_castps_si256(_mm256_cmp_ps(v, u, _CMP_GT_OQ)));
+    }
+    int t[8];
+    _mm256_storeu_si256((__m256i*)t, cuenta);
+    long total = 0;
+    for (int k = 0; k < 8; k++) total += t[k];
+    return total + contarMayoresEscalar(d + i, n - i, umbral);
+}
+
+#endif // KERNELES_X86
+
+// ---------------------------------------------------------------------------
+// Puntos de entrada con selección en ejecución
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Suma exacta de lecturas enteras
+ * @param d Arreglo contiguo
+ * @param n Número de elementos
+ */
+inline long long sumarLecturas(const int* d, long n) {
+#if KERNELES_X86
+    if (nivelSimd() == SIMD_AVX2) return sumarAvx2(d, n);
+    if (nivelSimd() == SIMD_SSE41) return sumarSse(d, n);
+#endif
+    return sumarEscalar<int, long long>(d, n);
+}
+
+/**
+ * @brief Suma de lecturas flotantes acumulada en double
+ * @param d Arreglo contiguo
+ * @param n Número de elementos
+ */
+inline double sumarLecturas(const float* d, long n) {
+#if KERNELES_X86
+    if (nivelSimd() == SIMD_AVX2) return sumarAvx2(d, n);
+    if (nivelSimd() == SIMD_SSE41) return sumarSse(d, n);
+#endif
+    return sumarEscalar<float, double>(d, n);
+}
+
+/**
+ * @brief Actualiza min y max con los elementos del arreglo
+ * @param d Arreglo contiguo
+ * @param n Número de elementos
+ * @param min Mínimo acumulado (entrada y salida)
+ * @param max Máximo acumulado (entrada y salida)
+ */
+inline void extremosLecturas(const int* d, long n, int& min, int& max) {
+#if KERNELES_X86
+    if (nivelSimd() == SIMD_AVX2) { extremosAvx2(d, n, min, max); return; }
+    if (nivelSimd() == SIMD_SSE41) { extremosSse(d, n, min, max); return; }
+#endif
+    extremosEscalar(d, n, min, max);
+}
+
+inline void extremosLecturas(const float* d, long n, float& min, float& max) {
+#if KERNELES_X86
+    if (nivelSimd() == SIMD_AVX2) { extremosAvx2(d, n, min, max); return; }
+    if (nivelSimd() == SIMD_SSE41) { extremosSse(d, n, min, max); return; }
+#endif
+    extremosEscalar(d, n, min, max);
+}
+
+/**
+ * @brief Cuenta las lecturas estrictamente mayores que un umbral
+ * @param d Arreglo contiguo
+ * @param n Número de elementos
+ * @param umbral Valor de corte
+ */
+inline long contarMayores(const int* d, long n, int umbral) {
+#if KERNELES_X86
+    if (nivelSimd() == SIMD_AVX2) return contarMayoresAvx2(d, n, umbral);
+    if (nivelSimd() == SIMD_SSE41) return contarMayoresSse(d, n, umbral);
+#endif
+    return contarMayoresEscalar(d, n, umbral);
+}
+
+inline long contarMayores(const float* d, long n, float umbral) {
+#if KERNELES_X86
+    if (nivelSimd() == SIMD_AVX2) return contarMayoresAvx2(d, n, umbral);
+    if (nivelSimd() == SIMD_SSE41) return contarMayoresSse(d, n, umbral);
+#endif
+    return contarMayoresEscalar(d, n, umbral);
+}
+
+/**
+ * @brief Versiones genéricas (escalares) para tipos sin kernel vectorial
+ */
+template <typename T>
+inline double sumarLecturas(const T* d, long n) {
+    return sumarEscalar<T, double>(d, n);
+}
+
+template <typename T>
+inline void extremosLecturas(const T* d, long n, T& min, T& max) {
+    extremosEscalar(d, n, min, max);
+}
+
+template <typename T>
+inline long contarMayores(const T* d, long n, T umbral) {
+    return contarMayoresEscalar(d, n, umbral);
+}
+
+/**
+ * @brief Posición de la primera lectura igual a un valor
+ * @return Índice o -1 si no aparece
+ *
+ * Se usa tras extremosLecturas() para obtener el argmin/argmax; la búsqueda
+ * se detiene en la primera coincidencia, así que rara vez recorre el arreglo.
+ */
+template <typename T>
+inline long buscarLectura(const T* d, long n, T valor) {
+    return buscarEscalar(d, n, valor);
+}
+
+/**
+ * @brief Mínimo y su primera posición en un arreglo no vacío
+ * @param d Arreglo contiguo
+ * @param n Número de elementos (> 0)
+ * @param posicion Índice de la primera aparición del mínimo
+ */
+template <typename T>
+inline T minimoLecturas(const T* d, long n, long& posicion) {
+    T min = d[0];
+    T max = d[0];
+    extremosLecturas(d, n, min, max);
+    posicion = buscarLectura(d, n, min);
+    return min;
+}
+
+#endif // KERNELESSIMD_H
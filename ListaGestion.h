@@ -9,7 +9,13 @@
 #define LISTAGESTION_H
 
 #include "SensorBase.h"
+#include "ArenaNodos.h"
+#include "IndiceNombres.h"
+#include "Registro.h"
+#include "PoolTrabajo.h"
+#include "Metricas.h"
 #include <iostream>
+#include <mutex>
 
 /**
  * @class ListaGestion
@@ -17,6 +23,19 @@
  * 
  * Permite gestionar de forma polimórfica diferentes tipos de sensores
  * (SensorTemperatura, SensorPresion) a través de punteros a la clase base.
+ * Los nodos de la lista se toman de una ArenaNodos propia.
+ *
+ * Cada sensor recibe al insertarse un handle entero (su posición de
+ * registro). Un IndiceNombres resuelve nombre -> handle en O(1) esperado,
+ * y un arreglo de handles resuelve handle -> sensor en O(1), de modo que
+ * las rutas calientes pueden internar el nombre una vez y despachar por handle.
+ *
+ * El arreglo de handles también permite procesar los sensores en paralelo
+ * (procesarTodosParalelo) repartiendo índices en un PoolTrabajo.
+ *
+ * Las métricas de cada sensor y la duración de las rondas de procesamiento
+ * pueden leerse desde otro hilo con paraCadaSensor(), que se sincroniza
+ * con insertar() (ExportadorMetricas.h).
  */
 class ListaGestion {
 private:
@@ -36,70 +55,128 @@ private:
     };
     
     NodoSensor* cabeza; ///< Primer nodo de la lista
+    NodoSensor* cola;   ///< Último nodo (inserción al final en O(1))
     int tamanio;        ///< Número de sensores en la lista
+    ArenaNodos<NodoSensor> arena; ///< Reservador de nodos de la lista
+    IndiceNombres indiceNombres;  ///< Nombre -> handle
+    SensorBase** porHandle;       ///< Handle -> sensor
+    int capacidadHandles;         ///< Capacidad del arreglo porHandle
+    PoolTrabajo* pool;            ///< Pool para procesar en paralelo (se crea al usarlo)
+    mutable std::mutex mutexRegistro; ///< Protege el registro de sensores frente a lectores de otros hilos
+    HistogramaLatencia duracionRonda; ///< Duración de cada procesarTodos / procesarTodosParalelo
+    
+    /**
+     * @brief Microsegundos con un decimal para los reportes
+     */
+    static double us(uint64_t ns) {
+        return (double)(ns / 100) / 10.0;
+    }
+    
+    /**
+     * @brief Imprime p50/p95/p99 y extremos de un bosquejo de cuantiles
+     */
+    static void imprimirPercentiles(const char* etiqueta, const BosquejoCuantiles& b) {
+        if (b.getCantidad() == 0) return;
+        double q[] = {0.5, 0.95, 0.99};
+        double p[3];
+        b.cuantiles(q, p, 3);
+        std::cout << etiqueta << ": " << b.getCantidad() << " recibidas, p50=" << p[0]
+                  << " p95=" << p[1] << " p99=" << p[2] << " (min=" << b.getMinimo()
+                  << " max=" << b.getMaximo() << ")" << std::endl;
+    }
     
 public:
     /**
      * @brief Constructor por defecto
      */
-    ListaGestion() : cabeza(nullptr), tamanio(0) {}
+    ListaGestion() : cabeza(nullptr), cola(nullptr), tamanio(0),
+                     porHandle(nullptr), capacidadHandles(0), pool(nullptr) {}
     
     /**
      * @brief Destructor - Libera todos los sensores y nodos
      */
     ~ListaGestion() {
-        std::cout << "\n--- Liberación de Memoria en Cascada ---" << std::endl;
+        REGISTRO_INFO("--- Liberación de Memoria en Cascada ---");
         while (cabeza != nullptr) {
             NodoSensor* temp = cabeza;
             cabeza = cabeza->siguiente;
             
-            std::cout << "Liberando Nodo: " << temp->sensor->getNombre() << "." << std::endl;
+            REGISTRO_DEPURACION("Liberando Nodo: " << temp->sensor->getNombre() << ".");
             delete temp->sensor; // Llama al destructor virtual
-            delete temp;
         }
-        std::cout << "Sistema cerrado. Memoria limpia." << std::endl;
+        arena.liberarTodo();
+        delete[] porHandle;
+        delete pool;
+        REGISTRO_INFO("Sistema cerrado. Memoria limpia.");
     }
     
     /**
      * @brief Inserta un sensor al final de la lista
      * @param sensor Puntero al sensor a insertar
+     * 
+     * El sensor recibe como handle su posición de registro. Si ya existía
+     * otro sensor con el mismo nombre, el nombre sigue resolviendo al primero.
      */
     void insertar(SensorBase* sensor) {
-        NodoSensor* nuevo = new NodoSensor(sensor);
+        std::lock_guard<std::mutex> lock(mutexRegistro);
+        NodoSensor* nuevo = arena.crear(sensor);
         
         if (cabeza == nullptr) {
             cabeza = nuevo;
         } else {
-            NodoSensor* actual = cabeza;
-            while (actual->siguiente != nullptr) {
-                actual = actual->siguiente;
+            cola->siguiente = nuevo;
+        }
+        cola = nuevo;
+        
+        if (tamanio == capacidadHandles) {
+            int nuevaCapacidad = capacidadHandles == 0 ? 16 : capacidadHandles * 2;
+            SensorBase** ampliado = new SensorBase*[nuevaCapacidad];
+            for (int i = 0; i < tamanio; i++) {
+                ampliado[i] = porHandle[i];
             }
-            actual->siguiente = nuevo;
+            delete[] porHandle;
+            porHandle = ampliado;
+            capacidadHandles = nuevaCapacidad;
         }
+        porHandle[tamanio] = sensor;
+        indiceNombres.insertar(sensor->getNombre(), tamanio);
         tamanio++;
-        std::cout << "Sensor '" << sensor->getNombre() << "' insertado en la lista de gestión." << std::endl;
+        REGISTRO_INFO("Sensor '" << sensor->getNombre() << "' insertado en la lista de gestión.");
     }
     
     /**
-     * @brief Busca un sensor por su nombre
+     * @brief Busca un sensor por su nombre en O(1) esperado
      * @param nombre Nombre del sensor a buscar
      * @return Puntero al sensor o nullptr si no existe
      */
     SensorBase* buscar(const char* nombre) {
-        NodoSensor* actual = cabeza;
-        while (actual != nullptr) {
-            if (strcmp(actual->sensor->getNombre(), nombre) == 0) {
-                return actual->sensor;
-            }
-            actual = actual->siguiente;
-        }
-        return nullptr;
+        return obtener(internar(nombre));
+    }
+    
+    /**
+     * @brief Convierte un nombre de sensor en su handle
+     * @param nombre Nombre del sensor
+     * @return Handle (0 .. getTamanio()-1) o -1 si no hay sensor con ese nombre
+     */
+    int internar(const char* nombre) const {
+        return indiceNombres.buscar(nombre);
+    }
+    
+    /**
+     * @brief Obtiene un sensor por handle en O(1)
+     * @param handle Handle devuelto por internar()
+     * @return Puntero al sensor o nullptr si el handle no es válido
+     */
+    SensorBase* obtener(int handle) const {
+        if (handle < 0 || handle >= tamanio) return nullptr;
+        return porHandle[handle];
     }
     
     /**
      * @brief Procesa todos los sensores de forma polimórfica
      */
     void procesarTodos() {
+        CronometroLatencia cronometro(duracionRonda);
         std::cout << "\n--- Ejecutando Polimorfismo ---" << std::endl;
         NodoSensor* actual = cabeza;
         while (actual != nullptr) {
@@ -108,6 +185,39 @@ public:
         }
     }
     
+    /**
+     * @brief Procesa todos los sensores en paralelo sin escribir en consola
+     * @param resultados Arreglo de getTamanio() elementos, indexado por handle
+     * @param hilos Pool que ejecuta el trabajo
+     */
+    void procesarEnParalelo(ResultadoProceso* resultados, PoolTrabajo& hilos) {
+        SensorBase** sensores = porHandle;
+        hilos.paraCada(tamanio, [sensores, resultados](int i) {
+            resultados[i] = sensores[i]->procesar();
+        });
+    }
+    
+    /**
+     * @brief Procesa los sensores en paralelo e imprime los resultados en orden
+     * 
+     * Produce la misma salida que procesarTodos(): los sensores se procesan
+     * en un pool del tamaño del equipo y los resultados se imprimen después,
+     * uno por sensor, en orden de registro.
+     */
+    void procesarTodosParalelo() {
+        if (pool == nullptr) {
+            pool = new PoolTrabajo();
+        }
+        CronometroLatencia cronometro(duracionRonda);
+        ResultadoProceso* resultados = new ResultadoProceso[tamanio];
+        procesarEnParalelo(resultados, *pool);
+        std::cout << "\n--- Ejecutando Polimorfismo ---" << std::endl;
+        for (int i = 0; i < tamanio; i++) {
+            porHandle[i]->imprimirResultado(resultados[i]);
+        }
+        delete[] resultados;
+    }
+    
     /**
      * @brief Imprime información de todos los sensores
      */
@@ -123,6 +233,69 @@ public:
         }
     }
     
+    /**
+     * @brief Recorre los sensores en orden de registro desde cualquier hilo
+     * @param f Función f(const SensorBase*)
+     * 
+     * Mientras dura el recorrido no se pueden insertar sensores; solo deben
+     * leerse datos seguros entre hilos, como getMetricas() y getNombre().
+     */
+    template <typename F>
+    void paraCadaSensor(F f) const {
+        std::lock_guard<std::mutex> lock(mutexRegistro);
+        for (int i = 0; i < tamanio; i++) {
+            f((const SensorBase*)porHandle[i]);
+        }
+    }
+    
+    /**
+     * @brief Duración de las rondas de procesamiento
+     */
+    const HistogramaLatencia& getDuracionRonda() const {
+        return duracionRonda;
+    }
+    
+    /**
+     * @brief Imprime las métricas de ejecución de cada sensor y de las rondas
+     */
+    void imprimirMetricas() const {
+        std::cout << "\n--- Métricas de Ejecución ---" << std::endl;
+        paraCadaSensor([](const SensorBase* sensor) {
+            const MetricasSensor& m = sensor->getMetricas();
+            std::cout << "\n" << sensor->getNombre() << ": " << m.getLecturas() << " lecturas, "
+                      << m.getFallosAnalisis() << " fallos de análisis, "
+                      << m.lecturasPorSegundo() << " lect/s (último segundo), "
+                      << m.getBytesHistorial() << " bytes de historial" << std::endl;
+            std::cout << "  Ingesta (us): p50=" << us(m.latenciaIngesta.percentil(50))
+                      << " p99=" << us(m.latenciaIngesta.percentil(99))
+                      << " max=" << us(m.latenciaIngesta.getMaximo()) << std::endl;
+            std::cout << "  Procesar (us): " << m.duracionProceso.getCantidad() << " llamadas, p50="
+                      << us(m.duracionProceso.percentil(50))
+                      << " p99=" << us(m.duracionProceso.percentil(99))
+                      << " max=" << us(m.duracionProceso.getMaximo()) << std::endl;
+            imprimirPercentiles("  Lecturas", sensor->getCuantiles());
+        });
+        std::cout << "\nRondas de procesamiento: " << duracionRonda.getCantidad() << ", p50="
+                  << us(duracionRonda.percentil(50)) << " us, max="
+                  << us(duracionRonda.getMaximo()) << " us" << std::endl;
+        imprimirPercentiles("Lecturas de todos los sensores", combinarCuantiles());
+    }
+    
+    /**
+     * @brief Combina los bosquejos de cuantiles de todos los sensores
+     * @return Bosquejo del flujo de toda la flota (percentiles globales)
+     * 
+     * Cuesta O(sensores × tamaño del bosquejo) y no toca los historiales.
+     * Como imprimirTodos(), no debe coincidir con la ingesta en otro hilo.
+     */
+    BosquejoCuantiles combinarCuantiles() const {
+        BosquejoCuantiles flota;
+        for (int i = 0; i < tamanio; i++) {
+            flota.combinar(porHandle[i]->getCuantiles());
+        }
+        return flota;
+    }
+    
     /**
      * @brief Obtiene el tamaño de la lista
      * @return Número de sensores
@@ -131,6 +304,14 @@ public:
         return tamanio;
     }
     
+    /**
+     * @brief Estadísticas del reservador de nodos de la lista de gestión
+     * @return Nodos vivos, bytes reservados y fragmentación de la arena
+     */
+    EstadisticasArena estadisticasMemoria() const {
+        return arena.estadisticas();
+    }
+    
     /**
      * @brief Verifica si la lista está vacía
      * @return true si está vacía
@@ -8,56 +8,150 @@
 #ifndef LISTASENSOR_H
 #define LISTASENSOR_H
 
+#include "ArenaNodos.h"
+#include "AcumuladorLecturas.h"
+#include "IndiceOrden.h"
+#include "Registro.h"
+#include "KernelesSimd.h"
+#include "Metricas.h"
 #include <iostream>
+#include <algorithm>
+#include <type_traits>
+#include <climits>
+
+/**
+ * @brief Lecturas por nodo que usan los sensores del sistema (modo desenrollado)
+ */
+const int LECTURAS_POR_BLOQUE = 32;
 
 /**
  * @class ListaSensor
  * @brief Lista enlazada simple genérica para almacenar lecturas de sensores
  * @tparam T Tipo de dato a almacenar (int, float, double, etc.)
+ * @tparam N Lecturas contiguas por nodo (1 = lista clásica, >1 = lista desenrollada)
  * 
  * Implementa una estructura de datos dinámica con gestión manual de memoria
  * para almacenar lecturas de sensores de forma flexible.
+ *
+ * Con N > 1 cada nodo guarda un bloque de hasta N lecturas contiguas, lo que
+ * reduce el costo del puntero y de la reserva por lectura y permite recorrer
+ * el historial con menos saltos de memoria. La interfaz es la misma en ambos modos.
+ *
+ * Los nodos se obtienen de una ArenaNodos propia de la lista, de modo que
+ * insertar y eliminar no pasan por new/delete y liberar el historial
+ * completo solo devuelve los bloques de la arena.
+ *
+ * Conteo, suma, varianza y extremos se mantienen en un AcumuladorLecturas
+ * actualizado en cada inserción y eliminación, por lo que las consultas
+ * de promedio, varianza, mínimo y máximo cuestan O(1).
+ *
+ * Opcionalmente (activarIndice()) la lista mantiene un IndiceOrden con cada
+ * lectura y el nodo que la contiene. Con él, eliminar el mínimo o el máximo,
+ * la mediana, cualquier percentil y eliminar las k menores cuestan O(log n)
+ * por lectura, mientras la lista conserva el orden de inserción.
+ *
+ * Con establecerRetencion() la lista se comporta como un búfer circular:
+ * conserva solo las últimas lecturas (por cantidad y/o por antigüedad) y
+ * descarta las más viejas desde la cabeza al insertar. Los bloques que se
+ * vacían vuelven a la lista libre de la arena y el siguiente bloque de la
+ * cola reutiliza esa misma celda, así que en régimen estable no se reserva
+ * memoria. Promedio, extremos, eliminarMinimo y percentiles operan sobre la
+ * ventana retenida.
+ *
+ * La copia duplica los bloques de lecturas uno a uno, en O(n). Mover una
+ * lista o anexarle otra (empalmar()) no copia lecturas ni reserva nodos:
+ * los nodos y la arena de la otra lista pasan a esta.
+ *
+ * Cada lectura lleva su marca de tiempo en milisegundos monótonos (la que
+ * se pase a insertar() o, si no, el instante de inserción), guardada como
+ * desfase de 32 bits respecto de la primera del bloque. Las marcas nunca
+ * retroceden: una anterior a la última se iguala a ella. Así los bloques
+ * quedan ordenados por tiempo y consultarVentana() ubica el primero por
+ * búsqueda binaria en un índice disperso (un puntero por bloque), de modo
+ * que conteo, promedio y extremos de un intervalo cuestan O(log bloques)
+ * más las lecturas del intervalo, sin importar el largo del historial.
  */
-template <typename T>
+template <typename T, int N = 1>
 class ListaSensor {
+    static_assert(N >= 1, "Cada nodo debe poder almacenar al menos una lectura");
+
 private:
     /**
      * @struct Nodo
-     * @brief Estructura que representa un nodo de la lista enlazada
+     * @brief Estructura que representa un nodo (bloque de lecturas) de la lista enlazada
      */
     struct Nodo {
-        T dato;           ///< Valor almacenado en el nodo
+        T datos[N];       ///< Lecturas almacenadas en el nodo, en orden de inserción
+        int desfase[N];   ///< Milisegundos de cada lectura desde base
+        int cantidad;     ///< Número de posiciones ocupadas en datos
         Nodo* siguiente;  ///< Puntero al siguiente nodo
+        long long base;   ///< Milisegundos de la primera lectura que tuvo el bloque
+        long long marca;  ///< Milisegundos de la última inserción
         
         /**
          * @brief Constructor del nodo
-         * @param valor Valor a almacenar
+         * @param valor Primer valor a almacenar
+         * @param t Marca de tiempo del valor
+         */
+        Nodo(T valor, long long t) : cantidad(1), siguiente(nullptr), base(t), marca(t) {
+            datos[0] = valor;
+            desfase[0] = 0;
+        }
+        
+        /**
+         * @brief Marca de tiempo de la lectura i
          */
-        Nodo(T valor) : dato(valor), siguiente(nullptr) {}
+        long long marcaEn(int i) const {
+            return base + desfase[i];
+        }
     };
     
-    Nodo* cabeza; ///< Puntero al primer nodo de la lista
-    int tamanio;  ///< Número de elementos en la lista
+    Nodo* cabeza;  ///< Puntero al primer nodo de la lista
+    Nodo* cola;    ///< Puntero al último nodo (inserción al final en O(1))
+    int tamanio;   ///< Número de elementos en la lista
+    int numNodos;  ///< Número de nodos reservados
+    ArenaNodos<Nodo> arena; ///< Reservador de nodos propio de la lista
+    mutable AcumuladorLecturas<T> acumulador; ///< Agregados incrementales del historial
+    IndiceOrden<T>* indice; ///< Índice de orden opcional (nullptr si está desactivado)
+    int nodosVacios;        ///< Nodos sin lecturas pendientes de purgar (solo con índice)
+    int maxLecturas;        ///< Lecturas retenidas como máximo (0 = sin límite)
+    long long maxMs;        ///< Antigüedad máxima en milisegundos (0 = sin límite)
+    long descartadas;       ///< Lecturas descartadas por la política de retención
+    long long ultimaMarca;  ///< Marca de la lectura más reciente (las siguientes no retroceden)
+    mutable Nodo** bloquesTiempo;  ///< Índice disperso: los nodos en orden de tiempo
+    mutable int primerBloque;      ///< Primera posición vigente de bloquesTiempo
+    mutable int finBloques;        ///< Posición siguiente a la última vigente
+    mutable int capacidadBloques;  ///< Capacidad de bloquesTiempo
+    mutable bool tiempoAlDia;      ///< false si hay que reconstruir el índice antes de consultar
     
 public:
     /**
      * @brief Constructor por defecto
      */
-    ListaSensor() : cabeza(nullptr), tamanio(0) {}
+    ListaSensor() : cabeza(nullptr), cola(nullptr), tamanio(0), numNodos(0),
+                    indice(nullptr), nodosVacios(0), maxLecturas(0), maxMs(0), descartadas(0),
+                    ultimaMarca(0), bloquesTiempo(nullptr), primerBloque(0), finBloques(0),
+                    capacidadBloques(0), tiempoAlDia(true) {}
     
     /**
      * @brief Destructor - Libera toda la memoria de los nodos
      */
     ~ListaSensor() {
-        std::cout << "  Liberando lista interna..." << std::endl;
+        REGISTRO_DEPURACION("  Liberando lista interna...");
         limpiar();
+        delete indice;
+        delete[] bloquesTiempo;
     }
     
     /**
      * @brief Constructor de copia (Regla de los Tres)
      * @param otra Lista a copiar
      */
-    ListaSensor(const ListaSensor& otra) : cabeza(nullptr), tamanio(0) {
+    ListaSensor(const ListaSensor& otra) : cabeza(nullptr), cola(nullptr), tamanio(0), numNodos(0),
+                                           indice(nullptr), nodosVacios(0), maxLecturas(0),
+                                           maxMs(0), descartadas(0), ultimaMarca(0),
+                                           bloquesTiempo(nullptr), primerBloque(0), finBloques(0),
+                                           capacidadBloques(0), tiempoAlDia(true) {
         copiar(otra);
     }
     
@@ -69,83 +163,498 @@ public:
     ListaSensor& operator=(const ListaSensor& otra) {
         if (this != &otra) {
             limpiar();
+            if (otra.indice == nullptr) {
+                desactivarIndice();
+            }
             copiar(otra);
         }
         return *this;
     }
     
+    /**
+     * @brief Constructor de movimiento, O(1)
+     * @param otra Lista que cede sus nodos, índice y retención (queda vacía)
+     */
+    ListaSensor(ListaSensor&& otra) noexcept
+        : cabeza(otra.cabeza), cola(otra.cola), tamanio(otra.tamanio), numNodos(otra.numNodos),
+          arena(std::move(otra.arena)), acumulador(otra.acumulador), indice(otra.indice),
+          nodosVacios(otra.nodosVacios), maxLecturas(otra.maxLecturas), maxMs(otra.maxMs),
+          descartadas(otra.descartadas), ultimaMarca(otra.ultimaMarca),
+          bloquesTiempo(otra.bloquesTiempo), primerBloque(otra.primerBloque),
+          finBloques(otra.finBloques), capacidadBloques(otra.capacidadBloques),
+          tiempoAlDia(otra.tiempoAlDia) {
+        otra.bloquesTiempo = nullptr;
+        otra.capacidadBloques = 0;
+        otra.soltar();
+        otra.indice = nullptr;
+        otra.maxLecturas = 0;
+        otra.maxMs = 0;
+        otra.descartadas = 0;
+    }
+    
+    /**
+     * @brief Asignación de movimiento: libera las lecturas propias y toma las de otra
+     * @param otra Lista que cede sus nodos, índice y retención (queda vacía)
+     * @return Referencia a esta lista
+     */
+    ListaSensor& operator=(ListaSensor&& otra) noexcept {
+        if (this != &otra) {
+            limpiar();
+            delete indice;
+            delete[] bloquesTiempo;
+            cabeza = otra.cabeza;
+            cola = otra.cola;
+            tamanio = otra.tamanio;
+            numNodos = otra.numNodos;
+            arena = std::move(otra.arena);
+            acumulador = otra.acumulador;
+            indice = otra.indice;
+            nodosVacios = otra.nodosVacios;
+            maxLecturas = otra.maxLecturas;
+            maxMs = otra.maxMs;
+            descartadas = otra.descartadas;
+            ultimaMarca = otra.ultimaMarca;
+            bloquesTiempo = otra.bloquesTiempo;
+            primerBloque = otra.primerBloque;
+            finBloques = otra.finBloques;
+            capacidadBloques = otra.capacidadBloques;
+            tiempoAlDia = otra.tiempoAlDia;
+            otra.bloquesTiempo = nullptr;
+            otra.capacidadBloques = 0;
+            otra.soltar();
+            otra.indice = nullptr;
+            otra.maxLecturas = 0;
+            otra.maxMs = 0;
+            otra.descartadas = 0;
+        }
+        return *this;
+    }
+    
     /**
      * @brief Inserta un elemento al final de la lista
      * @param valor Valor a insertar
+     * @param marcaMs Milisegundos monótonos de la lectura (0 = ahora)
+     * 
+     * Si el último nodo tiene espacio libre la lectura se guarda en él;
+     * solo se reserva un nodo nuevo cuando el bloque final está lleno (o
+     * cuando la marca ya no cabe en el desfase de 32 bits del bloque).
      */
-    void insertar(T valor) {
-        Nodo* nuevo = new Nodo(valor);
+    void insertar(T valor, long long marcaMs = 0) {
+        if (maxLecturas > 0 && tamanio >= maxLecturas) {
+            descartarPrimera();
+        }
+        long long ahora = 0;
+        if (marcaMs <= 0 || maxMs > 0) {
+            ahora = ahoraMs();
+        }
+        if (maxMs > 0) {
+            caducar(ahora - maxMs);
+        }
+        long long marca = marcaMs > 0 ? marcaMs : ahora;
+        if (marca < ultimaMarca) {
+            marca = ultimaMarca;
+        }
+        ultimaMarca = marca;
+        if (cola != nullptr && cola->cantidad < N && marca - cola->base <= INT_MAX) {
+            if (cola->cantidad == 0) {
+                nodosVacios--;
+            }
+            cola->desfase[cola->cantidad] = (int)(marca - cola->base);
+            cola->datos[cola->cantidad++] = valor;
+            cola->marca = marca;
+        } else {
+            Nodo* nuevo = arena.crear(valor, marca);
+            if (cabeza == nullptr) {
+                cabeza = nuevo;
+            } else {
+                cola->siguiente = nuevo;
+            }
+            cola = nuevo;
+            numNodos++;
+            anotarBloque(nuevo);
+        }
+        tamanio++;
+        acumulador.agregar(valor);
+        if (indice != nullptr) {
+            indice->insertar(valor, cola);
+        }
+        REGISTRO_TRAZA("Insertando nuevo nodo con valor: " << valor);
+    }
+    
+    /**
+     * @brief Anexa al final todas las lecturas de otra lista sin copiarlas
+     * @param otra Lista cuyas lecturas pasan a esta (queda vacía, conserva su índice y retención)
+     * 
+     * Los nodos de la otra lista se enlazan tras la cola y su arena se
+     * incorpora a la de esta lista: O(1) más, si corresponde,
+     * - indexar las lecturas anexadas si esta lista tiene índice,
+     * - purgar los nodos vacíos que la otra dejó por su índice,
+     * - adelantar las marcas anexadas que sean anteriores a la última de esta lista,
+     * - y descartar lo que exceda la ventana de retención.
+     */
+    void empalmar(ListaSensor& otra) {
+        if (this == &otra) return;
+        if (otra.indice != nullptr) {
+            otra.indice->limpiar();
+        }
+        otra.purgarVacios();
+        if (otra.cabeza == nullptr) {
+            otra.limpiar();
+            return;
+        }
+        adelantarMarcas(otra.cabeza, ultimaMarca);
+        if (otra.ultimaMarca > ultimaMarca) {
+            ultimaMarca = otra.ultimaMarca;
+        }
         
+        Nodo* primero = otra.cabeza;
+        arena.absorber(otra.arena);
         if (cabeza == nullptr) {
-            cabeza = nuevo;
+            cabeza = primero;
         } else {
-            Nodo* actual = cabeza;
-            while (actual->siguiente != nullptr) {
-                actual = actual->siguiente;
+            cola->siguiente = primero;
+        }
+        cola = otra.cola;
+        int anexadas = otra.tamanio;
+        tamanio += otra.tamanio;
+        numNodos += otra.numNodos;
+        acumulador.combinar(otra.acumulador);
+        tiempoAlDia = false;
+        otra.soltar();
+        
+        if (indice != nullptr) {
+            // Reconstruir es más barato que insertar cuando se anexa mucho
+            if (anexadas * 8 > tamanio) {
+                indexarTodo();
+            } else {
+                for (Nodo* actual = primero; actual != nullptr; actual = actual->siguiente) {
+                    for (int i = 0; i < actual->cantidad; i++) {
+                        indice->insertar(actual->datos[i], actual);
+                    }
+                }
             }
-            actual->siguiente = nuevo;
         }
-        tamanio++;
-        std::cout << "Insertando nuevo nodo con valor: " << valor << std::endl;
+        while (maxLecturas > 0 && tamanio > maxLecturas) {
+            descartarPrimera();
+        }
+        aplicarRetencion();
+        REGISTRO_TRAZA("Anexadas " << anexadas << " lecturas de otra lista");
+    }
+    
+    /**
+     * @brief Anexa al final las lecturas de una lista temporal sin copiarlas
+     * @param otra Lista cuyas lecturas pasan a esta (ver empalmar())
+     */
+    void anexar(ListaSensor&& otra) {
+        empalmar(otra);
+    }
+    
+    /**
+     * @brief Define la ventana de lecturas que conserva la lista
+     * @param lecturas Máximo de lecturas retenidas (0 = sin límite)
+     * @param segundos Antigüedad máxima de las lecturas (0 = sin límite)
+     * 
+     * Las lecturas que ya no caben se descartan de inmediato. La antigüedad
+     * se mide por bloque (marca de su última lectura), así que pueden quedar
+     * hasta N-1 lecturas algo más viejas que el límite en el bloque de la cabeza.
+     */
+    void establecerRetencion(int lecturas, double segundos) {
+        maxLecturas = lecturas > 0 ? lecturas : 0;
+        maxMs = segundos > 0.0 ? (long long)(segundos * 1000.0) : 0;
+        while (maxLecturas > 0 && tamanio > maxLecturas) {
+            descartarPrimera();
+        }
+        aplicarRetencion();
+    }
+    
+    /**
+     * @brief Descarta las lecturas que superaron la antigüedad máxima
+     * 
+     * insertar() ya lo hace; esta llamada sirve para actualizar la ventana
+     * de un sensor que dejó de recibir lecturas antes de procesarlo.
+     */
+    void aplicarRetencion() {
+        if (maxMs > 0) {
+            caducar(ahoraMs() - maxMs);
+        }
     }
     
     /**
-     * @brief Calcula el promedio de los elementos
-     * @return Promedio de tipo T
+     * @brief Máximo de lecturas retenidas (0 = sin límite)
+     */
+    int getMaxLecturas() const {
+        return maxLecturas;
+    }
+    
+    /**
+     * @brief Antigüedad máxima retenida en segundos (0 = sin límite)
+     */
+    double getMaxSegundos() const {
+        return maxMs / 1000.0;
+    }
+    
+    /**
+     * @brief Lecturas descartadas por la política de retención desde la creación
+     */
+    long getDescartadas() const {
+        return descartadas;
+    }
+    
+    /**
+     * @brief Calcula el promedio de los elementos en O(1)
+     * @return Promedio de tipo T (truncado si T es entero)
      */
     T calcularPromedio() const {
         if (tamanio == 0) return T(0);
-        
-        T suma = T(0);
-        Nodo* actual = cabeza;
-        while (actual != nullptr) {
-            suma += actual->dato;
-            actual = actual->siguiente;
-        }
-        return suma / tamanio;
+        return (T)(acumulador.getSuma() / tamanio);
+    }
+    
+    /**
+     * @brief Varianza poblacional de los elementos en O(1)
+     * @return Varianza (0 si la lista está vacía)
+     */
+    double calcularVarianza() const {
+        return acumulador.varianza();
+    }
+    
+    /**
+     * @brief Obtiene el menor elemento sin eliminarlo
+     * @return Valor mínimo (T(0) si la lista está vacía)
+     */
+    T obtenerMinimo() const {
+        if (tamanio == 0) return T(0);
+        recalcularExtremos();
+        return acumulador.getMinimo();
+    }
+    
+    /**
+     * @brief Obtiene el mayor elemento
+     * @return Valor máximo (T(0) si la lista está vacía)
+     */
+    T obtenerMaximo() const {
+        if (tamanio == 0) return T(0);
+        recalcularExtremos();
+        return acumulador.getMaximo();
     }
     
     /**
      * @brief Encuentra y elimina el valor mínimo de la lista
      * @return Valor mínimo encontrado
+     * 
+     * Con índice cuesta O(log n). Sin él se hace un recorrido en el que también
+     * se obtienen el segundo menor y el máximo, que pasan a ser los extremos
+     * exactos de las lecturas restantes.
      */
     T eliminarMinimo() {
-        if (cabeza == nullptr) return T(0);
+        if (tamanio == 0) return T(0);
         
-        // Buscar el mínimo
-        Nodo* actual = cabeza;
-        Nodo* nodoMin = cabeza;
-        Nodo* prevMin = nullptr;
-        Nodo* prev = nullptr;
+        T valorMin = indice != nullptr ? extraerIndexado(false) : extraerLineal(false);
+        REGISTRO_DEPURACION("    Nodo " << valorMin << " eliminado (mínimo).");
+        return valorMin;
+    }
+    
+    /**
+     * @brief Encuentra y elimina el valor máximo de la lista
+     * @return Valor máximo encontrado (O(log n) con índice, O(n) sin él)
+     */
+    T eliminarMaximo() {
+        if (tamanio == 0) return T(0);
         
-        while (actual != nullptr) {
-            if (actual->dato < nodoMin->dato) {
-                nodoMin = actual;
-                prevMin = prev;
-            }
-            prev = actual;
-            actual = actual->siguiente;
+        T valorMax = indice != nullptr ? extraerIndexado(true) : extraerLineal(true);
+        REGISTRO_DEPURACION("    Nodo " << valorMax << " eliminado (máximo).");
+        return valorMax;
+    }
+    
+    /**
+     * @brief Elimina las k lecturas más bajas
+     * @param k Número de lecturas a eliminar
+     * @return Número de lecturas eliminadas (menor que k si la lista se agota)
+     */
+    int eliminarMenores(int k) {
+        int eliminadas = 0;
+        while (eliminadas < k && tamanio > 0) {
+            eliminarMinimo();
+            eliminadas++;
         }
-        
-        T valorMin = nodoMin->dato;
-        
-        // Eliminar el nodo mínimo
-        if (prevMin == nullptr) {
-            cabeza = cabeza->siguiente;
-        } else {
-            prevMin->siguiente = nodoMin->siguiente;
+        return eliminadas;
+    }
+    
+    /**
+     * @brief Obtiene la k-ésima lectura en orden ascendente (0 = mínimo)
+     * @param k Rango buscado, 0 <= k < getTamanio()
+     * @return Valor en esa posición (T(0) si k está fuera de rango)
+     * 
+     * O(log n) con índice; sin él se copia el historial y se usa selección, O(n).
+     */
+    T obtenerKesimo(int k) const {
+        if (k < 0 || k >= tamanio) return T(0);
+        if (indice != nullptr) {
+            return indice->kesimo(k).valor;
         }
         
-        std::cout << "    Nodo " << valorMin << " eliminado (mínimo)." << std::endl;
-        delete nodoMin;
-        tamanio--;
-        
-        return valorMin;
+        T* valores = new T[tamanio];
+        exportar(valores);
+        std::nth_element(valores, valores + k, valores + tamanio);
+        T resultado = valores[k];
+        delete[] valores;
+        return resultado;
+    }
+    
+    /**
+     * @brief Obtiene un percentil por el método del rango más cercano
+     * @param p Percentil entre 0 y 100
+     * @return Menor lectura que deja al menos el p% de las lecturas a su izquierda
+     */
+    T obtenerPercentil(double p) const {
+        if (tamanio == 0) return T(0);
+        int k = (int)(p / 100.0 * tamanio + 0.999999999) - 1;
+        if (k < 0) k = 0;
+        if (k >= tamanio) k = tamanio - 1;
+        return obtenerKesimo(k);
+    }
+    
+    /**
+     * @brief Obtiene la mediana (inferior, si la cantidad es par)
+     * @return Lectura central
+     */
+    T obtenerMediana() const {
+        return obtenerKesimo((tamanio - 1) / 2);
+    }
+    
+    /**
+     * @brief Cuenta las lecturas estrictamente mayores que un umbral
+     * @param umbral Valor de corte
+     * @return Número de lecturas > umbral (kernel vectorial por bloque)
+     */
+    int contarMayoresQue(T umbral) const {
+        long cuenta = 0;
+        for (Nodo* actual = cabeza; actual != nullptr; actual = actual->siguiente) {
+            cuenta += contarMayores(actual->datos, actual->cantidad, umbral);
+        }
+        return (int)cuenta;
+    }
+    
+    /**
+     * @brief Copia las lecturas, en orden de inserción, a un arreglo contiguo
+     * @param destino Arreglo de al menos getTamanio() elementos
+     * @return Lecturas copiadas
+     * 
+     * Para aplicar los kernels de KernelesSimd.h (u otro código que espere
+     * un arreglo) sobre todo el historial de una vez.
+     */
+    int exportar(T* destino) const {
+        int pos = 0;
+        for (Nodo* actual = cabeza; actual != nullptr; actual = actual->siguiente) {
+            std::copy(actual->datos, actual->datos + actual->cantidad, destino + pos);
+            pos += actual->cantidad;
+        }
+        return pos;
+    }
+    
+    /**
+     * @brief Recorre el historial como una secuencia de tramos contiguos sin copiarlo
+     * @param f Función f(const T* datos, int cantidad) llamada una vez por bloque
+     */
+    template <typename F>
+    void paraCadaBloque(F f) const {
+        for (Nodo* actual = cabeza; actual != nullptr; actual = actual->siguiente) {
+            if (actual->cantidad > 0) {
+                f(actual->datos, actual->cantidad);
+            }
+        }
+    }
+    
+    /**
+     * @brief Recorre las lecturas en orden de inserción junto con su marca de tiempo
+     * @param f Función f(T valor, long long marcaMs)
+     */
+    template <typename F>
+    void paraCadaLectura(F f) const {
+        for (Nodo* actual = cabeza; actual != nullptr; actual = actual->siguiente) {
+            for (int i = 0; i < actual->cantidad; i++) {
+                f(actual->datos[i], actual->marcaEn(i));
+            }
+        }
+    }
+    
+    /**
+     * @brief Conteo, suma y extremos de las lecturas con marca en [desde, hasta]
+     * @param desde Milisegundos monótonos del inicio (inclusive)
+     * @param hasta Milisegundos monótonos del final (inclusive)
+     * @return Agregados del intervalo (cantidad 0 si no hay lecturas en él)
+     * 
+     * Busca por bisección el primer bloque cuya última marca no es anterior
+     * a desde y avanza hasta el primero que empieza después de hasta. Solo
+     * los dos bloques de los bordes se revisan lectura por lectura; los
+     * demás se resumen con los kernels de KernelesSimd.h. El índice se
+     * mantiene al insertar y al descartar desde la cabeza; la consulta
+     * siguiente a desenlazar un nodo intermedio o a empalmar otra lista lo
+     * reconstruye en O(bloques).
+     */
+    VentanaLecturas<T> consultarVentana(long long desde, long long hasta) const {
+        VentanaLecturas<T> v;
+        if (tamanio == 0 || hasta < desde) return v;
+        if (!tiempoAlDia) {
+            reconstruirBloquesTiempo();
+        }
+        Nodo** fin = bloquesTiempo + finBloques;
+        Nodo** p = std::lower_bound(bloquesTiempo + primerBloque, fin, desde,
+                                    [](const Nodo* n, long long t) { return n->marca < t; });
+        for (; p != fin; ++p) {
+            const Nodo* n = *p;
+            if (n->cantidad == 0) continue;
+            long long primera = n->marcaEn(0);
+            if (primera > hasta) break;
+            long long ultima = n->marcaEn(n->cantidad - 1);
+            if (primera >= desde && ultima <= hasta) {
+                T min = n->datos[0];
+                T max = n->datos[0];
+                extremosLecturas(n->datos, n->cantidad, min, max);
+                v.agregarTramo(n->cantidad, sumarLecturas(n->datos, n->cantidad), min, max, primera, ultima);
+                continue;
+            }
+            for (int i = 0; i < n->cantidad; i++) {
+                long long t = n->marcaEn(i);
+                if (t >= desde && t <= hasta) {
+                    v.agregar(n->datos[i], t);
+                }
+            }
+        }
+        return v;
+    }
+    
+    /**
+     * @brief Marca de la lectura más reciente que recibió la lista (0 si nunca recibió)
+     */
+    long long getUltimaMarca() const {
+        return ultimaMarca;
+    }
+    
+    /**
+     * @brief Construye el índice de orden sobre las lecturas actuales, O(n log n)
+     */
+    void activarIndice() {
+        if (indice != nullptr) return;
+        indice = new IndiceOrden<T>();
+        indexarTodo();
+    }
+    
+    /**
+     * @brief Descarta el índice de orden y purga los nodos que quedaron vacíos
+     */
+    void desactivarIndice() {
+        if (indice == nullptr) return;
+        delete indice;
+        indice = nullptr;
+        purgarVacios();
+    }
+    
+    /**
+     * @brief Indica si la lista mantiene índice de orden
+     * @return true si el índice está activo
+     */
+    bool tieneIndice() const {
+        return indice != nullptr;
     }
     
     /**
@@ -156,12 +665,43 @@ public:
         return tamanio;
     }
     
+    /**
+     * @brief Obtiene el número de nodos reservados
+     * @return Número de nodos (bloques) en la lista
+     */
+    int getNumNodos() const {
+        return numNodos;
+    }
+    
+    /**
+     * @brief Memoria ocupada por los nodos de la lista
+     * @return Bytes reservados en nodos (sin contar la cabecera del reservador)
+     */
+    long memoriaNodos() const {
+        return (long)numNodos * (long)sizeof(Nodo);
+    }
+    
+    /**
+     * @brief Estadísticas del reservador de nodos de la lista
+     * @return Nodos vivos, bytes reservados y fragmentación de la arena
+     */
+    EstadisticasArena estadisticasMemoria() const {
+        return arena.estadisticas();
+    }
+    
+    /**
+     * @brief Elimina todas las lecturas (conserva índice y política de retención)
+     */
+    void vaciar() {
+        limpiar();
+    }
+    
     /**
      * @brief Verifica si la lista está vacía
      * @return true si está vacía, false en caso contrario
      */
     bool estaVacia() const {
-        return cabeza == nullptr;
+        return tamanio == 0;
     }
     
     /**
@@ -171,37 +711,433 @@ public:
         Nodo* actual = cabeza;
         std::cout << "    Lecturas: ";
         while (actual != nullptr) {
-            std::cout << actual->dato << " ";
+            for (int i = 0; i < actual->cantidad; i++) {
+                std::cout << actual->datos[i] << " ";
+            }
             actual = actual->siguiente;
         }
         std::cout << std::endl;
     }
     
 private:
+    /**
+     * @brief Reloj monótono en milisegundos para las marcas y la retención por tiempo
+     * 
+     * Es el reloj grueso (~4 ms de resolución): se consulta en cada inserción.
+     */
+    static long long ahoraMs() {
+        return msHistorial(relojGruesoNs());
+    }
+    
+    /**
+     * @brief Agrega un nodo recién enlazado en la cola al índice por tiempo, si está al día
+     */
+    void anotarBloque(Nodo* nodo) {
+        if (!tiempoAlDia) return;
+        if (finBloques == capacidadBloques) {
+            int vigentes = finBloques - primerBloque;
+            if (primerBloque > 0 && primerBloque * 2 >= capacidadBloques) {
+                // Al menos la mitad son cabezas ya descartadas: basta compactar
+                std::copy(bloquesTiempo + primerBloque, bloquesTiempo + finBloques, bloquesTiempo);
+            } else {
+                capacidadBloques = capacidadBloques > 0 ? capacidadBloques * 2 : 8;
+                Nodo** ampliado = new Nodo*[capacidadBloques];
+                std::copy(bloquesTiempo + primerBloque, bloquesTiempo + finBloques, ampliado);
+                delete[] bloquesTiempo;
+                bloquesTiempo = ampliado;
+            }
+            primerBloque = 0;
+            finBloques = vigentes;
+        }
+        bloquesTiempo[finBloques++] = nodo;
+    }
+    
+    /**
+     * @brief Rehace el índice por tiempo con los nodos actuales, O(bloques)
+     */
+    void reconstruirBloquesTiempo() const {
+        if (capacidadBloques < numNodos || bloquesTiempo == nullptr) {
+            delete[] bloquesTiempo;
+            capacidadBloques = numNodos > 8 ? numNodos : 8;
+            bloquesTiempo = new Nodo*[capacidadBloques];
+        }
+        finBloques = 0;
+        for (Nodo* actual = cabeza; actual != nullptr; actual = actual->siguiente) {
+            bloquesTiempo[finBloques++] = actual;
+        }
+        primerBloque = 0;
+        tiempoAlDia = true;
+    }
+    
+    /**
+     * @brief Adelanta a un límite las marcas anteriores a él, desde un nodo
+     * @param desde Primer nodo a revisar (las marcas siguientes no retroceden)
+     * @param limite Marca mínima admitida
+     * 
+     * Se detiene en el primer bloque que empieza en el límite o después, así
+     * que anexar lecturas más recientes que las propias no recorre nada.
+     */
+    static void adelantarMarcas(Nodo* desde, long long limite) {
+        for (Nodo* actual = desde; actual != nullptr; actual = actual->siguiente) {
+            if (actual->cantidad > 0 && actual->marcaEn(0) >= limite) return;
+            long long nuevaBase = actual->base > limite ? actual->base : limite;
+            for (int i = 0; i < actual->cantidad; i++) {
+                long long t = actual->marcaEn(i);
+                actual->desfase[i] = (int)((t > limite ? t : limite) - nuevaBase);
+            }
+            actual->base = nuevaBase;
+            if (actual->marca < limite) {
+                actual->marca = limite;
+            }
+        }
+    }
+    
+    /**
+     * @brief Desenlaza el nodo de la cabeza y lo devuelve a la arena
+     */
+    void quitarCabeza() {
+        Nodo* viejo = cabeza;
+        cabeza = cabeza->siguiente;
+        if (cola == viejo) {
+            cola = nullptr;
+        }
+        if (tiempoAlDia) {
+            if (primerBloque < finBloques && bloquesTiempo[primerBloque] == viejo) {
+                primerBloque++;
+            } else {
+                tiempoAlDia = false;
+            }
+        }
+        arena.destruir(viejo);
+        numNodos--;
+    }
+    
+    /**
+     * @brief Descarta la lectura más antigua, O(N)
+     */
+    void descartarPrimera() {
+        while (cabeza->cantidad == 0) {
+            nodosVacios--;
+            quitarCabeza();
+        }
+        T valor = cabeza->datos[0];
+        if (indice != nullptr) {
+            indice->eliminar(valor, cabeza);
+        }
+        std::copy(cabeza->datos + 1, cabeza->datos + cabeza->cantidad, cabeza->datos);
+        std::copy(cabeza->desfase + 1, cabeza->desfase + cabeza->cantidad, cabeza->desfase);
+        cabeza->cantidad--;
+        if (cabeza->cantidad == 0) {
+            quitarCabeza();
+        }
+        tamanio--;
+        descartadas++;
+        acumulador.quitar(valor);
+    }
+    
+    /**
+     * @brief Descarta los bloques cuya última lectura es anterior a un instante
+     * @param limite Milisegundos (mismo reloj que ahoraMs())
+     */
+    void caducar(long long limite) {
+        while (cabeza != nullptr && cabeza->marca < limite) {
+            for (int i = 0; i < cabeza->cantidad; i++) {
+                if (indice != nullptr) {
+                    indice->eliminar(cabeza->datos[i], cabeza);
+                }
+                acumulador.quitar(cabeza->datos[i]);
+            }
+            tamanio -= cabeza->cantidad;
+            descartadas += cabeza->cantidad;
+            if (cabeza->cantidad == 0) {
+                nodosVacios--;
+            }
+            quitarCabeza();
+        }
+    }
+    
     /**
      * @brief Libera toda la memoria de los nodos
+     * 
+     * Los nodos no se devuelven uno a uno: la arena libera sus bloques
+     * completos al final.
      */
     void limpiar() {
         while (cabeza != nullptr) {
             Nodo* temp = cabeza;
             cabeza = cabeza->siguiente;
-            std::cout << "    Nodo " << temp->dato << " liberado." << std::endl;
-            delete temp;
-            tamanio--;
+#if REGISTRO_NIVEL_MINIMO <= 0
+            for (int i = 0; i < temp->cantidad; i++) {
+                REGISTRO_TRAZA("    Nodo " << temp->datos[i] << " liberado.");
+            }
+#endif
+            if (!std::is_trivially_destructible<Nodo>::value) {
+                temp->~Nodo();
+            }
+        }
+        arena.liberarTodo();
+        acumulador.reiniciar();
+        if (indice != nullptr) {
+            indice->limpiar();
+        }
+        cola = nullptr;
+        tamanio = 0;
+        numNodos = 0;
+        nodosVacios = 0;
+        primerBloque = 0;
+        finBloques = 0;
+        tiempoAlDia = true;
+    }
+    
+    /**
+     * @brief Deja la lista vacía sin liberar nada (sus nodos pasaron a otra lista)
+     * 
+     * La arena ya quedó vacía al moverla o absorberla. Conserva el índice
+     * (ya vacío o cedido por quien llama) y la retención.
+     */
+    void soltar() {
+        acumulador.reiniciar();
+        cabeza = nullptr;
+        cola = nullptr;
+        tamanio = 0;
+        numNodos = 0;
+        nodosVacios = 0;
+        primerBloque = 0;
+        finBloques = 0;
+        tiempoAlDia = true;
+    }
+    
+    /**
+     * @brief Reconstruye el índice con todas las lecturas de una vez, O(n log n)
+     */
+    void indexarTodo() {
+        typename IndiceOrden<T>::Entrada* entradas = new typename IndiceOrden<T>::Entrada[tamanio];
+        int n = 0;
+        for (Nodo* actual = cabeza; actual != nullptr; actual = actual->siguiente) {
+            for (int i = 0; i < actual->cantidad; i++) {
+                entradas[n].valor = actual->datos[i];
+                entradas[n].ref = actual;
+                n++;
+            }
+        }
+        indice->reconstruir(entradas, n);
+        delete[] entradas;
+    }
+    
+    /**
+     * @brief Indica si a es más extremo que b en la dirección buscada
+     * @param a Primer valor
+     * @param b Segundo valor
+     * @param maximo true para comparar hacia el máximo, false hacia el mínimo
+     */
+    static bool precede(T a, T b, bool maximo) {
+        return maximo ? b < a : a < b;
+    }
+    
+    /**
+     * @brief Extrae el mínimo o el máximo con un recorrido completo (sin índice)
+     * @param maximo true para extraer el máximo
+     * @return Valor extraído
+     * 
+     * El recorrido obtiene los extremos de cada bloque con un kernel
+     * vectorial. El bloque con el extremo buscado se revisa después lectura
+     * por lectura para ubicar la posición y el segundo extremo.
+     */
+    T extraerLineal(bool maximo) {
+        Nodo* nodoObj = cabeza;
+        Nodo* prevObj = nullptr;
+        Nodo* prev = nullptr;
+        T objetivo = cabeza->datos[0];
+        T segundo = cabeza->datos[0];   // Mejor extremo entre los demás bloques
+        T opuesto = cabeza->datos[0];
+        bool haySegundo = false;
+        
+        for (Nodo* actual = cabeza; actual != nullptr; prev = actual, actual = actual->siguiente) {
+            T bmin = actual->datos[0];
+            T bmax = actual->datos[0];
+            extremosLecturas(actual->datos, actual->cantidad, bmin, bmax);
+            T extremo = maximo ? bmax : bmin;
+            T contrario = maximo ? bmin : bmax;
+            if (actual == cabeza) {
+                objetivo = extremo;
+                opuesto = contrario;
+                continue;
+            }
+            if (precede(opuesto, contrario, maximo)) opuesto = contrario;
+            if (precede(extremo, objetivo, maximo)) {
+                segundo = objetivo;
+                haySegundo = true;
+                objetivo = extremo;
+                nodoObj = actual;
+                prevObj = prev;
+            } else if (!haySegundo || precede(extremo, segundo, maximo)) {
+                segundo = extremo;
+                haySegundo = true;
+            }
+        }
+        
+        int posObj = (int)buscarLectura(nodoObj->datos, (long)nodoObj->cantidad, objetivo);
+        for (int i = 0; i < nodoObj->cantidad; i++) {
+            if (i != posObj && (!haySegundo || precede(nodoObj->datos[i], segundo, maximo))) {
+                segundo = nodoObj->datos[i];
+                haySegundo = true;
+            }
+        }
+        
+        T valor = nodoObj->datos[posObj];
+        
+        // Compactar el bloque sobre la posición eliminada
+        for (int i = posObj + 1; i < nodoObj->cantidad; i++) {
+            nodoObj->datos[i - 1] = nodoObj->datos[i];
+            nodoObj->desfase[i - 1] = nodoObj->desfase[i];
+        }
+        nodoObj->cantidad--;
+        
+        // Eliminar el nodo si quedó vacío
+        if (nodoObj->cantidad == 0) {
+            if (prevObj == nullptr) {
+                cabeza = cabeza->siguiente;
+            } else {
+                prevObj->siguiente = nodoObj->siguiente;
+            }
+            if (cola == nodoObj) {
+                cola = prevObj;
+            }
+            arena.destruir(nodoObj);
+            numNodos--;
+            tiempoAlDia = false;
+        }
+        
+        tamanio--;
+        acumulador.quitar(valor);
+        if (tamanio > 0) {
+            if (maximo) {
+                acumulador.establecerExtremos(opuesto, segundo);
+            } else {
+                acumulador.establecerExtremos(segundo, opuesto);
+            }
+        }
+        return valor;
+    }
+    
+    /**
+     * @brief Extrae el mínimo o el máximo usando el índice, O(log n + N)
+     * @param maximo true para extraer el máximo
+     * @return Valor extraído
+     * 
+     * El nodo que queda vacío no se desenlaza (la lista es simple y no se
+     * conoce su anterior); se purgan en lote cuando superan la mitad.
+     */
+    T extraerIndexado(bool maximo) {
+        typename IndiceOrden<T>::Entrada e = maximo ? indice->maximo() : indice->minimo();
+        indice->eliminar(e.valor, e.ref);
+        
+        Nodo* nodo = static_cast<Nodo*>(const_cast<void*>(e.ref));
+        int pos = 0;
+        while (pos < nodo->cantidad - 1 && (nodo->datos[pos] < e.valor || e.valor < nodo->datos[pos])) {
+            pos++;
+        }
+        for (int i = pos + 1; i < nodo->cantidad; i++) {
+            nodo->datos[i - 1] = nodo->datos[i];
+            nodo->desfase[i - 1] = nodo->desfase[i];
+        }
+        nodo->cantidad--;
+        if (nodo->cantidad == 0) {
+            nodosVacios++;
+        }
+        
+        tamanio--;
+        acumulador.quitar(e.valor);
+        if (tamanio > 0) {
+            acumulador.establecerExtremos(indice->minimo().valor, indice->maximo().valor);
+        }
+        if (nodosVacios * 2 > numNodos) {
+            purgarVacios();
+        }
+        return e.valor;
+    }
+    
+    /**
+     * @brief Desenlaza y devuelve a la arena los nodos sin lecturas, O(nodos)
+     */
+    void purgarVacios() {
+        if (nodosVacios == 0) return;
+        Nodo* prev = nullptr;
+        Nodo* actual = cabeza;
+        while (actual != nullptr) {
+            Nodo* sig = actual->siguiente;
+            if (actual->cantidad == 0) {
+                if (prev == nullptr) {
+                    cabeza = sig;
+                } else {
+                    prev->siguiente = sig;
+                }
+                arena.destruir(actual);
+                numNodos--;
+            } else {
+                prev = actual;
+            }
+            actual = sig;
         }
+        cola = prev;
+        nodosVacios = 0;
+        tiempoAlDia = false;
     }
     
     /**
-     * @brief Copia los elementos de otra lista
+     * @brief Recorre la lista para restaurar mínimo y máximo si quedaron invalidados
+     */
+    void recalcularExtremos() const {
+        if (acumulador.extremosAlDia() || tamanio == 0) return;
+        if (indice != nullptr) {
+            acumulador.establecerExtremos(indice->minimo().valor, indice->maximo().valor);
+            return;
+        }
+        T min = cabeza->datos[0];
+        T max = cabeza->datos[0];
+        for (Nodo* actual = cabeza; actual != nullptr; actual = actual->siguiente) {
+            extremosLecturas(actual->datos, actual->cantidad, min, max);
+        }
+        acumulador.establecerExtremos(min, max);
+    }
+    
+    /**
+     * @brief Copia los elementos de otra lista (esta debe estar vacía)
      * @param otra Lista a copiar
+     * 
+     * Duplica bloque por bloque manteniendo la cola, sin pasar por
+     * insertar(): O(n) más O(n log n) si hay que indexar la copia. Los
+     * agregados se copian tal cual y los nodos vacíos de la otra se omiten.
      */
     void copiar(const ListaSensor& otra) {
-        Nodo* actual = otra.cabeza;
-        while (actual != nullptr) {
-            insertar(actual->dato);
-            actual = actual->siguiente;
+        maxLecturas = otra.maxLecturas;
+        maxMs = otra.maxMs;
+        for (Nodo* actual = otra.cabeza; actual != nullptr; actual = actual->siguiente) {
+            if (actual->cantidad == 0) continue;
+            Nodo* nuevo = arena.crear(actual->datos[0], actual->base);
+            std::copy(actual->datos + 1, actual->datos + actual->cantidad, nuevo->datos + 1);
+            std::copy(actual->desfase, actual->desfase + actual->cantidad, nuevo->desfase);
+            nuevo->cantidad = actual->cantidad;
+            nuevo->marca = actual->marca;
+            if (cabeza == nullptr) {
+                cabeza = nuevo;
+            } else {
+                cola->siguiente = nuevo;
+            }
+            cola = nuevo;
+            numNodos++;
+            anotarBloque(nuevo);
+        }
+        tamanio = otra.tamanio;
+        acumulador = otra.acumulador;
+        ultimaMarca = otra.ultimaMarca;
+        if (otra.indice != nullptr) {
+            if (indice == nullptr) {
+                indice = new IndiceOrden<T>();
+            }
+            indexarTodo();
         }
     }
 };
 
-#endif // LISTASENSOR_H
\ No newline at end of file
+#endif // LISTASENSOR_H
@@ -0,0 +1,363 @@
+/**
+ * @file Metricas.h
+ * @brief Contadores sin bloqueo e histogramas de latencia por sensor
+ * @author Eliezer Mores Oyervides
+ * @date 2025
+ *
+ * Cada SensorBase lleva un MetricasSensor: lecturas aceptadas, fallos de
+ * análisis, lecturas por segundo, bytes del historial y dos histogramas
+ * (latencia de ingesta y duración de procesar()). Todos los campos son
+ * atómicos: el hilo que alimenta al sensor escribe y cualquier otro hilo
+ * (ExportadorMetricas.h) puede leer sin detenerlo.
+ *
+ * La latencia de ingesta se mide desde que la capa de entrada recibió los
+ * bytes (MarcaRecepcion) hasta que la lectura quedó en el historial. Si la
+ * lectura no llegó por un puerto, se mide desde que el sensor la recibió y
+ * solo en una de cada MUESTREO_LATENCIA lecturas: leer el reloj cuesta más
+ * que insertar en la lista.
+ */
+
+#ifndef METRICAS_H
+#define METRICAS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <time.h>
+
+/**
+ * @brief Nanosegundos de un reloj monótono
+ */
+inline long long relojNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Nanosegundos del reloj monótono de baja resolución (~4 ms, mucho más barato)
+ */
+inline long long relojGruesoNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * @brief Origen de los milisegundos con que se fechan las lecturas (unos 35 años de CLOCK_MONOTONIC)
+ *
+ * CLOCK_MONOTONIC empieza en cero al arrancar el equipo. Con este origen,
+ * las lecturas recuperadas de un segmento que se tomaron antes del último
+ * arranque conservan marcas positivas (0 significa "sin marca").
+ */
+const long long ORIGEN_HISTORIAL_MS = 1LL << 40;
+
+/**
+ * @brief Milisegundos de los historiales que corresponden a un instante de relojNs() o relojGruesoNs()
+ */
+inline long long msHistorial(long long ns) {
+    return ns / 1000000 + ORIGEN_HISTORIAL_MS;
+}
+
+/**
+ * @class HistogramaLatencia
+ * @brief Histograma log-lineal estilo HDR de duraciones en nanosegundos
+ *
+ * Cada potencia de dos se divide en SUBCUBETAS cubetas lineales, así el
+ * error relativo de cualquier percentil es menor a 1/SUBCUBETAS (6.25%)
+ * desde 1 ns hasta ~18 minutos. Las cubetas se reservan con el primer
+ * registro, para que los sensores sin actividad no ocupen memoria.
+ */
+class HistogramaLatencia {
+public:
+    static const int BITS_SUBCUBETA = 4;
+    static const int SUBCUBETAS = 1 << BITS_SUBCUBETA;
+    static const int MAGNITUD_MAXIMA = 40;   ///< Valores hasta 2^40 ns
+    static const int CUBETAS = (MAGNITUD_MAXIMA - BITS_SUBCUBETA + 1) * SUBCUBETAS;
+
+private:
+    std::atomic<std::atomic<uint64_t>*> cubetas;  ///< nullptr hasta el primer registro
+    std::atomic<uint64_t> cantidad;
+    std::atomic<uint64_t> suma;
+    std::atomic<uint64_t> maximo;
+
+    /**
+     * @brief Cubeta de un valor
+     */
+    static int cubetaDe(uint64_t v) {
+        if (v < (uint64_t)SUBCUBETAS) return (int)v;
+        int magnitud = 63 - __builtin_clzll(v);
+        if (magnitud >= MAGNITUD_MAXIMA) return CUBETAS - 1;
+        int sub = (int)((v >> (magnitud - BITS_SUBCUBETA)) & (SUBCUBETAS - 1));
+        return (magnitud - BITS_SUBCUBETA + 1) * SUBCUBETAS + sub;
+    }
+
+    /**
+     * @brief Valor representativo (punto medio) de una cubeta
+     */
+    static uint64_t valorDe(int cubeta) {
+        if (cubeta < SUBCUBETAS) return (uint64_t)cubeta;
+        int magnitud = cubeta / SUBCUBETAS + BITS_SUBCUBETA - 1;
+        int sub = cubeta % SUBCUBETAS;
+        uint64_t ancho = 1ull << (magnitud - BITS_SUBCUBETA);
+        return (1ull << magnitud) + (uint64_t)sub * ancho + ancho / 2;
+    }
+
+    /**
+     * @brief Reserva las cubetas (una sola vez aunque compitan varios hilos)
+     */
+    std::atomic<uint64_t>* reservar() {
+        std::atomic<uint64_t>* nuevas = new std::atomic<uint64_t>[CUBETAS];
+        for (int i = 0; i < CUBETAS; i++) {
+            nuevas[i].store(0, std::memory_order_relaxed);
+        }
+        std::atomic<uint64_t>* esperado = nullptr;
+        if (!cubetas.compare_exchange_strong(esperado, nuevas, std::memory_order_acq_rel)) {
+            delete[] nuevas;
+            return esperado;
+        }
+        return nuevas;
+    }
+
+public:
+    HistogramaLatencia() : cubetas(nullptr), cantidad(0), suma(0), maximo(0) {}
+
+    ~HistogramaLatencia() {
+        delete[] cubetas.load();
+    }
+
+    HistogramaLatencia(const HistogramaLatencia&) = delete;
+    HistogramaLatencia& operator=(const HistogramaLatencia&) = delete;
+
+    /**
+     * @brief Registra una duración
+     * @param ns Nanosegundos (los negativos cuentan como 0)
+     */
+    void registrar(long long ns) {
+        uint64_t v = ns > 0 ? (uint64_t)ns : 0;
+        std::atomic<uint64_t>* c = cubetas.load(std::memory_order_acquire);
+        if (c == nullptr) c = reservar();
+        c[cubetaDe(v)].fetch_add(1, std::memory_order_relaxed);
+        cantidad.fetch_add(1, std::memory_order_relaxed);
+        suma.fetch_add(v, std::memory_order_relaxed);
+        uint64_t previo = maximo.load(std::memory_order_relaxed);
+        while (v > previo && !maximo.compare_exchange_weak(previo, v, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * @brief Percentil aproximado
+     * @param p Percentil en [0, 100]
+     * @return Nanosegundos (0 si no hay registros)
+     */
+    uint64_t percentil(double p) const {
+        std::atomic<uint64_t>* c = cubetas.load(std::memory_order_acquire);
+        uint64_t total = cantidad.load(std::memory_order_relaxed);
+        if (c == nullptr || total == 0) return 0;
+        uint64_t objetivo = (uint64_t)(p / 100.0 * (double)total);
+        if (objetivo >= total) objetivo = total - 1;
+        uint64_t acumulado = 0;
+        for (int i = 0; i < CUBETAS; i++) {
+            acumulado += c[i].load(std::memory_order_relaxed);
+            if (acumulado > objetivo) {
+                uint64_t v = valorDe(i);
+                uint64_t max = maximo.load(std::memory_order_relaxed);
+                return v < max ? v : max;
+            }
+        }
+        return maximo.load(std::memory_order_relaxed);
+    }
+
+    uint64_t getCantidad() const {
+        return cantidad.load(std::memory_order_relaxed);
+    }
+
+    uint64_t getSuma() const {
+        return suma.load(std::memory_order_relaxed);
+    }
+
+    uint64_t getMaximo() const {
+        return maximo.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Promedio en nanosegundos
+     */
+    double promedio() const {
+        uint64_t n = getCantidad();
+        return n == 0 ? 0.0 : (double)getSuma() / (double)n;
+    }
+};
+
+/**
+ * @class CronometroLatencia
+ * @brief Registra en un histograma el tiempo de vida del objeto (RAII)
+ */
+class CronometroLatencia {
+private:
+    HistogramaLatencia& destino;
+    long long inicio;
+
+public:
+    CronometroLatencia(HistogramaLatencia& h) : destino(h), inicio(relojNs()) {}
+
+    ~CronometroLatencia() {
+        destino.registrar(relojNs() - inicio);
+    }
+};
+
+/**
+ * @class MarcaRecepcion
+ * @brief Instante en que la capa de entrada recibió los datos que se están despachando
+ *
+ * Es por hilo: MotorIngesta (o quien lea un puerto) la fija mientras
+ * entrega las líneas de una lectura y los sensores la usan como origen de
+ * la latencia de ingesta. Al destruirse restaura el valor anterior.
+ */
+class MarcaRecepcion {
+private:
+    long long anterior;
+
+    static long long& actualRef() {
+        static thread_local long long marca = 0;
+        return marca;
+    }
+
+public:
+    /**
+     * @param ns Instante de recepción (relojNs())
+     */
+    MarcaRecepcion(long long ns) : anterior(actualRef()) {
+        actualRef() = ns;
+    }
+
+    ~MarcaRecepcion() {
+        actualRef() = anterior;
+    }
+
+    MarcaRecepcion(const MarcaRecepcion&) = delete;
+    MarcaRecepcion& operator=(const MarcaRecepcion&) = delete;
+
+    /**
+     * @brief Marca vigente en este hilo (0 = ninguna)
+     */
+    static long long actual() {
+        return actualRef();
+    }
+};
+
+/**
+ * @brief Milisegundos monótonos con que se fecha una lectura que llega sin marca propia
+ *
+ * Es el instante de recepción si la capa de entrada fijó una MarcaRecepcion
+ * y, si no, el reloj grueso: fechar cada lectura con relojNs() costaría más
+ * que insertarla.
+ */
+inline long long instanteIngestaMs() {
+    long long recepcion = MarcaRecepcion::actual();
+    return msHistorial(recepcion > 0 ? recepcion : relojGruesoNs());
+}
+
+/**
+ * @class MetricasSensor
+ * @brief Métricas de un sensor, legibles desde cualquier hilo
+ */
+class MetricasSensor {
+private:
+    std::atomic<uint64_t> lecturas;         ///< Lecturas aceptadas
+    std::atomic<uint64_t> fallosAnalisis;   ///< Valores de texto no numéricos
+    std::atomic<long long> bytesHistorial;  ///< Memoria del historial tras la última operación
+    std::atomic<long long> segundoActual;   ///< Segundo (reloj monótono) que se está contando
+    std::atomic<uint64_t> enSegundoActual;  ///< Lecturas en ese segundo
+    std::atomic<uint64_t> enSegundoAnterior; ///< Lecturas del segundo inmediatamente anterior
+    long long creado;                       ///< relojNs() al crear el sensor
+
+public:
+    static const uint64_t MUESTREO_LATENCIA = 64;  ///< Sin MarcaRecepcion, 1 de cada 64 lecturas
+
+    HistogramaLatencia latenciaIngesta;     ///< Recepción -> lectura almacenada
+    HistogramaLatencia duracionProceso;     ///< Duración de procesar()
+
+    MetricasSensor() : lecturas(0), fallosAnalisis(0), bytesHistorial(0), segundoActual(0),
+                       enSegundoActual(0), enSegundoAnterior(0), creado(relojNs()) {}
+
+    /**
+     * @brief Instante de llegada de una lectura al sensor, si esta lectura se mide
+     * @return relojNs() o 0 si hay MarcaRecepcion o la lectura no se muestrea
+     */
+    long long inicioMuestra() const {
+        if (MarcaRecepcion::actual() > 0) return 0;
+        if (lecturas.load(std::memory_order_relaxed) % MUESTREO_LATENCIA != 0) return 0;
+        return relojNs();
+    }
+
+    /**
+     * @brief Registra una lectura ya almacenada
+     * @param inicio Valor devuelto por inicioMuestra() antes de almacenarla
+     */
+    void registrarLectura(long long inicio) {
+        long long recepcion = MarcaRecepcion::actual();
+        if (recepcion > 0 || inicio > 0) {
+            latenciaIngesta.registrar(relojNs() - (recepcion > 0 ? recepcion : inicio));
+        }
+        // Un solo hilo alimenta al sensor: cargar y guardar basta (sin
+        // instrucciones con bloqueo) y los lectores ven valores completos
+        lecturas.store(lecturas.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+        long long segundo = relojGruesoNs() / 1000000000LL;
+        long long vigente = segundoActual.load(std::memory_order_relaxed);
+        uint64_t enSegundo = enSegundoActual.load(std::memory_order_relaxed);
+        if (segundo != vigente) {
+            enSegundoAnterior.store(segundo == vigente + 1 ? enSegundo : 0, std::memory_order_relaxed);
+            enSegundo = 0;
+            segundoActual.store(segundo, std::memory_order_relaxed);
+        }
+        enSegundoActual.store(enSegundo + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Cuenta un valor de texto que no se pudo interpretar
+     */
+    void registrarFalloAnalisis() {
+        fallosAnalisis.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Actualiza la memoria ocupada por el historial
+     */
+    void establecerBytesHistorial(long long bytes) {
+        bytesHistorial.store(bytes, std::memory_order_relaxed);
+    }
+
+    uint64_t getLecturas() const {
+        return lecturas.load(std::memory_order_relaxed);
+    }
+
+    uint64_t getFallosAnalisis() const {
+        return fallosAnalisis.load(std::memory_order_relaxed);
+    }
+
+    long long getBytesHistorial() const {
+        return bytesHistorial.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Lecturas del último segundo completo (0 si el sensor estuvo inactivo)
+     */
+    uint64_t lecturasPorSegundo() const {
+        long long segundo = relojGruesoNs() / 1000000000LL;
+        long long vigente = segundoActual.load(std::memory_order_relaxed);
+        if (vigente == segundo) return enSegundoAnterior.load(std::memory_order_relaxed);
+        if (vigente == segundo - 1) return enSegundoActual.load(std::memory_order_relaxed);
+        return 0;
+    }
+
+    /**
+     * @brief Lecturas por segundo promediadas desde la creación del sensor
+     */
+    double lecturasPorSegundoPromedio() const {
+        double segundos = (double)(relojNs() - creado) / 1e9;
+        return segundos > 0.0 ? (double)getLecturas() / segundos : 0.0;
+    }
+};
+
+#endif // METRICAS_H
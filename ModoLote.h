@@ -0,0 +1,303 @@
+/**
+ * @file ModoLote.h
+ * @brief Ejecución sin menú: manifiesto de sensores, flujo de entrada y resultados CSV/JSON
+ * @author Eliezer Mores Oyervides
+ * @date 2025
+ *
+ * El manifiesto tiene un sensor por línea; '#' inicia un comentario:
+ * @code
+ * # nombre  tipo         [retención: lecturas [segundos]]  [resumenes]
+ * T-001     temperatura  1000
+ * P-105     presion      0 0  resumenes
+ * @endcode
+ * El tipo puede escribirse también como 'f' o 'i'. La palabra "resumenes"
+ * al final activa los resúmenes por segundo, minuto, hora y día del sensor
+ * (SensorBase::activarResumenes()). La entrada (archivo,
+ * stdin o dispositivo serial) trae líneas "ID:valor" y/o tramas binarias,
+ * igual que el Arduino en el modo interactivo.
+ */
+
+#ifndef MODOLOTE_H
+#define MODOLOTE_H
+
+#include "ListaGestion.h"
+#include "SensorTemperatura.h"
+#include "SensorPresion.h"
+#include "SerialPort.h"
+#include "ProtocoloBinario.h"
+#include "EnrutadorLineas.h"
+#include "Metricas.h"
+#include "Registro.h"
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <charconv>
+#include <chrono>
+
+/**
+ * @enum FormatoLote
+ * @brief Formato de los resultados de cada ronda de procesamiento
+ */
+enum FormatoLote {
+    LOTE_CSV,   ///< ronda,sensor,tipo,lecturas,minimo_eliminado,promedio
+    LOTE_JSON   ///< Un objeto JSON por línea (JSON Lines)
+};
+
+/**
+ * @class ModoLote
+ * @brief Lleva un flujo de lecturas a los sensores y escribe los resultados en un FILE*
+ *
+ * Lee la entrada con un SerialPort sobre cualquier descriptor: con un
+ * archivo normal el búfer de 64 KiB se llena de una sola llamada a read()
+ * y cada línea se despacha por EnrutadorLineas sin copias adicionales.
+ * procesar() se ejecuta cada intervalo (medido solo al rellenar el búfer,
+ * para no consultar el reloj por línea) y siempre al terminar la entrada.
+ */
+class ModoLote {
+private:
+    static const int ESPERA_MS = 200;  ///< Espera de datos en dispositivos sin salida
+
+    ListaGestion& gestor;              ///< Sensores del manifiesto
+    EnrutadorLineas enrutador;         ///< Líneas "ID:valor"
+    DecodificadorTramas decodificador; ///< Tramas binarias y separación de líneas
+    FILE* salida;                      ///< Destino de los resultados
+    FormatoLote formato;               ///< CSV o JSON Lines
+    long long intervaloNs;             ///< Periodo entre rondas (0 = solo al final)
+    long rondas;                       ///< Rondas emitidas
+    long sinEtiqueta;                  ///< Líneas sin "ID:"
+    double segundos;                   ///< Duración de la ingesta
+
+    /**
+     * @brief Escribe un nombre como cadena JSON
+     */
+    void escribirCadenaJson(const char* texto) {
+        fputc('"', salida);
+        for (const char* p = texto; *p != '\0'; p++) {
+            if (*p == '"' || *p == '\\') fputc('\\', salida);
+            fputc(*p, salida);
+        }
+        fputc('"', salida);
+    }
+
+    /**
+     * @brief Escribe el resultado de un sensor en la ronda actual
+     */
+    void emitir(const SensorBase* sensor, const ResultadoProceso& r) {
+        if (formato == LOTE_CSV) {
+            fprintf(salida, "%ld,%s,%c,%d,", rondas, sensor->getNombre(), sensor->getTipo(), r.lecturas);
+            if (r.eliminoMinimo) fprintf(salida, "%.9g", r.minimo);
+            fprintf(salida, ",%.9g\n", r.promedio);
+            return;
+        }
+        fprintf(salida, "{\"ronda\":%ld,\"sensor\":", rondas);
+        escribirCadenaJson(sensor->getNombre());
+        fprintf(salida, ",\"tipo\":\"%c\",\"lecturas\":%d,\"minimo_eliminado\":", sensor->getTipo(), r.lecturas);
+        if (r.eliminoMinimo) {
+            fprintf(salida, "%.9g", r.minimo);
+        } else {
+            fputs("null", salida);
+        }
+        fprintf(salida, ",\"promedio\":%.9g}\n", r.promedio);
+    }
+
+    /**
+     * @brief Crea un sensor a partir de una línea del manifiesto
+     * @return false si la línea no es válida
+     */
+    bool crearSensor(char* linea, const char* ruta, int numero) {
+        char* nombre = strtok(linea, " \t\r");
+        char* tipo = strtok(nullptr, " \t\r");
+        char* lecturas = strtok(nullptr, " \t\r");
+        char* segs = strtok(nullptr, " \t\r");
+        char* opcion = strtok(nullptr, " \t\r");
+        // "resumenes" puede ocupar el lugar de cualquiera de los campos opcionales
+        bool resumenes = false;
+        char** ultimo = opcion != nullptr ? &opcion : segs != nullptr ? &segs : lecturas != nullptr ? &lecturas : nullptr;
+        if (ultimo != nullptr && strcmp(*ultimo, "resumenes") == 0) {
+            resumenes = true;
+            *ultimo = nullptr;
+        }
+        if (opcion != nullptr || strtok(nullptr, " \t\r") != nullptr) {
+            REGISTRO_ERROR(ruta << ":" << numero << ": campos de más (se esperaba \"nombre tipo [lecturas [segundos]] [resumenes]\")");
+            return false;
+        }
+        if (tipo == nullptr || strpbrk(nombre, ":,\"\\") != nullptr || strlen(nombre) > 49) {
+            REGISTRO_ERROR(ruta << ":" << numero << ": se esperaba \"nombre tipo\" (nombre sin ':', ',' ni comillas, hasta 49 caracteres)");
+            return false;
+        }
+        if (gestor.internar(nombre) >= 0) {
+            REGISTRO_ERROR(ruta << ":" << numero << ": sensor '" << nombre << "' repetido");
+            return false;
+        }
+        int maxLecturas = 0;
+        double maxSegundos = 0.0;
+        if (lecturas != nullptr) {
+            const char* fin = lecturas + strlen(lecturas);
+            std::from_chars_result r = std::from_chars(lecturas, fin, maxLecturas);
+            if (r.ec != std::errc() || r.ptr != fin || maxLecturas < 0) {
+                REGISTRO_ERROR(ruta << ":" << numero << ": lecturas '" << lecturas << "' inválidas (entero de 0 a 2147483647)");
+                return false;
+            }
+        }
+        if (segs != nullptr) {
+            const char* fin = segs + strlen(segs);
+            std::from_chars_result r = std::from_chars(segs, fin, maxSegundos);
+            if (r.ec != std::errc() || r.ptr != fin || !std::isfinite(maxSegundos) || maxSegundos < 0.0) {
+                REGISTRO_ERROR(ruta << ":" << numero << ": segundos '" << segs << "' inválidos (número no negativo)");
+                return false;
+            }
+        }
+        SensorBase* sensor;
+        if (strcmp(tipo, "temperatura") == 0 || strcmp(tipo, "f") == 0) {
+            sensor = new SensorTemperatura(nombre);
+        } else if (strcmp(tipo, "presion") == 0 || strcmp(tipo, "i") == 0) {
+            sensor = new SensorPresion(nombre);
+        } else {
+            REGISTRO_ERROR(ruta << ":" << numero << ": tipo '" << tipo << "' desconocido (temperatura|presion|f|i)");
+            return false;
+        }
+        if (lecturas != nullptr) {
+            sensor->establecerRetencion(maxLecturas, maxSegundos);
+        }
+        if (resumenes) {
+            sensor->activarResumenes();
+        }
+        gestor.insertar(sensor);
+        return true;
+    }
+
+    /**
+     * @brief Entrega una línea de texto (las vacías se ignoran)
+     */
+    void entregarLinea(char* linea) {
+        if (linea[0] == '\0') return;
+        if (enrutador.enrutar(linea) == RUTA_SIN_ETIQUETA) {
+            sinEtiqueta++;
+        }
+    }
+
+public:
+    /**
+     * @brief Constructor
+     * @param g Lista de gestión que recibe los sensores del manifiesto
+     * @param destino Archivo de resultados (no se cierra)
+     * @param f Formato de los resultados
+     * @param intervalo Segundos entre rondas de procesamiento (0 = solo al final)
+     */
+    ModoLote(ListaGestion& g, FILE* destino, FormatoLote f, double intervalo)
+        : gestor(g), enrutador(g), salida(destino), formato(f),
+          intervaloNs(intervalo > 0.0 ? (long long)(intervalo * 1e9) : 0),
+          rondas(0), sinEtiqueta(0), segundos(0.0) {}
+
+    /**
+     * @brief Crea los sensores descritos en un manifiesto
+     * @param ruta Archivo de manifiesto
+     * @return Sensores creados, o -1 si el archivo no se pudo leer o tiene errores
+     */
+    int cargarManifiesto(const char* ruta) {
+        FILE* f = fopen(ruta, "r");
+        if (f == nullptr) {
+            REGISTRO_ERROR("No se pudo abrir el manifiesto " << ruta);
+            return -1;
+        }
+        char linea[256];
+        int numero = 0;
+        int creados = 0;
+        bool valido = true;
+        while (fgets(linea, sizeof(linea), f) != nullptr) {
+            numero++;
+            char* comentario = strchr(linea, '#');
+            if (comentario != nullptr) *comentario = '\0';
+            linea[strcspn(linea, "\n")] = '\0';
+            if (linea[strspn(linea, " \t\r")] == '\0') continue;
+            if (crearSensor(linea, ruta, numero)) {
+                creados++;
+            } else {
+                valido = false;
+            }
+        }
+        fclose(f);
+        return valido ? creados : -1;
+    }
+
+    /**
+     * @brief Escribe la cabecera de resultados (solo CSV)
+     */
+    void iniciarSalida() {
+        if (formato == LOTE_CSV) {
+            fputs("ronda,sensor,tipo,lecturas,minimo_eliminado,promedio\n", salida);
+        }
+    }
+
+    /**
+     * @brief Procesa todos los sensores y escribe una fila por sensor
+     */
+    void procesarRonda() {
+        rondas++;
+        for (int i = 0; i < gestor.getTamanio(); i++) {
+            SensorBase* sensor = gestor.obtener(i);
+            emitir(sensor, sensor->procesar());
+        }
+        fflush(salida);
+    }
+
+    /**
+     * @brief Lleva a los sensores todo lo que llegue por la entrada
+     * @param entrada Puerto sobre el archivo, stdin o dispositivo
+     * @param limite Máximo de unidades (líneas y tramas) a atender (-1 = hasta el fin de la entrada)
+     * @return Unidades atendidas
+     *
+     * Termina al llegar al fin del archivo, al desconectarse el dispositivo
+     * o al alcanzar el límite; después ejecuta una última ronda.
+     */
+    long ingerir(SerialPort& entrada, long limite) {
+        entrada.establecerTimeout(ESPERA_MS);
+        auto inicio = std::chrono::steady_clock::now();
+        long long proximo = intervaloNs > 0 ? relojNs() + intervaloNs : 0;
+        char linea[256];
+        long unidades = 0;
+        while (limite < 0 || unidades < limite) {
+            UnidadRecibida u = decodificador.extraer(entrada, linea, sizeof(linea));
+            if (u == LINEA_TEXTO) {
+                entregarLinea(linea);
+                unidades++;
+                continue;
+            }
+            if (u == TRAMA_BINARIA) {
+                decodificador.entregarTrama(reinterpret_cast<const unsigned char*>(linea), gestor);
+                unidades++;
+                continue;
+            }
+            // Búfer sin unidades completas: momento de mirar el reloj y rellenar
+            if (proximo > 0 && relojNs() >= proximo) {
+                procesarRonda();
+                proximo = relojNs() + intervaloNs;
+            }
+            if (!entrada.estaConectado()) break;
+            if (entrada.llenarBuffer() == 0 && entrada.estaConectado()) {
+                entrada.esperarDatos();
+            }
+        }
+        segundos += std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+        procesarRonda();
+        return unidades;
+    }
+
+    /**
+     * @brief Escribe contadores y velocidad de la ingesta
+     * @param f Destino (normalmente stderr, para no mezclarlo con los resultados)
+     */
+    void imprimirResumen(FILE* f) const {
+        long unidades = decodificador.getLineas() + decodificador.getTramas();
+        fprintf(f, "unidades=%ld lineas=%ld tramas=%ld entregadas=%ld id_desconocido=%ld invalidas=%ld "
+                   "sin_etiqueta=%ld errores_crc=%ld rondas=%ld segundos=%.3f unidades_por_s=%.0f\n",
+                unidades, decodificador.getLineas(), decodificador.getTramas(),
+                enrutador.getEntregadas() + decodificador.getTramas() - decodificador.getSinDestino(),
+                enrutador.getDesconocidas(), enrutador.getInvalidas(), sinEtiqueta,
+                decodificador.getErroresCrc(), rondas, segundos,
+                segundos > 0.0 ? unidades / segundos : 0.0);
+    }
+};
+
+#endif // MODOLOTE_H
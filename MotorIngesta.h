@@ -0,0 +1,272 @@
+/**
+ * @file MotorIngesta.h
+ * @brief Motor de ingesta que atiende muchos puertos seriales con un solo bucle epoll
+ * @author Eliezer Mores Oyervides
+ * @date 2025
+ */
+
+#ifndef MOTORINGESTA_H
+#define MOTORINGESTA_H
+
+#include "SerialPort.h"
+#include "ListaGestion.h"
+#include "ProtocoloBinario.h"
+#include "EnrutadorLineas.h"
+#include <iostream>
+#include <chrono>
+#include <sys/epoll.h>
+
+/**
+ * @class MotorIngesta
+ * @brief Demultiplexa las líneas de N puertos hacia los sensores de una ListaGestion
+ *
+ * Cada punto de conexión (puerto serial o pseudo-terminal) se asocia con el
+ * handle de un sensor de la lista de gestión. Todos los descriptores se
+ * registran en una única instancia de epoll: cuando uno tiene datos se vacía
+ * su búfer circular y cada línea completa se entrega con agregarLectura() al
+ * sensor asociado. No se crea ningún hilo por puerto.
+ *
+ * Cada punto acepta además tramas binarias (ProtocoloBinario.h), que van al
+ * sensor indicado por el handle de la trama sin pasar por texto, y líneas
+ * etiquetadas "ID:valor" (EnrutadorLineas.h), que van al sensor de ese ID.
+ * Solo las líneas sin etiqueta usan el sensor asociado al punto. Cada punto
+ * traduce las marcas "@ms" con su propio RelojDispositivo, pues cada
+ * dispositivo tiene su desfase y se reinicia por su cuenta.
+ */
+class MotorIngesta {
+private:
+    /**
+     * @struct Punto
+     * @brief Punto de conexión registrado en el motor
+     */
+    struct Punto {
+        SerialPort* puerto;   ///< Puerto propio del motor
+        int handle;           ///< Handle del sensor destino en la ListaGestion
+        long lineas;          ///< Lecturas entregadas (líneas de texto y tramas)
+        long descartadas;     ///< Líneas sin sensor destino o con ID desconocido
+        DecodificadorTramas decodificador; ///< Separador de tramas y líneas del punto
+        RelojDispositivo reloj; ///< Marcas "@ms" del dispositivo de este punto
+        bool activo;          ///< false cuando el otro extremo se cerró
+    };
+
+    ListaGestion& gestor;     ///< Lista de sensores destino
+    EnrutadorLineas enrutador; ///< Despacho de líneas etiquetadas
+    int epfd;                 ///< Descriptor de epoll
+    Punto* puntos;            ///< Arreglo de puntos de conexión
+    int numPuntos;            ///< Puntos registrados
+    int capacidad;            ///< Capacidad del arreglo puntos
+    int activos;              ///< Puntos aún conectados
+    double segundos;          ///< Tiempo acumulado dentro de ejecutar()
+
+    /**
+     * @brief Registra un puerto ya abierto y lo agrega a epoll
+     * @return Índice del punto o -1 si el puerto no está conectado
+     */
+    int registrar(SerialPort* puerto, int handle) {
+        if (!puerto->estaConectado()) {
+            delete puerto;
+            return -1;
+        }
+        if (numPuntos == capacidad) {
+            int nuevaCapacidad = capacidad == 0 ? 8 : capacidad * 2;
+            Punto* ampliado = new Punto[nuevaCapacidad];
+            for (int i = 0; i < numPuntos; i++) {
+                ampliado[i] = puntos[i];
+            }
+            delete[] puntos;
+            puntos = ampliado;
+            capacidad = nuevaCapacidad;
+        }
+        Punto& p = puntos[numPuntos];
+        p.puerto = puerto;
+        p.handle = handle;
+        p.lineas = 0;
+        p.descartadas = 0;
+        p.decodificador = DecodificadorTramas();
+        p.reloj = RelojDispositivo();
+        p.activo = true;
+
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.u32 = (uint32_t)numPuntos;
+        epoll_ctl(epfd, EPOLL_CTL_ADD, puerto->descriptor(), &ev);
+        activos++;
+        return numPuntos++;
+    }
+
+    /**
+     * @brief Vacía el búfer de un punto y entrega sus líneas completas
+     * @param p Punto con datos disponibles
+     * @return Líneas entregadas
+     */
+    long atender(Punto& p) {
+        char linea[100];
+        long entregadas = 0;
+        SensorBase* sensor = gestor.obtener(p.handle);
+        // Las lecturas de este lote miden su latencia desde la llegada de los bytes
+        MarcaRecepcion recepcion(relojNs());
+        p.puerto->llenarBuffer();
+        UnidadRecibida unidad;
+        while ((unidad = p.decodificador.siguiente(*p.puerto, gestor, linea, sizeof(linea))) != SIN_DATOS) {
+            if (unidad == TRAMA_BINARIA) {
+                p.lineas++;
+                entregadas++;
+                continue;
+            }
+            ResultadoRuta ruta = enrutador.enrutar(linea, p.reloj);
+            if (ruta == RUTA_ENTREGADA) {
+                p.lineas++;
+                entregadas++;
+            } else if (ruta != RUTA_SIN_ETIQUETA) {
+                p.descartadas++;
+            } else if (sensor != nullptr) {
+                sensor->agregarLectura(linea);
+                p.lineas++;
+                entregadas++;
+            } else {
+                p.descartadas++;
+            }
+        }
+
+        if (!p.puerto->estaConectado()) {
+            epoll_ctl(epfd, EPOLL_CTL_DEL, p.puerto->descriptor(), nullptr);
+            p.activo = false;
+            activos--;
+        }
+        return entregadas;
+    }
+
+public:
+    /**
+     * @brief Constructor
+     * @param g Lista de gestión cuyos sensores reciben las lecturas
+     */
+    MotorIngesta(ListaGestion& g) : gestor(g), enrutador(g), epfd(epoll_create1(0)), puntos(nullptr),
+                                    numPuntos(0), capacidad(0), activos(0), segundos(0.0) {}
+
+    /**
+     * @brief Destructor - Cierra los puertos y la instancia de epoll
+     */
+    ~MotorIngesta() {
+        for (int i = 0; i < numPuntos; i++) {
+            delete puntos[i].puerto;
+        }
+        delete[] puntos;
+        close(epfd);
+    }
+
+    MotorIngesta(const MotorIngesta&) = delete;
+    MotorIngesta& operator=(const MotorIngesta&) = delete;
+
+    /**
+     * @brief Abre un puerto serial y lo asocia a un sensor
+     * @param ruta Ruta del dispositivo (ej: "/dev/ttyACM0")
+     * @param idSensor Nombre del sensor destino de las líneas sin etiqueta
+     *                 (vacío si el dispositivo solo envía líneas "ID:valor")
+     * @return Índice del punto o -1 si no se pudo abrir o el sensor no existe
+     */
+    int agregarPuerto(const char* ruta, const char* idSensor) {
+        int handle = gestor.internar(idSensor);
+        if (handle < 0 && idSensor[0] != '\0') return -1;
+        return registrar(new SerialPort(ruta, 0, false), handle);
+    }
+
+    /**
+     * @brief Asocia un descriptor ya abierto (p. ej. esclavo de openpty) a un sensor
+     * @param fd Descriptor a leer; el motor lo cierra al destruirse
+     * @param handle Handle del sensor destino de las líneas sin etiqueta (-1 = ninguno)
+     * @return Índice del punto o -1 si el descriptor no es válido
+     */
+    int agregarDescriptor(int fd, int handle) {
+        return registrar(new SerialPort(fd, true, 0), handle);
+    }
+
+    /**
+     * @brief Atiende los puertos hasta reunir un número de líneas
+     * @param lineasObjetivo Líneas a entregar en total (-1 = sin límite)
+     * @param inactividadMs Termina si pasa este tiempo sin eventos (-1 = nunca)
+     * @return Líneas entregadas en esta llamada
+     *
+     * Cada punto listo se vacía por completo, así que el total puede superar
+     * ligeramente el objetivo. También termina cuando todos los puntos se desconectan.
+     */
+    long ejecutar(long lineasObjetivo, int inactividadMs) {
+        const int MAX_EVENTOS = 64;
+        struct epoll_event eventos[MAX_EVENTOS];
+        long entregadas = 0;
+        auto inicio = std::chrono::steady_clock::now();
+
+        while (activos > 0 && (lineasObjetivo < 0 || entregadas < lineasObjetivo)) {
+            int n = epoll_wait(epfd, eventos, MAX_EVENTOS, inactividadMs);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            if (n == 0) break; // Inactividad
+            for (int i = 0; i < n; i++) {
+                Punto& p = puntos[eventos[i].data.u32];
+                if (p.activo) {
+                    entregadas += atender(p);
+                }
+            }
+        }
+
+        segundos += std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+        return entregadas;
+    }
+
+    /**
+     * @brief Número de puntos registrados
+     */
+    int getNumPuntos() const {
+        return numPuntos;
+    }
+
+    /**
+     * @brief Número de puntos aún conectados
+     */
+    int getActivos() const {
+        return activos;
+    }
+
+    /**
+     * @brief Líneas entregadas por un punto
+     * @param i Índice del punto
+     */
+    long lineasDe(int i) const {
+        return puntos[i].lineas;
+    }
+
+    /**
+     * @brief Imprime líneas, bytes y tasas de cada punto de conexión
+     */
+    void imprimirEstadisticas() const {
+        std::cout << "\n--- Estadísticas de Ingesta ---" << std::endl;
+        long total = 0;
+        for (int i = 0; i < numPuntos; i++) {
+            const Punto& p = puntos[i];
+            SensorBase* sensor = gestor.obtener(p.handle);
+            std::cout << "Punto #" << i + 1 << " -> "
+                      << (sensor != nullptr ? sensor->getNombre() : "(sin sensor)")
+                      << ": " << p.lineas << " líneas, "
+                      << p.descartadas << " descartadas, "
+                      << p.puerto->getBytesLeidos() << " bytes, "
+                      << (segundos > 0.0 ? p.lineas / segundos : 0.0) << " líneas/s"
+                      << (p.activo ? "" : " [desconectado]") << std::endl;
+            if (p.reloj.getReanclajes() > 0) {
+                std::cout << "  Reloj del dispositivo re-anclado " << p.reloj.getReanclajes()
+                          << " veces" << std::endl;
+            }
+            total += p.lineas;
+        }
+        std::cout << "Total: " << total << " líneas en " << segundos << " s ("
+                  << (segundos > 0.0 ? total / segundos : 0.0) << " líneas/s)" << std::endl;
+        if (enrutador.getDesconocidas() > 0 || enrutador.getInvalidas() > 0) {
+            std::cout << "Líneas etiquetadas descartadas: " << enrutador.getDesconocidas()
+                      << " con ID desconocido, " << enrutador.getInvalidas()
+                      << " con valor inválido" << std::endl;
+        }
+    }
+};
+
+#endif // MOTORINGESTA_H
@@ -0,0 +1,198 @@
+/**
+ * @file PoolTrabajo.h
+ * @brief Pool de hilos con robo de trabajo para bucles paralelos sobre índices
+ * @author Eliezer Mores Oyervides
+ * @date 2025
+ */
+
+#ifndef POOLTRABAJO_H
+#define POOLTRABAJO_H
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <thread>
+
+/**
+ * @class PoolTrabajo
+ * @brief Ejecuta funcion(i) para i en [0, n) repartiendo el rango entre hilos
+ *
+ * Cada hilo recibe un tramo contiguo del rango y lo consume desde el frente
+ * en porciones pequeñas. Cuando su tramo se agota roba la mitad final del
+ * tramo de otro hilo, así que un sensor con mucho historial no deja a los
+ * demás hilos esperando. El hilo que llama a paraCada() trabaja como uno
+ * más del pool; los hilos se crean una sola vez y duermen entre llamadas.
+ */
+class PoolTrabajo {
+private:
+    /**
+     * @struct Tramo
+     * @brief Rango pendiente de un hilo (alineado para no compartir línea de caché)
+     */
+    struct alignas(64) Tramo {
+        std::mutex mutex;
+        int inicio;   ///< Siguiente índice a tomar desde el frente
+        int fin;      ///< Fin exclusivo; los ladrones lo reducen
+    };
+
+    int numHilos;                          ///< Hilos incluyendo al llamador
+    Tramo* tramos;                         ///< Un tramo por hilo
+    std::thread* hilos;                    ///< Hilos auxiliares (numHilos - 1)
+    const std::function<void(int)>* tarea; ///< Función de la llamada en curso
+    int grano;                             ///< Índices que se toman por porción
+    std::atomic<int> pendientes;           ///< Índices aún sin ejecutar
+    int ocupados;                          ///< Hilos auxiliares dentro de trabajar()
+    long generacion;                       ///< Cambia con cada llamada a paraCada()
+    bool terminar;                         ///< Pide a los auxiliares que terminen
+    std::mutex mutex;
+    std::condition_variable hayTrabajo;    ///< Despierta a los auxiliares
+    std::condition_variable terminado;     ///< Despierta al llamador
+
+    /**
+     * @brief Toma una porción del propio tramo
+     * @return true si se obtuvo [desde, hasta)
+     */
+    bool tomar(int id, int& desde, int& hasta) {
+        Tramo& t = tramos[id];
+        std::lock_guard<std::mutex> lock(t.mutex);
+        if (t.inicio >= t.fin) return false;
+        desde = t.inicio;
+        hasta = t.inicio + grano < t.fin ? t.inicio + grano : t.fin;
+        t.inicio = hasta;
+        return true;
+    }
+
+    /**
+     * @brief Roba la mitad final del tramo de otro hilo y la hace propia
+     * @return true si se robó algo
+     */
+    bool robar(int id) {
+        for (int k = 1; k < numHilos; k++) {
+            Tramo& victima = tramos[(id + k) % numHilos];
+            int desde, hasta;
+            {
+                std::lock_guard<std::mutex> lock(victima.mutex);
+                int restantes = victima.fin - victima.inicio;
+                if (restantes <= 0) continue;
+                desde = victima.fin - (restantes + 1) / 2;
+                hasta = victima.fin;
+                victima.fin = desde;
+            }
+            std::lock_guard<std::mutex> lock(tramos[id].mutex);
+            tramos[id].inicio = desde;
+            tramos[id].fin = hasta;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Consume el propio tramo y después roba hasta que no quede trabajo
+     */
+    void trabajar(int id) {
+        int desde, hasta;
+        while (tomar(id, desde, hasta) || (robar(id) && tomar(id, desde, hasta))) {
+            for (int i = desde; i < hasta; i++) {
+                (*tarea)(i);
+            }
+            if (pendientes.fetch_sub(hasta - desde) == hasta - desde) {
+                std::lock_guard<std::mutex> lock(mutex);
+                terminado.notify_all();
+            }
+        }
+    }
+
+    /**
+     * @brief Bucle de los hilos auxiliares
+     */
+    void auxiliar(int id) {
+        long vista = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            hayTrabajo.wait(lock, [this, vista] { return terminar || generacion != vista; });
+            if (terminar) return;
+            vista = generacion;
+            ocupados++;
+            lock.unlock();
+            trabajar(id);
+            lock.lock();
+            ocupados--;
+            terminado.notify_all();
+        }
+    }
+
+public:
+    /**
+     * @brief Crea el pool
+     * @param n Hilos totales, incluido el llamador (0 = núcleos del equipo)
+     */
+    PoolTrabajo(int n = 0) : tarea(nullptr), grano(1), pendientes(0), ocupados(0),
+                             generacion(0), terminar(false) {
+        if (n <= 0) n = (int)std::thread::hardware_concurrency();
+        if (n <= 0) n = 1;
+        numHilos = n;
+        tramos = new Tramo[numHilos];
+        hilos = new std::thread[numHilos - 1];
+        for (int i = 1; i < numHilos; i++) {
+            hilos[i - 1] = std::thread(&PoolTrabajo::auxiliar, this, i);
+        }
+    }
+
+    /**
+     * @brief Destructor - detiene y espera a los hilos auxiliares
+     */
+    ~PoolTrabajo() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            terminar = true;
+        }
+        hayTrabajo.notify_all();
+        for (int i = 0; i < numHilos - 1; i++) {
+            hilos[i].join();
+        }
+        delete[] hilos;
+        delete[] tramos;
+    }
+
+    PoolTrabajo(const PoolTrabajo&) = delete;
+    PoolTrabajo& operator=(const PoolTrabajo&) = delete;
+
+    /**
+     * @brief Ejecuta funcion(i) para cada i en [0, n) y espera a que terminen todas
+     * @param n Número de índices
+     * @param funcion Trabajo por índice; las llamadas deben ser independientes
+     */
+    void paraCada(int n, const std::function<void(int)>& funcion) {
+        if (n <= 0) return;
+        std::unique_lock<std::mutex> lock(mutex);
+        tarea = &funcion;
+        // Porciones pequeñas frente al tramo para que el robo pueda equilibrar
+        grano = n / (numHilos * 16);
+        if (grano < 1) grano = 1;
+        for (int i = 0; i < numHilos; i++) {
+            std::lock_guard<std::mutex> lockTramo(tramos[i].mutex);
+            tramos[i].inicio = (int)((long)n * i / numHilos);
+            tramos[i].fin = (int)((long)n * (i + 1) / numHilos);
+        }
+        pendientes.store(n);
+        generacion++;
+        lock.unlock();
+        hayTrabajo.notify_all();
+
+        trabajar(0);
+
+        lock.lock();
+        terminado.wait(lock, [this] { return pendientes.load() == 0 && ocupados == 0; });
+        tarea = nullptr;
+    }
+
+    /**
+     * @brief Número de hilos del pool, incluido el llamador
+     */
+    int getNumHilos() const {
+        return numHilos;
+    }
+};
+
+#endif // POOLTRABAJO_H
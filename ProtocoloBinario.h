@@ -0,0 +1,347 @@
+/**
+ * @file ProtocoloBinario.h
+ * @brief Tramas binarias con prefijo de longitud y CRC, mezclables con el protocolo de texto
+ * @author Eliezer Mores Oyervides
+ * @date 2025
+ *
+ * Formato de trama (little-endian):
+ * @code
+ * 0xA5 | LEN | HANDLE (2) | TIPO (1) | VALOR | [MARCA (4)] | CRC16 (2)
+ * @endcode
+ * LEN cuenta los bytes de HANDLE, TIPO, VALOR y MARCA. TIPO es 'h' (int16),
+ * 'i' (int32) o 'f' (float32); en mayúscula ('H', 'I', 'F') la trama trae
+ * además MARCA, los milisegundos del reloj del dispositivo (uint32) en que
+ * se tomó la lectura. El CRC es CRC-16/CCITT-FALSE sobre LEN..MARCA.
+ * HANDLE es el handle del sensor en la ListaGestion (orden de registro).
+ *
+ * El byte de sincronía 0xA5 nunca aparece en una línea de texto ASCII, así
+ * que el decodificador distingue trama o línea por el primer byte pendiente
+ * y el dispositivo puede cambiar de modo en cualquier momento.
+ */
+
+#ifndef PROTOCOLOBINARIO_H
+#define PROTOCOLOBINARIO_H
+
+#include "SerialPort.h"
+#include "ListaGestion.h"
+#include "RelojDispositivo.h"
+#include <cstdint>
+#include <cstring>
+
+const unsigned char SINCRONIA_TRAMA = 0xA5;     ///< Primer byte de toda trama
+const int TAM_MAX_TRAMA = 15;                    ///< Trama más larga (valor de 4 bytes y marca)
+const char COMANDO_MODO_BINARIO[] = "BIN\n";    ///< Petición de modo binario al dispositivo
+const char COMANDO_MODO_TEXTO[] = "TXT\n";      ///< Petición de volver al modo texto
+
+/**
+ * @brief CRC-16/CCITT-FALSE (polinomio 0x1021, valor inicial 0xFFFF)
+ * @param datos Bytes a procesar
+ * @param n Número de bytes
+ * @return CRC calculado
+ */
+inline uint16_t crc16(const unsigned char* datos, int n) {
+    uint16_t crc = 0xFFFF;
+    for (int i = 0; i < n; i++) {
+        crc ^= (uint16_t)datos[i] << 8;
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief Completa marca, cabecera y CRC de una trama cuyo valor ya está escrito
+ * @param marcaMs Milisegundos del reloj del dispositivo (-1 = trama sin marca)
+ * @return Longitud total de la trama
+ */
+inline int cerrarTrama(unsigned char* destino, int handle, char tipo, int bytesValor, long long marcaMs) {
+    if (marcaMs >= 0) {
+        uint32_t m = (uint32_t)marcaMs;
+        unsigned char* p = destino + 5 + bytesValor;
+        p[0] = (unsigned char)(m & 0xFF);
+        p[1] = (unsigned char)((m >> 8) & 0xFF);
+        p[2] = (unsigned char)((m >> 16) & 0xFF);
+        p[3] = (unsigned char)((m >> 24) & 0xFF);
+        bytesValor += 4;
+        tipo = (char)(tipo - 'a' + 'A');
+    }
+    int len = 3 + bytesValor;
+    destino[0] = SINCRONIA_TRAMA;
+    destino[1] = (unsigned char)len;
+    destino[2] = (unsigned char)(handle & 0xFF);
+    destino[3] = (unsigned char)((handle >> 8) & 0xFF);
+    destino[4] = (unsigned char)tipo;
+    uint16_t crc = crc16(destino + 1, len + 1);
+    destino[2 + len] = (unsigned char)(crc & 0xFF);
+    destino[3 + len] = (unsigned char)(crc >> 8);
+    return len + 4;
+}
+
+/**
+ * @brief Codifica una lectura entera (int16 si cabe, int32 si no)
+ * @param destino Buffer de al menos TAM_MAX_TRAMA bytes
+ * @param handle Handle del sensor destino
+ * @param valor Lectura
+ * @param marcaMs Milisegundos del reloj del dispositivo (-1 = sin marca)
+ * @return Longitud de la trama
+ */
+inline int codificarTramaEntero(unsigned char* destino, int handle, int valor, long long marcaMs = -1) {
+    uint32_t v = (uint32_t)valor;
+    destino[5] = (unsigned char)(v & 0xFF);
+    destino[6] = (unsigned char)((v >> 8) & 0xFF);
+    if (valor >= -32768 && valor <= 32767) {
+        return cerrarTrama(destino, handle, 'h', 2, marcaMs);
+    }
+    destino[7] = (unsigned char)((v >> 16) & 0xFF);
+    destino[8] = (unsigned char)((v >> 24) & 0xFF);
+    return cerrarTrama(destino, handle, 'i', 4, marcaMs);
+}
+
+/**
+ * @brief Codifica una lectura flotante (float32 IEEE-754)
+ * @param destino Buffer de al menos TAM_MAX_TRAMA bytes
+ * @param handle Handle del sensor destino
+ * @param valor Lectura
+ * @param marcaMs Milisegundos del reloj del dispositivo (-1 = sin marca)
+ * @return Longitud de la trama
+ */
+inline int codificarTramaFlotante(unsigned char* destino, int handle, float valor, long long marcaMs = -1) {
+    uint32_t v;
+    memcpy(&v, &valor, sizeof(v));
+    destino[5] = (unsigned char)(v & 0xFF);
+    destino[6] = (unsigned char)((v >> 8) & 0xFF);
+    destino[7] = (unsigned char)((v >> 16) & 0xFF);
+    destino[8] = (unsigned char)((v >> 24) & 0xFF);
+    return cerrarTrama(destino, handle, 'f', 4, marcaMs);
+}
+
+/**
+ * @brief Pide al dispositivo que cambie de protocolo
+ * @param puerto Puerto abierto
+ * @param binario true para tramas binarias, false para líneas de texto
+ * @return true si el comando se envió
+ *
+ * Un firmware que solo conoce el modo texto ignora el comando y el
+ * decodificador sigue aceptando sus líneas, así que pedirlo siempre es seguro.
+ */
+inline bool solicitarModo(SerialPort& puerto, bool binario) {
+    const char* comando = binario ? COMANDO_MODO_BINARIO : COMANDO_MODO_TEXTO;
+    return puerto.escribir(comando, (long)strlen(comando));
+}
+
+/**
+ * @enum UnidadRecibida
+ * @brief Resultado de DecodificadorTramas::siguiente() y DecodificadorTramas::extraer()
+ */
+enum UnidadRecibida {
+    SIN_DATOS,      ///< No hay una trama ni una línea completa pendiente
+    TRAMA_BINARIA,  ///< Se decodificó una trama (siguiente() ya entregó su valor al sensor)
+    LINEA_TEXTO     ///< Se extrajo una línea de texto para el protocolo clásico
+};
+
+/**
+ * @class DecodificadorTramas
+ * @brief Separa tramas binarias y líneas de texto del búfer de un SerialPort
+ *
+ * Las tramas se leen directamente del búfer circular del puerto (solo se
+ * copian los 15 bytes como máximo de una trama que cruza el borde) y el
+ * valor se entrega con agregarEntero()/agregarFlotante(), que lo insertan en
+ * el historial sin pasar por texto. La marca de las tramas que la traen se
+ * traduce al reloj local con un RelojDispositivo. Ante una longitud o un
+ * CRC inválidos se descartan bytes hasta la siguiente sincronía o fin de línea.
+ *
+ * siguiente() separa y entrega en un paso. extraer() y entregarTrama() hacen
+ * lo mismo en dos, para que un hilo separe las unidades del puerto y otro
+ * las entregue a los sensores (TuberiaIngesta.h).
+ */
+class DecodificadorTramas {
+private:
+    long tramas;        ///< Tramas válidas
+    long lineas;        ///< Líneas de texto extraídas
+    long erroresCrc;    ///< Tramas con CRC inválido
+    long descartados;   ///< Bytes descartados al resincronizar
+    long sinDestino;    ///< Tramas válidas con handle desconocido
+    RelojDispositivo reloj; ///< Marcas del dispositivo -> reloj de los historiales
+
+    /**
+     * @brief Lee un entero de 32 bits little-endian
+     */
+    static uint32_t leer32(const unsigned char* p) {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    /**
+     * @brief Descarta bytes hasta la siguiente sincronía o fin de línea
+     *
+     * Tras una trama corrupta no se sabe dónde empieza la siguiente unidad:
+     * se salta hasta un 0xA5 o hasta después de un '\n', para no entregar
+     * bytes binarios como si fueran una línea de texto.
+     */
+    void resincronizar(SerialPort& puerto) {
+        puerto.consumir(1);
+        descartados++;
+        while (puerto.disponibles() > 0) {
+            unsigned char b = puerto.byteEn(0);
+            if (b == SINCRONIA_TRAMA) return;
+            puerto.consumir(1);
+            descartados++;
+            if (b == '\n') return;
+        }
+    }
+
+public:
+    /**
+     * @brief Constructor con contadores en cero
+     */
+    DecodificadorTramas() : tramas(0), lineas(0), erroresCrc(0), descartados(0), sinDestino(0) {}
+
+    /**
+     * @brief Separa la siguiente unidad pendiente en el búfer del puerto sin entregarla
+     * @param puerto Puerto cuyo búfer se consume (no se lee el descriptor)
+     * @param destino Recibe la línea de texto (terminada en '\0') o los bytes de la trama
+     * @param maxLen Tamaño de destino (al menos TAM_MAX_TRAMA)
+     * @return LINEA_TEXTO, TRAMA_BINARIA (CRC ya verificado) o SIN_DATOS
+     *
+     * No consulta la ListaGestion: puede llamarse desde un hilo que no toca
+     * los sensores.
+     */
+    UnidadRecibida extraer(SerialPort& puerto, char* destino, int maxLen) {
+        while (puerto.disponibles() > 0) {
+            if (puerto.byteEn(0) != SINCRONIA_TRAMA) {
+                if (puerto.extraerLinea(destino, maxLen)) {
+                    lineas++;
+                    return LINEA_TEXTO;
+                }
+                return SIN_DATOS;
+            }
+
+            if (puerto.disponibles() < 2) return SIN_DATOS;
+            int len = puerto.byteEn(1);
+            if (len != 5 && len != 7 && len != 9 && len != 11) {
+                resincronizar(puerto);
+                continue;
+            }
+            int total = len + 4;
+            if (puerto.disponibles() < total) return SIN_DATOS;
+
+            unsigned char* p = reinterpret_cast<unsigned char*>(destino);
+            long n;
+            const unsigned char* tramo = puerto.contiguo(n);
+            if (n >= total) {
+                memcpy(p, tramo, total);
+            } else {
+                for (int i = 0; i < total; i++) {
+                    p[i] = puerto.byteEn(i);
+                }
+            }
+            uint16_t crc = (uint16_t)(p[2 + len] | (p[3 + len] << 8));
+            if (crc16(p + 1, len + 1) != crc) {
+                erroresCrc++;
+                resincronizar(puerto);
+                continue;
+            }
+            puerto.consumir(total);
+            tramas++;
+            return TRAMA_BINARIA;
+        }
+        return SIN_DATOS;
+    }
+
+    /**
+     * @brief Entrega al sensor de su handle el valor de una trama ya verificada
+     * @param p Bytes de la trama (como los deja extraer())
+     * @param gestor Lista de gestión para resolver el handle
+     * @return true si el valor llegó a un sensor
+     */
+    bool entregarTrama(const unsigned char* p, ListaGestion& gestor) {
+        int len = p[1];
+        int handle = p[2] | (p[3] << 8);
+        char tipo = (char)p[4];
+        long long marca = 0;
+        if (tipo >= 'A' && tipo <= 'Z' && len >= 9) {
+            len -= 4;
+            tipo = (char)(tipo - 'A' + 'a');
+            marca = reloj.convertir(leer32(p + 2 + len));
+        }
+        SensorBase* sensor = gestor.obtener(handle);
+        if (sensor == nullptr) {
+            sinDestino++;
+        } else if (tipo == 'f' && len == 7) {
+            uint32_t bits = leer32(p + 5);
+            float valor;
+            memcpy(&valor, &bits, sizeof(valor));
+            sensor->agregarFlotante(valor, marca);
+            return true;
+        } else if (tipo == 'i' && len == 7) {
+            sensor->agregarEntero((int)leer32(p + 5), marca);
+            return true;
+        } else if (tipo == 'h' && len == 5) {
+            sensor->agregarEntero((int16_t)(p[5] | (p[6] << 8)), marca);
+            return true;
+        } else {
+            sinDestino++;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Procesa la siguiente unidad pendiente en el búfer del puerto
+     * @param puerto Puerto cuyo búfer se consume (no se lee el descriptor)
+     * @param gestor Lista de gestión para resolver el handle de las tramas
+     * @param linea Buffer donde se deja la línea de texto, si es lo siguiente
+     * @param maxLen Tamaño del buffer de línea (al menos TAM_MAX_TRAMA)
+     * @return Tipo de unidad procesada
+     */
+    UnidadRecibida siguiente(SerialPort& puerto, ListaGestion& gestor, char* linea, int maxLen) {
+        UnidadRecibida unidad = extraer(puerto, linea, maxLen);
+        if (unidad == TRAMA_BINARIA) {
+            entregarTrama(reinterpret_cast<const unsigned char*>(linea), gestor);
+        }
+        return unidad;
+    }
+
+    /**
+     * @brief Tramas válidas decodificadas
+     */
+    long getTramas() const {
+        return tramas;
+    }
+
+    /**
+     * @brief Líneas de texto extraídas
+     */
+    long getLineas() const {
+        return lineas;
+    }
+
+    /**
+     * @brief Tramas rechazadas por CRC
+     */
+    long getErroresCrc() const {
+        return erroresCrc;
+    }
+
+    /**
+     * @brief Bytes descartados al resincronizar
+     */
+    long getDescartados() const {
+        return descartados;
+    }
+
+    /**
+     * @brief Tramas válidas sin sensor destino (handle o tipo desconocido)
+     */
+    long getSinDestino() const {
+        return sinDestino;
+    }
+
+    /**
+     * @brief Reloj del dispositivo con que se traducen las marcas de las tramas
+     */
+    const RelojDispositivo& getReloj() const {
+        return reloj;
+    }
+};
+
+#endif // PROTOCOLOBINARIO_H
@@ -0,0 +1,299 @@
+/**
+ * @file Registro.h
+ * @brief Registro de mensajes por niveles con escritura asíncrona en lotes
+ * @author Eliezer Mores Oyervides
+ * @date 2025
+ *
+ * Las estructuras de datos no escriben en std::cout: emiten registros con
+ * las macros REGISTRO_TRAZA ... REGISTRO_ERROR. Cada registro se formatea en
+ * una línea local (sin std::endl ni bloqueo del flujo) y se copia a un búfer
+ * compartido; un hilo de fondo lo vacía con write() en bloques grandes.
+ *
+ * Nivel mínimo:
+ * - En compilación, REGISTRO_NIVEL_MINIMO (por defecto 1) elimina las
+ *   llamadas de niveles inferiores: las trazas no cuestan nada salvo que se
+ *   compile con -DREGISTRO_NIVEL_MINIMO=0.
+ * - En ejecución, Registro::establecerNivel() o la variable de entorno
+ *   IOT_NIVEL_REGISTRO (traza, depuracion, info, aviso, error). Por defecto info.
+ *
+ * Los registros van a la salida de errores (descriptor 2) para no mezclarse
+ * con los reportes del menú, que siguen en std::cout.
+ */
+
+#ifndef REGISTRO_H
+#define REGISTRO_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <unistd.h>
+
+#ifndef REGISTRO_NIVEL_MINIMO
+#define REGISTRO_NIVEL_MINIMO 1
+#endif
+
+/**
+ * @enum NivelRegistro
+ * @brief Severidad de un registro (de menor a mayor)
+ */
+enum NivelRegistro {
+    NIVEL_TRAZA = 0,       ///< Cada operación individual (inserciones, liberaciones)
+    NIVEL_DEPURACION = 1,  ///< Cada lectura y eventos internos
+    NIVEL_INFO = 2,        ///< Eventos del ciclo de vida de sensores y listas
+    NIVEL_AVISO = 3,       ///< Situaciones anómalas recuperables
+    NIVEL_ERROR = 4        ///< Fallos
+};
+
+/**
+ * @class Registro
+ * @brief Sumidero único de registros con un hilo escritor de fondo
+ *
+ * Doble búfer: los productores copian al búfer activo bajo un mutex y el
+ * hilo escritor lo intercambia por el vacío antes de llamar a write(), así
+ * que nadie espera a la consola mientras se escribe. Si el búfer activo se
+ * llena, el productor espera a que el escritor lo vacíe (no se pierden registros).
+ */
+class Registro {
+private:
+    static const long CAPACIDAD = 1 << 20;  ///< Bytes por búfer
+
+    char* activo;           ///< Búfer que reciben los productores
+    char* escritura;        ///< Búfer que vacía el hilo escritor
+    long usado;             ///< Bytes pendientes en el búfer activo
+    long long enviados;     ///< Bytes aceptados desde el inicio
+    long long escritos;     ///< Bytes ya entregados al descriptor
+    std::atomic<int> nivel; ///< Nivel mínimo en ejecución
+    int descriptor;         ///< Destino de los registros
+    bool terminar;          ///< Pide al escritor que termine
+    std::mutex mutex;
+    std::condition_variable hayDatos;   ///< Despierta al escritor
+    std::condition_variable escrito;    ///< Despierta a productores y a vaciar()
+    std::thread escritor;
+
+    /**
+     * @brief Convierte el nombre de un nivel al valor del enum
+     * @return Nivel o -1 si el nombre no es válido
+     */
+    static int nivelDesdeNombre(const char* nombre) {
+        const char* nombres[] = {"traza", "depuracion", "info", "aviso", "error"};
+        for (int i = 0; i < 5; i++) {
+            if (strcmp(nombre, nombres[i]) == 0) return i;
+        }
+        return -1;
+    }
+
+    /**
+     * @brief Bucle del hilo escritor
+     */
+    void escribir() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            hayDatos.wait_for(lock, std::chrono::milliseconds(50),
+                              [this] { return usado > 0 || terminar; });
+            if (usado == 0) {
+                if (terminar) return;
+                continue;
+            }
+            char* lote = activo;
+            long n = usado;
+            activo = escritura;
+            escritura = lote;
+            usado = 0;
+            lock.unlock();
+
+            long hecho = 0;
+            while (hecho < n) {
+                ssize_t w = ::write(descriptor, lote + hecho, n - hecho);
+                if (w <= 0) break;
+                hecho += w;
+            }
+
+            lock.lock();
+            escritos += n;
+            escrito.notify_all();
+        }
+    }
+
+    /**
+     * @brief Constructor - lee IOT_NIVEL_REGISTRO y arranca el escritor
+     */
+    Registro() : activo(new char[CAPACIDAD]), escritura(new char[CAPACIDAD]), usado(0),
+                 enviados(0), escritos(0), nivel(NIVEL_INFO), descriptor(2), terminar(false) {
+        const char* entorno = getenv("IOT_NIVEL_REGISTRO");
+        if (entorno != nullptr && nivelDesdeNombre(entorno) >= 0) {
+            nivel.store(nivelDesdeNombre(entorno));
+        }
+        escritor = std::thread(&Registro::escribir, this);
+    }
+
+public:
+    /**
+     * @brief Destructor - escribe lo pendiente y detiene el escritor
+     */
+    ~Registro() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            terminar = true;
+        }
+        hayDatos.notify_one();
+        escritor.join();
+        delete[] activo;
+        delete[] escritura;
+    }
+
+    Registro(const Registro&) = delete;
+    Registro& operator=(const Registro&) = delete;
+
+    /**
+     * @brief Instancia única del registro (se crea en el primer uso)
+     */
+    static Registro& instancia() {
+        static Registro registro;
+        return registro;
+    }
+
+    /**
+     * @brief Indica si un nivel pasa el filtro de ejecución
+     */
+    bool habilitado(int n) const {
+        return n >= nivel.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Cambia el nivel mínimo en ejecución
+     */
+    void establecerNivel(NivelRegistro n) {
+        nivel.store(n, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Cambia el descriptor destino (p. ej. un archivo abierto)
+     * @param fd Descriptor; el registro no lo cierra
+     */
+    void establecerDescriptor(int fd) {
+        vaciar();
+        std::lock_guard<std::mutex> lock(mutex);
+        descriptor = fd;
+    }
+
+    /**
+     * @brief Agrega un registro ya formateado al búfer compartido
+     * @param texto Bytes del registro (incluye el salto de línea)
+     * @param n Número de bytes
+     */
+    void enviar(const char* texto, long n) {
+        std::unique_lock<std::mutex> lock(mutex);
+        escrito.wait(lock, [this, n] { return usado + n <= CAPACIDAD; });
+        memcpy(activo + usado, texto, n);
+        usado += n;
+        enviados += n;
+        if (usado > CAPACIDAD / 2) {
+            hayDatos.notify_one();
+        }
+    }
+
+    /**
+     * @brief Espera a que todos los registros enviados estén escritos
+     *
+     * Se llama antes de mostrar el menú para que los mensajes de la
+     * operación anterior aparezcan antes del siguiente prompt.
+     */
+    void vaciar() {
+        std::unique_lock<std::mutex> lock(mutex);
+        long long objetivo = enviados;
+        hayDatos.notify_one();
+        escrito.wait(lock, [this, objetivo] { return escritos >= objetivo; });
+    }
+};
+
+/**
+ * @class LineaRegistro
+ * @brief Formatea un registro en un búfer local y lo envía al destruirse
+ *
+ * Admite la misma sintaxis << que std::cout para los tipos que usan las
+ * estructuras, con el mismo formato numérico (%g para flotantes).
+ */
+class LineaRegistro {
+private:
+    static const int MAX_LINEA = 256;  ///< Longitud máxima de un registro
+    char texto[MAX_LINEA];
+    int len;
+
+    void agregar(const char* s, int n) {
+        if (n > MAX_LINEA - 1 - len) n = MAX_LINEA - 1 - len;
+        memcpy(texto + len, s, n);
+        len += n;
+    }
+
+    template <typename... Args>
+    void formatear(const char* formato, Args... args) {
+        char num[32];
+        int n = snprintf(num, sizeof(num), formato, args...);
+        agregar(num, n);
+    }
+
+public:
+    /**
+     * @brief Abre un registro del nivel dado (aviso y error llevan prefijo)
+     */
+    LineaRegistro(int nivel) : len(0) {
+        if (nivel == NIVEL_AVISO) agregar("AVISO: ", 7);
+        if (nivel == NIVEL_ERROR) agregar("ERROR: ", 7);
+    }
+
+    /**
+     * @brief Cierra la línea y la entrega al registro
+     */
+    ~LineaRegistro() {
+        texto[len++] = '\n';
+        Registro::instancia().enviar(texto, len);
+    }
+
+    LineaRegistro& operator<<(const char* s) { agregar(s, (int)strlen(s)); return *this; }
+    LineaRegistro& operator<<(char c) { agregar(&c, 1); return *this; }
+    LineaRegistro& operator<<(int v) { formatear("%d", v); return *this; }
+    LineaRegistro& operator<<(long v) { formatear("%ld", v); return *this; }
+    LineaRegistro& operator<<(unsigned long v) { formatear("%lu", v); return *this; }
+    LineaRegistro& operator<<(double v) { formatear("%g", v); return *this; }
+};
+
+/**
+ * @brief Emite un registro si su nivel está habilitado en ejecución
+ * @param nivel NivelRegistro del mensaje
+ * @param mensaje Cadena de operandos separados por << (ej: "Valor: " << v)
+ */
+#define REGISTRAR(nivel, mensaje) \
+    do { \
+        if (Registro::instancia().habilitado(nivel)) { \
+            LineaRegistro linea_registro_(nivel); \
+            linea_registro_ << mensaje; \
+        } \
+    } while (0)
+
+#if REGISTRO_NIVEL_MINIMO <= 0
+#define REGISTRO_TRAZA(mensaje) REGISTRAR(NIVEL_TRAZA, mensaje)
+#else
+#define REGISTRO_TRAZA(mensaje) do { } while (0)
+#endif
+
+#if REGISTRO_NIVEL_MINIMO <= 1
+#define REGISTRO_DEPURACION(mensaje) REGISTRAR(NIVEL_DEPURACION, mensaje)
+#else
+#define REGISTRO_DEPURACION(mensaje) do { } while (0)
+#endif
+
+#if REGISTRO_NIVEL_MINIMO <= 2
+#define REGISTRO_INFO(mensaje) REGISTRAR(NIVEL_INFO, mensaje)
+#else
+#define REGISTRO_INFO(mensaje) do { } while (0)
+#endif
+
+#define REGISTRO_AVISO(mensaje) REGISTRAR(NIVEL_AVISO, mensaje)
+#define REGISTRO_ERROR(mensaje) REGISTRAR(NIVEL_ERROR, mensaje)
+
+#endif // REGISTRO_H
@@ -0,0 +1,98 @@
+/**
+ * @file RelojDispositivo.h
+ * @brief Conversión de marcas de tiempo externas al reloj monótono de los historiales
+ * @author Eliezer Mores Oyervides
+ * @date 2025
+ *
+ * Los historiales fechan cada lectura en milisegundos de CLOCK_MONOTONIC
+ * (el mismo reloj que relojNs() y relojGruesoNs(), desplazado por
+ * ORIGEN_HISTORIAL_MS). Aquí se traducen a ese reloj las marcas que trae el
+ * dispositivo en la línea o en la trama, los instantes de pared que se usan
+ * al consultar una ventana y las marcas de pared guardadas en los segmentos.
+ */
+
+#ifndef RELOJDISPOSITIVO_H
+#define RELOJDISPOSITIVO_H
+
+#include "Metricas.h"
+#include <chrono>
+
+/**
+ * @brief Convierte un instante de pared al reloj monótono de los historiales
+ * @param epocaMs Milisegundos desde la época Unix (p. ej. las 10:00 de hoy)
+ * @return Milisegundos monótonos equivalentes
+ *
+ * Supone que el reloj de pared no se ajustó entre ese instante y ahora.
+ */
+inline long long monotonoDesdeEpocaMs(long long epocaMs) {
+    long long ahoraEpoca = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    return msHistorial(relojNs()) - (ahoraEpoca - epocaMs);
+}
+
+/**
+ * @brief Convierte una marca de los historiales a milisegundos desde la época Unix
+ * @param monotonoMs Milisegundos monótonos (p. ej. la marca de una lectura)
+ * @return Instante de pared equivalente, válido tras reiniciar el equipo
+ */
+inline long long epocaDesdeMonotonoMs(long long monotonoMs) {
+    return monotonoMs - monotonoDesdeEpocaMs(0);
+}
+
+/**
+ * @class RelojDispositivo
+ * @brief Traduce los milisegundos del reloj de un dispositivo (p. ej. millis()) al reloj local
+ *
+ * El desfase entre ambos relojes se estima con el menor retardo observado:
+ * cada marca se compara con el instante en que llegó y se conserva la
+ * diferencia más pequeña, de modo que la marca traducida nunca queda después
+ * de su llegada y el tiempo que la lectura pasó en el puerto o en la tubería
+ * no se le suma. Si el reloj del dispositivo retrocede (reinicio o vuelta de
+ * los 32 bits) se vuelve a anclar en la llegada.
+ */
+class RelojDispositivo {
+private:
+    long long desfase;     ///< Reloj local menos reloj del dispositivo
+    long long ultima;      ///< Última marca del dispositivo recibida
+    bool anclado;          ///< false hasta la primera marca
+    long reanclajes;       ///< Veces que el reloj del dispositivo retrocedió
+
+public:
+    RelojDispositivo() : desfase(0), ultima(0), anclado(false), reanclajes(0) {}
+
+    /**
+     * @brief Convierte una marca del dispositivo al reloj de los historiales
+     * @param dispositivoMs Milisegundos en el reloj del dispositivo
+     * @param llegadaMs Instante local de llegada (instanteIngestaMs())
+     * @return Milisegundos monótonos locales
+     */
+    long long convertir(long long dispositivoMs, long long llegadaMs) {
+        long long retardo = llegadaMs - dispositivoMs;
+        if (!anclado || dispositivoMs < ultima) {
+            if (anclado) reanclajes++;
+            desfase = retardo;
+            anclado = true;
+        } else if (retardo < desfase) {
+            desfase = retardo;
+        }
+        ultima = dispositivoMs;
+        return dispositivoMs + desfase;
+    }
+
+    /**
+     * @brief Convierte una marca que está llegando en este momento
+     * @param dispositivoMs Milisegundos en el reloj del dispositivo
+     */
+    long long convertir(long long dispositivoMs) {
+        return convertir(dispositivoMs, instanteIngestaMs());
+    }
+
+    /**
+     * @brief Veces que se volvió a anclar por un retroceso del dispositivo
+     */
+    long getReanclajes() const {
+        return reanclajes;
+    }
+};
+
+#endif // RELOJDISPOSITIVO_H
@@ -0,0 +1,288 @@
+/**
+ * @file ResumenesTiempo.h
+ * @brief Resúmenes por segundo, minuto, hora y día mantenidos al insertar cada lectura
+ * @author Eliezer Mores Oyervides
+ * @date 2025
+ */
+
+#ifndef RESUMENESTIEMPO_H
+#define RESUMENESTIEMPO_H
+
+#include "AcumuladorLecturas.h"
+#include <type_traits>
+
+/**
+ * @struct CubetaResumen
+ * @brief Conteo, suma y extremos de las lecturas de un intervalo fijo
+ * @tparam T Tipo de lectura
+ */
+template <typename T>
+struct CubetaResumen {
+    typedef typename std::conditional<std::is_integral<T>::value,
+                                      long long, double>::type Ancho;
+
+    long long numero;  ///< Intervalo que resume (marca / ancho del nivel); -1 = nunca usada
+    Ancho suma;        ///< Suma de las lecturas (exacta para enteros)
+    long cantidad;     ///< Lecturas del intervalo
+    T minimo;          ///< Menor lectura
+    T maximo;          ///< Mayor lectura
+};
+
+/**
+ * @class NivelResumen
+ * @brief Arreglo circular de cubetas de un mismo ancho
+ * @tparam T Tipo de lectura
+ *
+ * La cubeta del intervalo k ocupa la posición k % capacidad, así que el
+ * nivel cubre siempre los últimos capacidad × ancho milisegundos aunque
+ * haya intervalos sin lecturas: una posición cuyo número no coincide con
+ * el intervalo buscado está vacía o es de una vuelta anterior.
+ */
+template <typename T>
+class NivelResumen {
+private:
+    CubetaResumen<T>* cubetas;  ///< capacidad cubetas
+    CubetaResumen<T>* actual;   ///< Cubeta de la lectura más reciente (nullptr = sin lecturas)
+    long long ancho;            ///< Milisegundos por cubeta
+    long long finActual;        ///< Primer milisegundo después de la cubeta actual
+    int capacidad;              ///< Cubetas retenidas
+
+public:
+    /**
+     * @brief Constructor
+     * @param anchoMs Milisegundos por cubeta
+     * @param cubetasRetenidas Cubetas del arreglo circular
+     */
+    NivelResumen(long long anchoMs, int cubetasRetenidas)
+        : cubetas(new CubetaResumen<T>[cubetasRetenidas]), actual(nullptr), ancho(anchoMs),
+          finActual(0), capacidad(cubetasRetenidas) {
+        for (int i = 0; i < capacidad; i++) {
+            cubetas[i].numero = -1;
+        }
+    }
+
+    ~NivelResumen() {
+        delete[] cubetas;
+    }
+
+    NivelResumen(const NivelResumen&) = delete;
+    NivelResumen& operator=(const NivelResumen&) = delete;
+
+    /**
+     * @brief Agrega una lectura, O(1)
+     * @param x Lectura
+     * @param marca Milisegundos monótonos (no anterior a la lectura previa)
+     *
+     * Mientras la marca caiga en la cubeta actual basta una comparación;
+     * solo al cambiar de intervalo se divide para ubicar la posición.
+     */
+    void agregar(T x, long long marca) {
+        if (actual != nullptr && marca < finActual) {
+            actual->suma += x;
+            actual->cantidad++;
+            if (x < actual->minimo) actual->minimo = x;
+            if (actual->maximo < x) actual->maximo = x;
+            return;
+        }
+        long long numero = marca / ancho;
+        actual = &cubetas[numero % capacidad];
+        finActual = (numero + 1) * ancho;
+        actual->numero = numero;
+        actual->suma = x;
+        actual->cantidad = 1;
+        actual->minimo = x;
+        actual->maximo = x;
+    }
+
+    /**
+     * @brief Agrega a v las cubetas de los intervalos [primero, ultimo], en orden
+     *
+     * Los intervalos fuera de la cobertura o sin lecturas se omiten.
+     */
+    void sumar(VentanaLecturas<T>& v, long long primero, long long ultimo) const {
+        if (actual == nullptr) return;
+        if (ultimo > actual->numero) ultimo = actual->numero;
+        if (primero < actual->numero - capacidad + 1) primero = actual->numero - capacidad + 1;
+        if (primero > ultimo) return;
+        int pos = (int)(primero % capacidad);
+        for (long long k = primero; k <= ultimo; k++) {
+            const CubetaResumen<T>& c = cubetas[pos];
+            if (c.numero == k) {
+                v.agregarTramo(c.cantidad, c.suma, c.minimo, c.maximo, k * ancho, k * ancho + ancho - 1);
+            }
+            if (++pos == capacidad) pos = 0;
+        }
+    }
+
+    /**
+     * @brief Primer milisegundo que el nivel todavía resume (0 si no ha dado la vuelta)
+     */
+    long long cobertura() const {
+        if (actual == nullptr) return 0;
+        long long primero = actual->numero - capacidad + 1;
+        return primero > 0 ? primero * ancho : 0;
+    }
+
+    /**
+     * @brief Último milisegundo de la cubeta más reciente (-1 si no hay lecturas)
+     */
+    long long fin() const {
+        return actual != nullptr ? finActual - 1 : -1;
+    }
+
+    /**
+     * @brief Milisegundos por cubeta
+     */
+    long long getAncho() const {
+        return ancho;
+    }
+
+    /**
+     * @brief Cubetas del arreglo circular
+     */
+    int getCapacidad() const {
+        return capacidad;
+    }
+
+    /**
+     * @brief Memoria del nivel
+     */
+    long memoriaBytes() const {
+        return (long)sizeof(NivelResumen) + (long)capacidad * (long)sizeof(CubetaResumen<T>);
+    }
+};
+
+/**
+ * @class ResumenesTiempo
+ * @brief Niveles de 1 s, 1 min, 1 h y 1 día que se actualizan con cada lectura
+ * @tparam T Tipo de lectura
+ *
+ * Cada lectura suma en la cubeta actual de los cuatro niveles (O(1), sin
+ * divisiones mientras no cambie el segundo). Los niveles cubren 1 hora,
+ * 1 día, 32 días y 400 días, ocupan unos 200 KB por sensor y no dependen
+ * del historial: las lecturas que la retención o procesar() quitan del
+ * historial siguen contadas aquí, así que la retención puede ser corta
+ * sin perder las vistas largas.
+ *
+ * consultar() toma el interior del intervalo del nivel más grueso cuyas
+ * cubetas caben enteras en él y resuelve cada borde con el nivel siguiente
+ * más fino, hasta el segundo. Una vista de un año lee unas 365 cubetas
+ * diarias más unas decenas de los bordes. Los anchos se dividen entre sí,
+ * de modo que las cubetas de un nivel nunca parten las del siguiente.
+ */
+template <typename T>
+class ResumenesTiempo {
+public:
+    static const int NIVELES = 4;   ///< Segundo, minuto, hora y día
+
+private:
+    NivelResumen<T> niveles[NIVELES];  ///< Del más fino al más grueso
+    long long ultimaMarca;             ///< Marca de la lectura más reciente
+
+    /**
+     * @brief Suma [desde, hasta] con los niveles 0..n
+     * @param resolucion Mayor ancho de una cubeta que quedó parcialmente fuera de [desde, hasta]
+     *
+     * Si el nivel más fino no alcanza hasta desde, el intervalo se resuelve
+     * en este nivel con cubetas completas aunque sobresalgan.
+     */
+    void sumar(VentanaLecturas<T>& v, long long desde, long long hasta, int n, long long& resolucion) const {
+        const NivelResumen<T>& nivel = niveles[n];
+        long long ancho = nivel.getAncho();
+        long long a = (desde + ancho - 1) / ancho * ancho;  // Primer borde de cubeta >= desde
+        long long b = (hasta + 1) / ancho * ancho;          // Último borde <= hasta + 1
+        if (n == 0 || niveles[n - 1].cobertura() > desde) {
+            if ((a != desde || b != hasta + 1) && ancho > resolucion) {
+                resolucion = ancho;
+            }
+            nivel.sumar(v, desde / ancho, hasta / ancho);
+            return;
+        }
+        if (a >= b) {
+            sumar(v, desde, hasta, n - 1, resolucion);
+            return;
+        }
+        if (desde < a) {
+            sumar(v, desde, a - 1, n - 1, resolucion);
+        }
+        nivel.sumar(v, a / ancho, b / ancho - 1);
+        if (b <= hasta) {
+            sumar(v, b, hasta, n - 1, resolucion);
+        }
+    }
+
+public:
+    /**
+     * @brief Constructor (reserva los cuatro niveles)
+     */
+    ResumenesTiempo()
+        : niveles{{1000LL, 3600}, {60000LL, 1440}, {3600000LL, 768}, {86400000LL, 400}},
+          ultimaMarca(0) {}
+
+    ResumenesTiempo(const ResumenesTiempo&) = delete;
+    ResumenesTiempo& operator=(const ResumenesTiempo&) = delete;
+
+    /**
+     * @brief Agrega una lectura a todos los niveles
+     * @param x Lectura
+     * @param marca Milisegundos monótonos (una marca anterior a la previa se toma como la previa)
+     */
+    void agregar(T x, long long marca) {
+        if (marca < ultimaMarca) marca = ultimaMarca;
+        ultimaMarca = marca;
+        for (int n = 0; n < NIVELES; n++) {
+            niveles[n].agregar(x, marca);
+        }
+    }
+
+    /**
+     * @brief Conteo, suma y extremos de las lecturas recibidas en [desde, hasta]
+     * @param desde Milisegundos monótonos del inicio (inclusive)
+     * @param hasta Milisegundos monótonos del final (inclusive)
+     * @param resolucionMs Si no es nullptr recibe 0 cuando el resultado es
+     *        exacto (bordes alineados a segundos o más allá de los datos) o
+     *        el ancho de la cubeta más grande que sobresale del intervalo
+     * @return Agregados; primera y ultima son los límites de la primera y la
+     *         última cubeta usadas. Lo anterior a los 400 días retenidos no cuenta.
+     */
+    VentanaLecturas<T> consultar(long long desde, long long hasta, long long* resolucionMs = nullptr) const {
+        VentanaLecturas<T> v;
+        long long resolucion = 0;
+        const NivelResumen<T>& grueso = niveles[NIVELES - 1];
+        // Sin lecturas fuera de [cobertura, fin] del nivel más grueso: recortar no cambia el resultado
+        if (desde < grueso.cobertura()) desde = grueso.cobertura();
+        if (hasta > grueso.fin()) hasta = grueso.fin();
+        if (desde <= hasta) {
+            sumar(v, desde, hasta, NIVELES - 1, resolucion);
+        }
+        if (resolucionMs != nullptr) *resolucionMs = resolucion;
+        return v;
+    }
+
+    /**
+     * @brief Nivel n (0 = segundos, NIVELES - 1 = días)
+     */
+    const NivelResumen<T>& getNivel(int n) const {
+        return niveles[n];
+    }
+
+    /**
+     * @brief Marca de la lectura más reciente
+     */
+    long long getUltimaMarca() const {
+        return ultimaMarca;
+    }
+
+    /**
+     * @brief Memoria de los cuatro niveles
+     */
+    long memoriaBytes() const {
+        long total = (long)sizeof(ResumenesTiempo) - (long)sizeof(niveles);
+        for (int n = 0; n < NIVELES; n++) {
+            total += niveles[n].memoriaBytes();
+        }
+        return total;
+    }
+};
+
+#endif // RESUMENESTIEMPO_H
@@ -0,0 +1,540 @@
+/**
+ * @file SegmentoSensor.h
+ * @brief Archivo de segmento por sensor: lecturas anexadas en lotes con CRC y recuperación por mmap
+ * @author Eliezer Mores Oyervides
+ * @date 2025
+ *
+ * Formato del archivo:
+ * @code
+ * CabeceraSegmento | LOTE | LOTE | ...
+ * LOTE = CANTIDAD (uint32) | CRC32 (uint32) | BASE (int64)
+ *        | CANTIDAD lecturas de 4 bytes | CANTIDAD desfases (int32)
+ * @endcode
+ * BASE son los milisegundos de pared (época Unix) de la primera lectura del
+ * lote y cada desfase, los milisegundos de su lectura después de BASE: el
+ * reloj monótono de los historiales vuelve a cero al reiniciar el equipo,
+ * así que al recuperar se traduce con monotonoDesdeEpocaMs(). El CRC de
+ * cada lote cubre CANTIDAD, BASE, las lecturas y los desfases. La cabecera guarda
+ * cuántos bytes del archivo ya se confirmaron con fdatasync(); al recuperar
+ * solo se verifican los lotes posteriores (la cola que pudo quedar a medias
+ * tras una caída) y el archivo se trunca en el primer lote inválido. Si la
+ * propia cabecera está dañada se verifica el archivo completo.
+ */
+
+#ifndef SEGMENTOSENSOR_H
+#define SEGMENTOSENSOR_H
+
+#include "Registro.h"
+#include "RelojDispositivo.h"
+#include <cstdint>
+#include <climits>
+#include <cstddef>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * @brief Lecturas por lote anexado al archivo
+ */
+const int LECTURAS_POR_LOTE = 256;
+
+/**
+ * @brief Bytes anexados sin confirmar que fuerzan un fdatasync()
+ */
+const long long BYTES_SIN_CONFIRMAR = 1 << 20;
+
+/**
+ * @brief CRC-32 (polinomio reflejado 0xEDB88320, el de zlib)
+ * @param datos Bytes a verificar
+ * @param n Número de bytes
+ * @param crc Valor previo para encadenar bloques (0 al inicio)
+ * @return CRC calculado
+ */
+inline uint32_t crc32(const unsigned char* datos, long n, uint32_t crc = 0) {
+    struct Tabla {
+        uint32_t valores[256];
+        Tabla() {
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t c = i;
+                for (int b = 0; b < 8; b++) {
+                    c = (c & 1) ? (c >> 1) ^ 0xEDB88320u : c >> 1;
+                }
+                valores[i] = c;
+            }
+        }
+    };
+    static const Tabla tabla;  // Inicialización única y segura entre hilos
+    crc = ~crc;
+    for (long i = 0; i < n; i++) {
+        crc = tabla.valores[(crc ^ datos[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+/**
+ * @brief Bits de CabeceraSegmento::opciones
+ */
+enum OpcionSegmento {
+    SEGMENTO_COMPRIMIDO = 1,  ///< El sensor usa historial comprimido (activarCompresion)
+    SEGMENTO_RESUMENES = 2    ///< El sensor mantiene resúmenes por tiempo (activarResumenes)
+};
+
+/**
+ * @struct CabeceraSegmento
+ * @brief Cabecera fija al inicio de cada archivo de segmento
+ *
+ * Además de identificar al sensor guarda su configuración (retención,
+ * compresión y resúmenes), que AlmacenPersistente::restaurar() vuelve a aplicar.
+ */
+struct CabeceraSegmento {
+    char magia[4];          ///< "IOTS"
+    uint32_t version;       ///< Versión del formato
+    char tipo;              ///< 'i' (int32) o 'f' (float32), como en ProtocoloBinario
+    char reservado[3];
+    uint32_t orden;         ///< Posición de registro del sensor (para restaurar en orden)
+    char nombre[48];        ///< Nombre del sensor
+    uint64_t confirmados;   ///< Bytes del archivo ya sincronizados y verificados
+    int32_t maxLecturas;    ///< Retención en lecturas (0 = sin límite)
+    uint32_t opciones;      ///< Combinación de OpcionSegmento
+    double maxSegundos;     ///< Retención en segundos (0 = sin límite)
+    uint32_t crc;           ///< CRC-32 de los campos anteriores
+};
+
+/**
+ * @struct CabeceraLote
+ * @brief Prefijo de cada lote de lecturas
+ */
+struct CabeceraLote {
+    uint32_t cantidad;      ///< Lecturas del lote (1 .. LECTURAS_POR_LOTE)
+    uint32_t crc;           ///< CRC-32 de cantidad, base, lecturas y desfases
+    int64_t baseMs;         ///< Milisegundos de pared de la primera lectura
+};
+
+/**
+ * @class SegmentoSensor
+ * @brief Historial persistente de un sensor en un archivo de solo anexado
+ *
+ * Las lecturas se acumulan en un lote en memoria y se escriben con un solo
+ * write() cuando el lote se llena o al llamar a volcar(). Al recuperar, el
+ * archivo se proyecta con mmap() y las lecturas se leen directamente del
+ * mapa cuando el sensor las necesita (paraCadaLoteMapeado), así que abrir
+ * un segmento no depende de cuántas lecturas tenga.
+ */
+class SegmentoSensor {
+private:
+    static const uint32_t VERSION = 3;  ///< 2: lotes con marcas de tiempo; 3: configuración en la cabecera
+
+    int fd;                      ///< Descriptor del archivo (-1 si no está abierto)
+    CabeceraSegmento cabecera;   ///< Copia en memoria de la cabecera
+    unsigned char* lote;         ///< CabeceraLote, lecturas pendientes y espacio para sus desfases
+    int32_t* desfases;           ///< Milisegundos de cada lectura pendiente después de baseLote
+    long long baseLote;          ///< Marca monótona de la primera lectura pendiente
+    int enLote;                  ///< Lecturas pendientes en el lote
+    long long bytesArchivo;      ///< Bytes válidos escritos en el archivo
+    const unsigned char* mapa;   ///< Proyección del archivo recuperado (nullptr si no hay)
+    long long bytesProyectados;  ///< Longitud de la proyección (para munmap)
+    long long bytesMapa;         ///< Bytes válidos de la proyección
+    long long bytesTruncados;    ///< Bytes de cola descartados al recuperar
+    long lecturasPerdidas;       ///< Lecturas descartadas tras fallar su escritura
+
+    /**
+     * @brief CRC de la cabecera (todos los campos anteriores a crc)
+     */
+    static uint32_t crcCabecera(const CabeceraSegmento& c) {
+        return crc32((const unsigned char*)&c, (long)offsetof(CabeceraSegmento, crc));
+    }
+
+    /**
+     * @brief Escribe n bytes completos en la posición actual
+     * @return true si se escribieron todos
+     */
+    bool escribirTodo(const unsigned char* datos, long n) {
+        long hecho = 0;
+        while (hecho < n) {
+            ssize_t w = ::write(fd, datos + hecho, n - hecho);
+            if (w < 0 && errno == EINTR) continue;
+            if (w <= 0) return false;
+            hecho += w;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Reescribe la cabecera con el número de bytes confirmados
+     */
+    bool escribirCabecera() {
+        cabecera.crc = crcCabecera(cabecera);
+        return pwrite(fd, &cabecera, sizeof(cabecera), 0) == (ssize_t)sizeof(cabecera);
+    }
+
+    /**
+     * @brief CRC de un lote completo (todo salvo el propio campo crc)
+     */
+    static uint32_t crcLote(const unsigned char* lote, long bytes) {
+        uint32_t crc = crc32(lote + offsetof(CabeceraLote, cantidad), sizeof(uint32_t));
+        return crc32(lote + offsetof(CabeceraLote, baseMs), bytes - (long)offsetof(CabeceraLote, baseMs), crc);
+    }
+
+    /**
+     * @brief Verifica un lote en la posición dada
+     * @return Bytes del lote o 0 si está incompleto o dañado
+     */
+    static long verificarLote(const unsigned char* base, long long pos, long long fin) {
+        if (pos + (long long)sizeof(CabeceraLote) > fin) return 0;
+        CabeceraLote c;
+        memcpy(&c, base + pos, sizeof(c));
+        if (c.cantidad == 0 || c.cantidad > (uint32_t)LECTURAS_POR_LOTE) return 0;
+        long bytes = (long)sizeof(CabeceraLote) + (long)c.cantidad * 8;
+        if (pos + bytes > fin) return 0;
+        return crcLote(base + pos, bytes) == c.crc ? bytes : 0;
+    }
+
+public:
+    /**
+     * @brief Constructor (segmento sin archivo)
+     */
+    SegmentoSensor() : fd(-1), lote(new unsigned char[sizeof(CabeceraLote) + LECTURAS_POR_LOTE * 8]),
+                       desfases(new int32_t[LECTURAS_POR_LOTE]), baseLote(0), enLote(0), bytesArchivo(0), mapa(nullptr), bytesProyectados(0),
+                       bytesMapa(0), bytesTruncados(0), lecturasPerdidas(0) {
+        memset(&cabecera, 0, sizeof(cabecera));
+    }
+
+    /**
+     * @brief Destructor - escribe y confirma lo pendiente y cierra el archivo
+     */
+    ~SegmentoSensor() {
+        if (fd >= 0) {
+            confirmar();
+            if (enLote > 0) {
+                lecturasPerdidas += enLote;
+                REGISTRO_ERROR("Segmento de " << cabecera.nombre << ": se pierden " << enLote
+                               << " lecturas sin escribir");
+            }
+            close(fd);
+        }
+        liberarMapa();
+        delete[] lote;
+        delete[] desfases;
+    }
+
+    SegmentoSensor(const SegmentoSensor&) = delete;
+    SegmentoSensor& operator=(const SegmentoSensor&) = delete;
+
+    /**
+     * @brief Crea un archivo de segmento nuevo
+     * @param ruta Ruta del archivo (no debe existir)
+     * @param nombre Nombre del sensor
+     * @param tipo 'i' o 'f'
+     * @param orden Posición de registro del sensor
+     * @return true si el archivo se creó
+     */
+    bool crear(const char* ruta, const char* nombre, char tipo, int orden) {
+        fd = open(ruta, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (fd < 0) return false;
+        memcpy(cabecera.magia, "IOTS", 4);
+        cabecera.version = VERSION;
+        cabecera.tipo = tipo;
+        cabecera.orden = (uint32_t)orden;
+        // Los nombres más largos que la cabecera se guardan truncados
+        size_t largo = strnlen(nombre, sizeof(cabecera.nombre) - 1);
+        memcpy(cabecera.nombre, nombre, largo);
+        cabecera.nombre[largo] = '\0';
+        bytesArchivo = sizeof(cabecera);
+        cabecera.confirmados = (uint64_t)bytesArchivo;
+        if (!escribirCabecera() || lseek(fd, bytesArchivo, SEEK_SET) < 0) {
+            close(fd);
+            fd = -1;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Abre un segmento existente, verifica la cola y lo proyecta en memoria
+     * @param ruta Ruta del archivo
+     * @return false si no es un segmento válido
+     *
+     * Los lotes hasta cabecera.confirmados no se vuelven a verificar. Los
+     * posteriores se verifican uno a uno y el archivo se trunca en el primer
+     * lote incompleto o con CRC incorrecto.
+     */
+    bool recuperar(const char* ruta) {
+        fd = open(ruta, O_RDWR | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(cabecera) ||
+            pread(fd, &cabecera, sizeof(cabecera), 0) != (ssize_t)sizeof(cabecera) ||
+            memcmp(cabecera.magia, "IOTS", 4) != 0 || cabecera.version != VERSION ||
+            (cabecera.tipo != 'i' && cabecera.tipo != 'f')) {
+            if (memcmp(cabecera.magia, "IOTS", 4) == 0 && cabecera.version != VERSION) {
+                REGISTRO_AVISO("Segmento " << ruta << " con formato " << (unsigned long)cabecera.version
+                               << " (se espera " << (unsigned long)VERSION << ")");
+            }
+            close(fd);
+            fd = -1;
+            return false;
+        }
+        cabecera.nombre[sizeof(cabecera.nombre) - 1] = '\0';
+        long long tamanio = info.st_size;
+
+        void* p = mmap(nullptr, tamanio, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            close(fd);
+            fd = -1;
+            return false;
+        }
+        mapa = (const unsigned char*)p;
+        bytesProyectados = tamanio;
+
+        long long pos = (long long)cabecera.confirmados;
+        bool cabeceraValida = cabecera.crc == crcCabecera(cabecera) &&
+                              pos >= (long long)sizeof(cabecera) && pos <= tamanio;
+        if (!cabeceraValida) {
+            REGISTRO_AVISO("Cabecera de " << ruta << " dañada; se verifica el segmento completo"
+                           " y la configuración del sensor vuelve a la inicial");
+            pos = sizeof(cabecera);
+            cabecera.maxLecturas = 0;
+            cabecera.maxSegundos = 0.0;
+            cabecera.opciones = 0;
+        }
+        long lote;
+        while ((lote = verificarLote(mapa, pos, tamanio)) > 0) {
+            pos += lote;
+        }
+        if (pos < tamanio) {
+            bytesTruncados = tamanio - pos;
+            REGISTRO_AVISO("Segmento " << ruta << ": se descartan " << (long)bytesTruncados
+                           << " bytes de cola incompleta");
+            if (ftruncate(fd, pos) != 0) {
+                REGISTRO_ERROR("No se pudo truncar " << ruta);
+            }
+        }
+        bytesArchivo = pos;
+        bytesMapa = pos;
+        lseek(fd, pos, SEEK_SET);
+        if (!cabeceraValida || pos != (long long)cabecera.confirmados) {
+            confirmar();
+        }
+        return true;
+    }
+
+    /**
+     * @brief Indica si quedan lecturas recuperadas sin entregar al sensor
+     */
+    bool tieneMapa() const {
+        return mapa != nullptr && bytesMapa > (long long)sizeof(cabecera);
+    }
+
+    /**
+     * @brief Recorre los lotes recuperados directamente sobre el mapa
+     * @tparam T int o float (según getTipo())
+     * @param f Función f(const T* datos, const int32_t* desfases, long long baseMs, int cantidad);
+     *        la marca monótona de datos[i] es baseMs + desfases[i]
+     *
+     * Los lotes confirmados no se verificaron al recuperar; aquí se verifica
+     * cada uno antes de entregarlo y el recorrido se detiene en el primero dañado.
+     */
+    template <typename T, typename F>
+    void paraCadaLoteMapeado(F f) const {
+        if (mapa == nullptr) return;
+        // Pared -> reloj de los historiales, con un solo cálculo para todo el recorrido
+        long long aMonotono = monotonoDesdeEpocaMs(0);
+        long long pos = sizeof(cabecera);
+        while (pos < bytesMapa) {
+            long bytes = verificarLote(mapa, pos, bytesMapa);
+            if (bytes == 0) {
+                REGISTRO_AVISO("Segmento de " << cabecera.nombre << ": lote dañado en el byte "
+                               << (long)pos << "; se omiten las lecturas siguientes");
+                return;
+            }
+            CabeceraLote c;
+            memcpy(&c, mapa + pos, sizeof(c));
+            const unsigned char* datos = mapa + pos + sizeof(CabeceraLote);
+            f((const T*)datos, (const int32_t*)(datos + c.cantidad * 4), (long long)c.baseMs + aMonotono,
+              (int)c.cantidad);
+            pos += bytes;
+        }
+    }
+
+    /**
+     * @brief Libera la proyección una vez entregadas las lecturas
+     */
+    void liberarMapa() {
+        if (mapa != nullptr) {
+            munmap((void*)mapa, bytesProyectados);
+            mapa = nullptr;
+            bytesMapa = 0;
+        }
+    }
+
+    /**
+     * @brief Agrega una lectura de 4 bytes al lote pendiente
+     * @param valor Puntero a la lectura (int o float)
+     * @param marcaMs Milisegundos monótonos de la lectura (los del historial)
+     *
+     * Una marca a más de INT_MAX ms de la primera del lote abre un lote nuevo.
+     */
+    void anexar(const void* valor, long long marcaMs) {
+        long long desfase = marcaMs - baseLote;
+        if (enLote == LECTURAS_POR_LOTE || (enLote > 0 && (desfase > INT_MAX || desfase < INT_MIN))) {
+            // Lote lleno cuyo volcado falló (se reintenta una vez) o marca fuera del alcance del lote
+            volcar();
+            if (enLote > 0) {
+                lecturasPerdidas += enLote;
+                REGISTRO_ERROR("Segmento de " << cabecera.nombre << ": se descartan " << enLote
+                               << " lecturas que no se pudieron escribir");
+                enLote = 0;
+            }
+        }
+        if (enLote == 0) {
+            baseLote = marcaMs;
+        }
+        memcpy(lote + sizeof(CabeceraLote) + enLote * 4, valor, 4);
+        desfases[enLote] = (int32_t)(marcaMs - baseLote);
+        enLote++;
+        if (enLote == LECTURAS_POR_LOTE) {
+            volcar();
+        }
+    }
+
+    /**
+     * @brief Escribe el lote pendiente en el archivo (sin sincronizar)
+     *
+     * Cada BYTES_SIN_CONFIRMAR bytes escritos se confirma el segmento, así
+     * la cola que habrá que verificar tras una caída está acotada. Si la
+     * escritura falla o queda corta (disco lleno) el archivo se trunca al
+     * último lote completo y el lote sigue pendiente para el próximo intento.
+     */
+    void volcar() {
+        if (fd < 0 || enLote == 0) return;
+        CabeceraLote c;
+        c.cantidad = (uint32_t)enLote;
+        c.crc = 0;
+        c.baseMs = (int64_t)epocaDesdeMonotonoMs(baseLote);
+        memcpy(lote, &c, sizeof(c));
+        // Los desfases siguen a las lecturas; la copia de desfases[] sigue valiendo si la escritura falla
+        memcpy(lote + sizeof(CabeceraLote) + enLote * 4, desfases, (size_t)enLote * 4);
+        long bytes = (long)sizeof(CabeceraLote) + (long)enLote * 8;
+        c.crc = crcLote(lote, bytes);
+        memcpy(lote + offsetof(CabeceraLote, crc), &c.crc, sizeof(c.crc));
+        if (!escribirTodo(lote, bytes)) {
+            REGISTRO_ERROR("No se pudo escribir el segmento de " << cabecera.nombre);
+            // Un lote a medias haría que la recuperación descarte todo lo posterior
+            if (ftruncate(fd, bytesArchivo) != 0 || lseek(fd, bytesArchivo, SEEK_SET) < 0) {
+                REGISTRO_ERROR("No se pudo truncar el segmento de " << cabecera.nombre);
+            }
+            return;
+        }
+        enLote = 0;
+        bytesArchivo += bytes;
+        if (bytesArchivo - (long long)cabecera.confirmados >= BYTES_SIN_CONFIRMAR) {
+            confirmar();
+        }
+    }
+
+    /**
+     * @brief Vuelca lo pendiente, sincroniza los datos y actualiza la cabecera
+     *
+     * Los lotes llegan al disco antes que la cabecera que los declara
+     * confirmados; si la cabecera queda a medias su CRC no coincide y la
+     * recuperación verifica el archivo completo.
+     */
+    void confirmar() {
+        if (fd < 0) return;
+        volcar();
+        if ((long long)cabecera.confirmados == bytesArchivo) return;
+        fdatasync(fd);
+        cabecera.confirmados = (uint64_t)bytesArchivo;
+        if (!escribirCabecera()) {
+            REGISTRO_ERROR("No se pudo actualizar la cabecera de " << cabecera.nombre);
+        }
+    }
+
+    /**
+     * @brief Guarda en la cabecera la configuración del sensor y la sincroniza
+     * @param lecturas Retención en lecturas (0 = sin límite)
+     * @param segundos Retención en segundos (0 = sin límite)
+     * @param opciones Combinación de OpcionSegmento
+     */
+    void guardarConfiguracion(int lecturas, double segundos, uint32_t opciones) {
+        if (fd < 0) return;
+        if (cabecera.maxLecturas == lecturas && cabecera.maxSegundos == segundos &&
+            cabecera.opciones == opciones) {
+            return;
+        }
+        cabecera.maxLecturas = lecturas;
+        cabecera.maxSegundos = segundos;
+        cabecera.opciones = opciones;
+        if (!escribirCabecera() || fdatasync(fd) != 0) {
+            REGISTRO_ERROR("No se pudo guardar la configuración de " << cabecera.nombre);
+        }
+    }
+
+    /**
+     * @brief Retención en lecturas guardada en la cabecera
+     */
+    int getMaxLecturas() const {
+        return cabecera.maxLecturas > 0 ? cabecera.maxLecturas : 0;
+    }
+
+    /**
+     * @brief Retención en segundos guardada en la cabecera
+     */
+    double getMaxSegundos() const {
+        return cabecera.maxSegundos > 0.0 ? cabecera.maxSegundos : 0.0;
+    }
+
+    /**
+     * @brief Combinación de OpcionSegmento guardada en la cabecera
+     */
+    uint32_t getOpciones() const {
+        return cabecera.opciones;
+    }
+
+    /**
+     * @brief Nombre del sensor guardado en la cabecera
+     */
+    const char* getNombre() const {
+        return cabecera.nombre;
+    }
+
+    /**
+     * @brief Tipo de lectura ('i' o 'f')
+     */
+    char getTipo() const {
+        return cabecera.tipo;
+    }
+
+    /**
+     * @brief Posición de registro del sensor al crear el segmento
+     */
+    int getOrden() const {
+        return (int)cabecera.orden;
+    }
+
+    /**
+     * @brief Bytes de cola incompleta descartados al recuperar
+     */
+    long long getBytesTruncados() const {
+        return bytesTruncados;
+    }
+
+    /**
+     * @brief Lecturas descartadas porque su lote no se pudo escribir
+     */
+    long getLecturasPerdidas() const {
+        return lecturasPerdidas;
+    }
+
+    /**
+     * @brief Bytes válidos del archivo, incluido lo ya escrito en esta sesión
+     */
+    long long getBytesArchivo() const {
+        return bytesArchivo;
+    }
+};
+
+#endif // SEGMENTOSENSOR_H
@@ -8,7 +8,63 @@
 #ifndef SENSORBASE_H
 #define SENSORBASE_H
 
+#include "SegmentoSensor.h"
+#include "Metricas.h"
+#include "AcumuladorLecturas.h"
+#include "BosquejoCuantiles.h"
+#include "ListaSensor.h"
+#include "SerieComprimida.h"
+#include "ResumenesTiempo.h"
+#include "Registro.h"
+#include <iostream>
 #include <cstring>
+#include <cstdlib>
+
+/**
+ * @struct ResultadoProceso
+ * @brief Resultado de procesar el historial de un sensor, sin imprimir nada
+ *
+ * Permite procesar los sensores en paralelo y mostrar después los
+ * resultados en orden (ListaGestion::procesarTodosParalelo).
+ */
+struct ResultadoProceso {
+    int lecturas;         ///< Lecturas que había al procesar (0 = historial vacío)
+    bool eliminoMinimo;   ///< true si se descartó la lectura más baja
+    double minimo;        ///< Lectura descartada (si eliminoMinimo)
+    double promedio;      ///< Promedio de las lecturas restantes
+};
+
+/**
+ * @struct ResumenSensor
+ * @brief Estado de un sensor copiado en un instante
+ *
+ * Se obtiene en O(1) (salvo que haya que recalcular los extremos), así que
+ * quien lo pide retiene el sensor muy poco y lo imprime después
+ * (GestionConcurrente::imprimirTodos).
+ */
+struct ResumenSensor {
+    int lecturas;         ///< Lecturas en el historial
+    double promedio;      ///< Promedio (con la misma truncación que procesar())
+    double minimo;        ///< Menor lectura (0 si no hay lecturas)
+    double maximo;        ///< Mayor lectura (0 si no hay lecturas)
+    long descartadas;     ///< Lecturas quitadas por la retención
+    long bytesHistorial;  ///< Memoria del historial
+    bool comprimido;      ///< true si el historial está comprimido
+};
+
+/**
+ * @struct ResumenVentana
+ * @brief Agregados de las lecturas de un sensor en un intervalo de tiempo
+ */
+struct ResumenVentana {
+    long lecturas;        ///< Lecturas con marca dentro del intervalo
+    double promedio;      ///< Promedio exacto (sin truncar) de esas lecturas
+    double minimo;        ///< Menor lectura (0 si no hay lecturas)
+    double maximo;        ///< Mayor lectura (0 si no hay lecturas)
+    long long primeraMs;  ///< Marca de la primera lectura del intervalo
+    long long ultimaMs;   ///< Marca de la última lectura del intervalo
+    long long resolucionMs; ///< 0 = exacto; si no, ancho de la cubeta de resumen que sobresale del intervalo
+};
 
 /**
  * @class SensorBase
@@ -21,13 +77,58 @@
 class SensorBase {
 protected:
     char nombre[50]; ///< Identificador único del sensor
+    SegmentoSensor* segmento; ///< Archivo donde se persisten las lecturas (nullptr = sin persistencia)
+    mutable MetricasSensor metricas; ///< Contadores e histogramas (también se actualizan desde métodos const)
+    mutable BosquejoCuantiles cuantiles; ///< Percentiles de todas las lecturas recibidas (también las recuperadas en diferido)
+    
+    /**
+     * @brief Indica si un texto es un número completo (con espacios finales opcionales)
+     * @param texto Valor recibido como texto
+     * 
+     * Un texto que no lo es se cuenta como fallo de análisis y no se guarda:
+     * atof/atoi lo convertirían en un 0 que falsearía promedios y mínimos.
+     */
+    static bool textoNumerico(const char* texto) {
+        char* fin;
+        strtod(texto, &fin);
+        if (fin == texto) return false;
+        while (*fin == ' ' || *fin == '\t' || *fin == '\r' || *fin == '\n') fin++;
+        return *fin == '\0';
+    }
+    
+    /**
+     * @brief Pasa los agregados de ListaSensor, SerieComprimida o ResumenesTiempo a un ResumenVentana
+     * @param v Agregados del intervalo
+     * @param resolucionMs Resolución informada por ResumenesTiempo::consultar() (0 = exacto)
+     */
+    template <typename T>
+    static ResumenVentana resumirVentana(const VentanaLecturas<T>& v, long long resolucionMs = 0) {
+        ResumenVentana r;
+        r.lecturas = v.cantidad;
+        r.promedio = v.media();
+        r.minimo = (double)v.minimo;
+        r.maximo = (double)v.maximo;
+        r.primeraMs = v.primera;
+        r.ultimaMs = v.ultima;
+        r.resolucionMs = resolucionMs;
+        return r;
+    }
+    
+    /**
+     * @brief Marca con que se guarda una lectura
+     * @param marcaMs Marca recibida con la lectura (0 = ninguna)
+     * @return marcaMs, o el instante de ingesta si la lectura no trae marca
+     */
+    static long long marcaLectura(long long marcaMs) {
+        return marcaMs > 0 ? marcaMs : instanteIngestaMs();
+    }
     
 public:
     /**
      * @brief Constructor que inicializa el nombre del sensor
      * @param nom Nombre identificador del sensor
      */
-    SensorBase(const char* nom) {
+    SensorBase(const char* nom) : segmento(nullptr) {
         strncpy(nombre, nom, 49);
         nombre[49] = '\0';
     }
@@ -35,7 +136,9 @@ public:
     /**
      * @brief Destructor virtual para garantizar correcta liberación polimórfica
      */
-    virtual ~SensorBase() {}
+    virtual ~SensorBase() {
+        delete segmento;
+    }
     
     /**
      * @brief Método virtual puro para procesar lecturas del sensor
@@ -44,6 +147,20 @@ public:
      */
     virtual void procesarLectura() = 0;
     
+    /**
+     * @brief Método virtual puro que procesa las lecturas sin escribir en consola
+     * @return Resultado del procesamiento
+     * 
+     * Debe poder llamarse desde cualquier hilo: solo toca el historial propio.
+     */
+    virtual ResultadoProceso procesar() = 0;
+    
+    /**
+     * @brief Método virtual puro que imprime un resultado de procesar()
+     * @param r Resultado a mostrar
+     */
+    virtual void imprimirResultado(const ResultadoProceso& r) const = 0;
+    
     /**
      * @brief Método virtual puro para imprimir información del sensor
      * 
@@ -51,12 +168,149 @@ public:
      */
     virtual void imprimirInfo() const = 0;
     
+    /**
+     * @brief Método virtual puro que copia el estado actual del sensor
+     * @return Resumen con conteo, promedio y extremos
+     */
+    virtual ResumenSensor resumir() const = 0;
+    
+    /**
+     * @brief Método virtual puro que resume las lecturas de un intervalo de tiempo
+     * @param desdeMs Inicio en milisegundos monótonos (inclusive; ver monotonoDesdeEpocaMs())
+     * @param hastaMs Final en milisegundos monótonos (inclusive)
+     * @return Conteo, promedio y extremos de las lecturas del intervalo
+     * 
+     * Cuesta O(log bloques) más las lecturas del intervalo.
+     */
+    virtual ResumenVentana consultarVentana(long long desdeMs, long long hastaMs) const = 0;
+    
+    /**
+     * @brief Método virtual puro que resume un intervalo desde los resúmenes por tiempo
+     * @param desdeMs Inicio en milisegundos monótonos (inclusive)
+     * @param hastaMs Final en milisegundos monótonos (inclusive)
+     * @return Agregados de todas las lecturas recibidas en el intervalo,
+     *         incluidas las que el historial ya descartó; resolucionMs indica
+     *         si los bordes se redondearon a cubetas completas
+     * 
+     * Sin activarResumenes() equivale a consultarVentana().
+     */
+    virtual ResumenVentana consultarResumen(long long desdeMs, long long hastaMs) const = 0;
+    
     /**
      * @brief Método virtual puro para agregar una lectura desde string
      * @param valor String que contiene el valor a agregar
      */
     virtual void agregarLectura(const char* valor) = 0;
     
+    /**
+     * @brief Método virtual puro para agregar una lectura ya decodificada como entero
+     * @param valor Valor recibido (p. ej. de una trama binaria)
+     * @param marcaMs Milisegundos monótonos de la lectura (0 = instante de ingesta)
+     */
+    virtual void agregarEntero(int valor, long long marcaMs = 0) = 0;
+    
+    /**
+     * @brief Método virtual puro para agregar una lectura ya decodificada como flotante
+     * @param valor Valor recibido (p. ej. de una trama binaria)
+     * @param marcaMs Milisegundos monótonos de la lectura (0 = instante de ingesta)
+     */
+    virtual void agregarFlotante(float valor, long long marcaMs = 0) = 0;
+    
+    /**
+     * @brief Método virtual puro para limitar el historial a una ventana reciente
+     * @param lecturas Máximo de lecturas retenidas (0 = sin límite)
+     * @param segundos Antigüedad máxima de las lecturas (0 = sin límite)
+     */
+    virtual void establecerRetencion(int lecturas, double segundos) = 0;
+    
+    /**
+     * @brief Método virtual puro para pasar el historial a almacenamiento comprimido
+     * 
+     * Las lecturas existentes se comprimen y las siguientes se agregan a la
+     * serie comprimida (SerieComprimida.h). Es irreversible.
+     */
+    virtual void activarCompresion() = 0;
+    
+    /**
+     * @brief Método virtual puro que empieza a mantener resúmenes por segundo, minuto, hora y día
+     * 
+     * Las lecturas del historial se incorporan al activarlos; desde entonces
+     * cada lectura nueva actualiza los cuatro niveles en O(1) (ResumenesTiempo.h).
+     * Combinado con una retención corta, el historial crudo expira y los
+     * resúmenes se conservan.
+     */
+    virtual void activarResumenes() = 0;
+    
+    /**
+     * @brief Método virtual puro que indica el tipo de lectura
+     * @return 'i' (int) o 'f' (float), los mismos códigos que ProtocoloBinario
+     */
+    virtual char getTipo() const = 0;
+    
+    /**
+     * @brief Método virtual puro con la magnitud y el tipo para mostrar (p. ej. "Temperatura - FLOAT")
+     */
+    virtual const char* getDescripcion() const = 0;
+    
+    /**
+     * @brief Imprime el nombre y un resumen copiado con resumir()
+     * @param r Resumen del sensor (puede haberse tomado antes, con el sensor retenido)
+     * 
+     * Solo lee el nombre y la descripción, que no cambian, así que puede
+     * llamarse sin retener el sensor (GestionConcurrente::imprimirTodos).
+     */
+    void imprimirResumen(const ResumenSensor& r) const {
+        std::cout << "  Sensor: " << nombre << " (" << getDescripcion() << ")" << std::endl;
+        std::cout << "  Lecturas almacenadas: " << r.lecturas
+                  << (r.comprimido ? " (comprimido)" : "") << std::endl;
+        if (r.lecturas > 0) {
+            std::cout << "  Promedio: " << r.promedio << ", mínimo: " << r.minimo
+                      << ", máximo: " << r.maximo << std::endl;
+        }
+        if (r.descartadas > 0) {
+            std::cout << "  Descartadas por retención: " << r.descartadas << std::endl;
+        }
+        std::cout << "  Memoria del historial: " << r.bytesHistorial << " bytes" << std::endl;
+    }
+    
+    /**
+     * @brief Asocia el archivo de segmento del sensor (el sensor pasa a ser su dueño)
+     * @param s Segmento creado o recuperado por AlmacenPersistente
+     * 
+     * Si el segmento trae lecturas recuperadas, el sensor las incorpora la
+     * primera vez que se usa su historial.
+     */
+    void adjuntarSegmento(SegmentoSensor* s) {
+        delete segmento;
+        segmento = s;
+    }
+    
+    /**
+     * @brief Obtiene el segmento de persistencia
+     * @return Segmento o nullptr si el sensor no se persiste
+     */
+    SegmentoSensor* getSegmento() const {
+        return segmento;
+    }
+    
+    /**
+     * @brief Métricas de ejecución del sensor (legibles desde cualquier hilo)
+     */
+    MetricasSensor& getMetricas() const {
+        return metricas;
+    }
+    
+    /**
+     * @brief Bosquejo de cuantiles de todas las lecturas recibidas
+     * 
+     * No lo afectan la retención ni procesar(): resume el flujo completo.
+     * Se actualiza junto con el historial, así que se lee con las mismas
+     * precauciones (p. ej. con el candado del sensor en GestionConcurrente).
+     */
+    const BosquejoCuantiles& getCuantiles() const {
+        return cuantiles;
+    }
+    
     /**
      * @brief Obtiene el nombre del sensor
      * @return Puntero al nombre del sensor
@@ -66,4 +320,297 @@ public:
     }
 };
 
+/**
+ * @class SensorHistorial
+ * @brief Historial, compresión, resúmenes y persistencia comunes a los sensores de un tipo
+ * @tparam T Tipo de lectura (float, int)
+ * 
+ * Las clases concretas solo deciden cómo se interpreta una lectura
+ * (agregarLectura, agregarEntero, agregarFlotante) y qué hace procesar();
+ * ambas terminan en guardarLectura() y procesarHistorial().
+ */
+template <typename T>
+class SensorHistorial : public SensorBase {
+protected:
+    mutable ListaSensor<T, LECTURAS_POR_BLOQUE> historial; ///< Lecturas (se completa en diferido desde el segmento)
+    SerieComprimida<T>* comprimido; ///< Historial comprimido (nullptr mientras se use historial)
+    ResumenesTiempo<T>* resumenes;  ///< Cubetas por segundo, minuto, hora y día (nullptr = desactivados)
+    
+    /**
+     * @brief Guarda una lectura ya validada en el segmento, el historial, los resúmenes y el bosquejo
+     * @param valor Lectura
+     * @param marcaMs Milisegundos monótonos de la lectura (0 = instante de ingesta)
+     */
+    void guardarLectura(T valor, long long marcaMs) {
+        long long inicio = metricas.inicioMuestra();
+        cargarPersistidas();
+        long long marca = marcaLectura(marcaMs);
+        if (segmento != nullptr) {
+            segmento->anexar(&valor, marca);
+        }
+        if (comprimido != nullptr) {
+            comprimido->insertar(valor, marca);
+        } else {
+            historial.insertar(valor, marca);
+        }
+        if (resumenes != nullptr) {
+            resumenes->agregar(valor, marca);
+        }
+        cuantiles.agregar(valor);
+        metricas.registrarLectura(inicio);
+        actualizarBytes();
+        REGISTRO_DEPURACION("ID: " << nombre << ". Valor: " << valor << " (" << getDescripcion() << ")");
+    }
+    
+    /**
+     * @brief Aplica la retención y calcula el promedio, quitando antes el mínimo si se pide
+     * @param quitarMinimo true para eliminar la lectura más baja (si hay más de una)
+     * @return Resultado sin imprimir
+     */
+    ResultadoProceso procesarHistorial(bool quitarMinimo) {
+        CronometroLatencia cronometro(metricas.duracionProceso);
+        cargarPersistidas();
+        ResultadoProceso r = comprimido != nullptr ? procesarSerie(*comprimido, quitarMinimo)
+                                                   : procesarSerie(historial, quitarMinimo);
+        actualizarBytes();
+        return r;
+    }
+    
+public:
+    /**
+     * @brief Constructor
+     * @param nom Nombre identificador del sensor
+     */
+    SensorHistorial(const char* nom) : SensorBase(nom), comprimido(nullptr), resumenes(nullptr) {}
+    
+    /**
+     * @brief Destructor que libera la serie comprimida y los resúmenes
+     */
+    ~SensorHistorial() {
+        delete comprimido;
+        delete resumenes;
+    }
+    
+    SensorHistorial(const SensorHistorial&) = delete;
+    SensorHistorial& operator=(const SensorHistorial&) = delete;
+    
+    /**
+     * @brief Limita el historial a las últimas lecturas
+     * @param lecturas Máximo de lecturas retenidas (0 = sin límite)
+     * @param segundos Antigüedad máxima de las lecturas (0 = sin límite)
+     */
+    void establecerRetencion(int lecturas, double segundos) override {
+        cargarPersistidas();
+        if (comprimido != nullptr) {
+            comprimido->establecerRetencion(lecturas, segundos);
+        } else {
+            historial.establecerRetencion(lecturas, segundos);
+        }
+        guardarConfiguracion();
+    }
+    
+    /**
+     * @brief Comprime el historial; el índice de orden deja de usarse
+     * 
+     * Las lecturas suelen variar poco entre sí, así que la mayoría ocupa uno
+     * o dos bytes en lugar de cuatro más el nodo. eliminarMinimo sobre la
+     * serie comprimida localiza el bloque por su resumen y solo descomprime
+     * ese bloque.
+     */
+    void activarCompresion() override {
+        if (comprimido != nullptr) return;
+        cargarPersistidas();
+        comprimido = new SerieComprimida<T>();
+        SerieComprimida<T>* destino = comprimido;
+        historial.paraCadaLectura([destino](T valor, long long marca) {
+            destino->insertar(valor, marca);
+        });
+        comprimido->establecerRetencion(historial.getMaxLecturas(), historial.getMaxSegundos());
+        actualizarBytes();
+        historial.desactivarIndice();
+        historial.vaciar();
+        guardarConfiguracion();
+    }
+    
+    /**
+     * @brief Empieza a mantener los resúmenes por tiempo con las lecturas ya guardadas
+     */
+    void activarResumenes() override {
+        if (resumenes != nullptr) return;
+        cargarPersistidas();
+        resumenes = new ResumenesTiempo<T>();
+        ResumenesTiempo<T>* destino = resumenes;
+        auto agregar = [destino](T valor, long long marca) {
+            destino->agregar(valor, marca);
+        };
+        if (comprimido != nullptr) {
+            comprimido->paraCadaLectura(agregar);
+        } else {
+            historial.paraCadaLectura(agregar);
+        }
+        guardarConfiguracion();
+    }
+    
+    /**
+     * @brief Imprime el resumen del sensor, su configuración y sus lecturas
+     */
+    void imprimirInfo() const override {
+        imprimirResumen(resumir());
+        if (resumenes != nullptr) {
+            long long ultima = resumenes->getUltimaMarca();
+            ResumenVentana hora = consultarResumen(ultima - 3599999, ultima);
+            std::cout << "  Resúmenes (1 s, 1 min, 1 h, 1 día): " << resumenes->memoriaBytes()
+                      << " bytes; última hora: " << hora.lecturas << " lecturas, promedio "
+                      << hora.promedio << ", mínimo " << hora.minimo << ", máximo " << hora.maximo << std::endl;
+        }
+        if (comprimido != nullptr) {
+            imprimirRetencion(*comprimido);
+            std::cout << "  Compresión: " << comprimido->bytesPorLectura() << " bytes/lectura en "
+                      << comprimido->getNumBloques() << " bloques sellados" << std::endl;
+            comprimido->imprimir();
+            return;
+        }
+        imprimirRetencion(historial);
+        EstadisticasArena mem = historial.estadisticasMemoria();
+        std::cout << "  Arena: " << mem.bloques << " bloques (" << mem.nodosVivos
+                  << " nodos vivos, fragmentación " << mem.fragmentacion * 100.0 << "%)" << std::endl;
+        historial.imprimir();
+    }
+    
+    /**
+     * @brief Copia conteo, promedio y extremos del historial
+     * @return Resumen del sensor
+     */
+    ResumenSensor resumir() const override {
+        cargarPersistidas();
+        if (comprimido != nullptr) {
+            return resumirSerie(*comprimido, comprimido->memoriaBytes(), true);
+        }
+        return resumirSerie(historial, historial.estadisticasMemoria().bytesReservados, false);
+    }
+    
+    /**
+     * @brief Resume las lecturas con marca en [desdeMs, hastaMs]
+     * @return Conteo, promedio y extremos del intervalo
+     */
+    ResumenVentana consultarVentana(long long desdeMs, long long hastaMs) const override {
+        cargarPersistidas();
+        if (comprimido != nullptr) {
+            return resumirVentana(comprimido->consultarVentana(desdeMs, hastaMs));
+        }
+        return resumirVentana(historial.consultarVentana(desdeMs, hastaMs));
+    }
+    
+    /**
+     * @brief Resume [desdeMs, hastaMs] con el nivel más grueso de los resúmenes que encaje
+     * @return Agregados de las lecturas recibidas en el intervalo (consultarVentana() si no hay resúmenes)
+     */
+    ResumenVentana consultarResumen(long long desdeMs, long long hastaMs) const override {
+        if (resumenes == nullptr) {
+            return consultarVentana(desdeMs, hastaMs);
+        }
+        long long resolucion;
+        VentanaLecturas<T> v = resumenes->consultar(desdeMs, hastaMs, &resolucion);
+        return resumirVentana(v, resolucion);
+    }
+    
+private:
+    /**
+     * @brief Incorpora al historial las lecturas recuperadas del segmento
+     * 
+     * Se hace en diferido, la primera vez que se usa el historial, para que
+     * restaurar los sensores al arrancar no dependa del total de lecturas.
+     * Cada lectura conserva la marca con que se guardó, así que las ventanas
+     * y los resúmenes anteriores al reinicio siguen siendo correctos.
+     */
+    void cargarPersistidas() const {
+        if (segmento == nullptr || !segmento->tieneMapa()) return;
+        segmento->paraCadaLoteMapeado<T>([this](const T* d, const int32_t* desfases, long long base, int n) {
+            for (int i = 0; i < n; i++) {
+                long long marca = base + desfases[i];
+                if (comprimido != nullptr) {
+                    comprimido->insertar(d[i], marca);
+                } else {
+                    historial.insertar(d[i], marca);
+                }
+                if (resumenes != nullptr) {
+                    resumenes->agregar(d[i], marca);
+                }
+                cuantiles.agregar(d[i]);
+            }
+        });
+        segmento->liberarMapa();
+        actualizarBytes();
+    }
+    
+    /**
+     * @brief Copia la retención, la compresión y los resúmenes a la cabecera del segmento
+     */
+    void guardarConfiguracion() {
+        if (segmento == nullptr) return;
+        uint32_t opciones = (comprimido != nullptr ? SEGMENTO_COMPRIMIDO : 0) |
+                            (resumenes != nullptr ? SEGMENTO_RESUMENES : 0);
+        if (comprimido != nullptr) {
+            segmento->guardarConfiguracion(comprimido->getMaxLecturas(), comprimido->getMaxSegundos(), opciones);
+        } else {
+            segmento->guardarConfiguracion(historial.getMaxLecturas(), historial.getMaxSegundos(), opciones);
+        }
+    }
+    
+    /**
+     * @brief Publica en las métricas la memoria actual del historial
+     */
+    void actualizarBytes() const {
+        if (comprimido != nullptr) {
+            metricas.establecerBytesHistorial(comprimido->memoriaBytes());
+        } else {
+            metricas.establecerBytesHistorial(historial.estadisticasMemoria().bytesReservados);
+        }
+    }
+    
+    /**
+     * @brief Procesamiento común a la lista y a la serie comprimida
+     */
+    template <typename Serie>
+    static ResultadoProceso procesarSerie(Serie& serie, bool quitarMinimo) {
+        serie.aplicarRetencion();
+        ResultadoProceso r = {serie.getTamanio(), false, 0.0, 0.0};
+        if (quitarMinimo && r.lecturas > 1) {
+            r.minimo = serie.eliminarMinimo();
+            r.eliminoMinimo = true;
+        }
+        if (r.lecturas > 0) {
+            r.promedio = serie.calcularPromedio();
+        }
+        return r;
+    }
+    
+    /**
+     * @brief Resumen común a la lista y a la serie comprimida
+     */
+    template <typename Serie>
+    static ResumenSensor resumirSerie(const Serie& serie, long bytes, bool enSerie) {
+        ResumenSensor r;
+        r.lecturas = serie.getTamanio();
+        r.promedio = serie.calcularPromedio();
+        r.minimo = serie.obtenerMinimo();
+        r.maximo = serie.obtenerMaximo();
+        r.descartadas = serie.getDescartadas();
+        r.bytesHistorial = bytes;
+        r.comprimido = enSerie;
+        return r;
+    }
+    
+    /**
+     * @brief Imprime la retención configurada en la lista o en la serie comprimida
+     */
+    template <typename Serie>
+    static void imprimirRetencion(const Serie& serie) {
+        if (serie.getMaxLecturas() > 0 || serie.getMaxSegundos() > 0.0) {
+            std::cout << "  Retención: " << serie.getMaxLecturas() << " lecturas, "
+                      << serie.getMaxSegundos() << " s (0 = sin límite)" << std::endl;
+        }
+    }
+};
+
 #endif // SENSORBASE_H
\ No newline at end of file
@@ -9,7 +9,7 @@
 #define SENSORPRESION_H
 
 #include "SensorBase.h"
-#include "ListaSensor.h"
+#include "Registro.h"
 #include <iostream>
 #include <cstdlib>
 
@@ -20,34 +20,79 @@
  * Implementa la funcionalidad específica para sensores de presión,
  * procesando lecturas de tipo int y calculando promedios.
  */
-class SensorPresion : public SensorBase {
-private:
-    ListaSensor<int> historial; ///< Lista genérica para almacenar lecturas int
-    
+class SensorPresion : public SensorHistorial<int> {
 public:
     /**
      * @brief Constructor del sensor de presión
      * @param nom Nombre identificador del sensor
      */
-    SensorPresion(const char* nom) : SensorBase(nom) {
-        std::cout << " Sensor de Presión '" << nombre << "' creado." << std::endl;
+    SensorPresion(const char* nom) : SensorHistorial<int>(nom) {
+        REGISTRO_INFO("Sensor de Presión '" << nombre << "' creado.");
     }
     
     /**
      * @brief Destructor que libera la lista interna
      */
     ~SensorPresion() {
-        std::cout << "Liberando Lista Interna del sensor" << nombre  << std::endl;
+        REGISTRO_DEPURACION("Liberando Lista Interna del sensor " << nombre);
+    }
+    
+    SensorPresion(const SensorPresion&) = delete;
+    SensorPresion& operator=(const SensorPresion&) = delete;
+    
+    /**
+     * @brief Tipo de lectura del sensor
+     * @return 'i'
+     */
+    char getTipo() const override {
+        return 'i';
+    }
+    
+    /**
+     * @brief Magnitud y tipo para mostrar
+     */
+    const char* getDescripcion() const override {
+        return "Presión - INT";
     }
     
     /**
      * @brief Agrega una lectura de presión a la lista
      * @param valor String con el valor de presión
+     * 
+     * Un texto no numérico se descarta y cuenta como fallo de análisis.
      */
     void agregarLectura(const char* valor) override {
-        int presion = atoi(valor);
-        historial.insertar(presion);
-        std::cout << "ID: " << nombre << ". Valor: " << presion << " (int)" << std::endl;
+        if (!textoNumerico(valor)) {
+            metricas.registrarFalloAnalisis();
+            return;
+        }
+        agregarEntero(atoi(valor));
+    }
+    
+    /**
+     * @brief Agrega una lectura de presión ya decodificada
+     * @param valor Presión en enteros
+     * @param marcaMs Milisegundos monótonos de la lectura (0 = instante de ingesta)
+     */
+    void agregarEntero(int valor, long long marcaMs = 0) override {
+        guardarLectura(valor, marcaMs);
+    }
+    
+    /**
+     * @brief Agrega una lectura flotante truncándola a entero (como atoi)
+     * @param valor Presión en punto flotante
+     * @param marcaMs Milisegundos monótonos de la lectura (0 = instante de ingesta)
+     * 
+     * NaN, infinitos y valores fuera del rango de int se descartan y cuentan
+     * como fallo de análisis.
+     */
+    void agregarFlotante(float valor, long long marcaMs = 0) override {
+        // Convertir NaN, infinitos o valores fuera de rango a int no está definido
+        if (!(valor > -2147483648.0f && valor < 2147483648.0f)) {
+            metricas.registrarFalloAnalisis();
+            return;
+        }
+        agregarEntero((int)valor, marcaMs);
     }
     
     /**
@@ -57,29 +102,36 @@ public:
      * de todas las lecturas almacenadas.
      */
     void procesarLectura() override {
+        imprimirResultado(procesar());
+    }
+    
+    /**
+     * @brief Calcula el promedio de las lecturas
+     * @return Resultado sin imprimir
+     */
+    ResultadoProceso procesar() override {
+        return procesarHistorial(false);
+    }
+    
+    /**
+     * @brief Imprime el resultado con el formato de presión
+     * @param r Resultado de procesar()
+     */
+    void imprimirResultado(const ResultadoProceso& r) const override {
         std::cout << "-> Procesando Sensor " << nombre << "..." << std::endl;
         
-        if (historial.estaVacia()) {
+        if (r.lecturas == 0) {
             std::cout << "No hay lecturas para procesar." << std::endl;
             return;
         }
         
-        int promedio = historial.calcularPromedio();
+        int promedio = (int)r.promedio;
         std::cout << "[" << nombre << "] (Presion): Promedio de lecturas: " 
                   << promedio << "." << std::endl;
         std::cout << "Promedio calculado sobre " 
-                  << historial.getTamanio() << " lecturas (" 
+                  << r.lecturas << " lecturas (" 
                   << promedio << ")." << std::endl;
     }
-    
-    /**
-     * @brief Imprime información del sensor y sus lecturas
-     */
-    void imprimirInfo() const override {
-        std::cout << "  Sensor: " << nombre << " (Presión - INT)" << std::endl;
-        std::cout << "  Lecturas almacenadas: " << historial.getTamanio() << std::endl;
-        historial.imprimir();
-    }
 };
 
-#endif // SENSORPRESION_H
\ No newline at end of file
+#endif // SENSORPRESION_H
@@ -9,9 +9,10 @@
 #define SENSORTEMPERATURA_H
 
 #include "SensorBase.h"
-#include "ListaSensor.h"
+#include "Registro.h"
 #include <iostream>
 #include <cstdlib>
+#include <cmath>
 
 /**
  * @class SensorTemperatura
@@ -21,34 +22,81 @@
  * procesando lecturas de tipo float y calculando promedios tras eliminar
  * el valor más bajo.
  */
-class SensorTemperatura : public SensorBase {
-private:
-    ListaSensor<float> historial; ///< Lista genérica para almacenar lecturas float
-    
+class SensorTemperatura : public SensorHistorial<float> {
 public:
     /**
      * @brief Constructor del sensor de temperatura
      * @param nom Nombre identificador del sensor
      */
-    SensorTemperatura(const char* nom) : SensorBase(nom) {
-        std::cout << "Sensor de Temperatura '" << nombre << "' creado." << std::endl;
+    SensorTemperatura(const char* nom) : SensorHistorial<float>(nom) {
+        // procesarLectura() elimina el mínimo en cada pasada: índice O(log n)
+        historial.activarIndice();
+        REGISTRO_INFO("Sensor de Temperatura '" << nombre << "' creado.");
     }
     
     /**
      * @brief Destructor que libera la lista interna
      */
     ~SensorTemperatura() {
-        std::cout << "  [Destructor Sensor " << nombre << "] Liberando Lista Interna..." << std::endl;
+        REGISTRO_DEPURACION("  [Destructor Sensor " << nombre << "] Liberando Lista Interna...");
+    }
+    
+    SensorTemperatura(const SensorTemperatura&) = delete;
+    SensorTemperatura& operator=(const SensorTemperatura&) = delete;
+    
+    /**
+     * @brief Tipo de lectura del sensor
+     * @return 'f'
+     */
+    char getTipo() const override {
+        return 'f';
+    }
+    
+    /**
+     * @brief Magnitud y tipo para mostrar
+     */
+    const char* getDescripcion() const override {
+        return "Temperatura - FLOAT";
     }
     
     /**
      * @brief Agrega una lectura de temperatura a la lista
      * @param valor String con el valor de temperatura
+     * 
+     * Los textos no numéricos, "nan", "inf" y los valores fuera del rango
+     * de float se descartan y cuentan como fallo de análisis.
      */
     void agregarLectura(const char* valor) override {
-        float temp = atof(valor);
-        historial.insertar(temp);
-        std::cout << "ID: " << nombre << ". Valor: " << temp << " (float)" << std::endl;
+        if (!textoNumerico(valor)) {
+            metricas.registrarFalloAnalisis();
+            return;
+        }
+        agregarFlotante((float)atof(valor));
+    }
+    
+    /**
+     * @brief Agrega una lectura de temperatura ya decodificada
+     * @param valor Temperatura en punto flotante
+     * @param marcaMs Milisegundos monótonos de la lectura (0 = instante de ingesta)
+     * 
+     * NaN e infinitos se descartan y cuentan como fallo de análisis.
+     */
+    void agregarFlotante(float valor, long long marcaMs = 0) override {
+        // NaN no tiene orden: rompería el índice de orden y eliminarMinimo
+        if (!std::isfinite(valor)) {
+            metricas.registrarFalloAnalisis();
+            return;
+        }
+        guardarLectura(valor, marcaMs);
+    }
+    
+    /**
+     * @brief Agrega una lectura entera convirtiéndola a flotante
+     * @param valor Temperatura en enteros
+     * @param marcaMs Milisegundos monótonos de la lectura (0 = instante de ingesta)
+     */
+    void agregarEntero(int valor, long long marcaMs = 0) override {
+        agregarFlotante((float)valor, marcaMs);
     }
     
     /**
@@ -58,31 +106,32 @@ public:
      * más baja y calcula el promedio de las restantes.
      */
     void procesarLectura() override {
+        imprimirResultado(procesar());
+    }
+    
+    /**
+     * @brief Elimina el mínimo (si hay más de una lectura) y calcula el promedio
+     * @return Resultado sin imprimir
+     */
+    ResultadoProceso procesar() override {
+        return procesarHistorial(true);
+    }
+    
+    /**
+     * @brief Imprime el resultado con el formato de temperatura
+     * @param r Resultado de procesar()
+     */
+    void imprimirResultado(const ResultadoProceso& r) const override {
         std::cout << "-> Procesando Sensor " << nombre << "..." << std::endl;
         
-        if (historial.estaVacia()) {
+        if (r.lecturas == 0) {
             std::cout << "No hay lecturas para procesar." << std::endl;
-            return;
-        }
-        
-        if (historial.getTamanio() > 1) {
-            float minimo = historial.eliminarMinimo();
-            float promedio = historial.calcularPromedio();
-            std::cout << "[" << nombre << "] (Temperatura): Lectura más baja ("<< minimo << ") eliminada. Promedio restante: " << promedio << "." << std::endl;
+        } else if (r.eliminoMinimo) {
+            std::cout << "[" << nombre << "] (Temperatura): Lectura más baja ("<< (float)r.minimo << ") eliminada. Promedio restante: " << (float)r.promedio << "." << std::endl;
         } else {
-            float promedio = historial.calcularPromedio();
-            std::cout << "Promedio calculado sobre 1 lectura (" << promedio << ")." << std::endl;
+            std::cout << "Promedio calculado sobre 1 lectura (" << (float)r.promedio << ")." << std::endl;
         }
     }
-    
-    /**
-     * @brief Imprime información del sensor y sus lecturas
-     */
-    void imprimirInfo() const override {
-        std::cout << "  Sensor: " << nombre << " (Temperatura - FLOAT)" << std::endl;
-        std::cout << "  Lecturas almacenadas: " << historial.getTamanio() << std::endl;
-        historial.imprimir();
-    }
 };
 
-#endif // SENSORTEMPERATURA_H
\ No newline at end of file
+#endif // SENSORTEMPERATURA_H
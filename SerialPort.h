@@ -0,0 +1,459 @@
+/**
+ * @file SerialPort.h
+ * @brief Lector de puerto serial con búfer circular, poll y tiempo de espera
+ * @author Eliezer Mores Oyervides
+ * @date 2025
+ */
+
+#ifndef SERIALPORT_H
+#define SERIALPORT_H
+
+#include "Registro.h"
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+
+// Para comunicación serial en Linux
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <poll.h>
+
+/**
+ * @class SerialPort
+ * @brief Clase para manejar la comunicación con el puerto serial en Linux
+ *
+ * El descriptor se usa en modo no bloqueante: cada read() trae todo lo
+ * disponible (hasta el espacio libre del búfer circular) y las líneas se
+ * separan en espacio de usuario. Cuando no hay una línea completa se espera
+ * con poll() hasta el tiempo límite configurado en lugar de girar en vacío.
+ *
+ * También puede construirse sobre un descriptor ya abierto, por ejemplo el
+ * extremo esclavo de un pseudo-terminal creado con openpty(), que sustituye
+ * al Arduino en pruebas y mediciones.
+ */
+class SerialPort {
+private:
+    static const int CAPACIDAD = 1 << 16; ///< Bytes del búfer circular (potencia de dos)
+
+    int fd;              ///< File descriptor del puerto serial
+    bool conectado;      ///< Estado de la conexión
+    bool propio;         ///< true si el destructor debe cerrar fd
+    bool bloqueante;     ///< Descriptor ajeno dejado en modo bloqueante: se consulta poll() antes de cada read()
+    bool restaurar;      ///< true si el destructor debe devolver banderas y terminal a su estado original
+    bool terminalGuardada; ///< true si terminalOriginal tiene la configuración previa
+    int banderasOriginales; ///< fcntl(F_GETFL) antes de construir
+    struct termios terminalOriginal; ///< tcgetattr() antes de construir
+    int timeoutMs;       ///< Espera máxima de leerLinea() (-1 = indefinida)
+    char* buffer;        ///< Búfer circular de recepción
+    unsigned long inicio; ///< Posición absoluta del primer byte sin consumir
+    unsigned long fin;    ///< Posición absoluta siguiente al último byte recibido
+    unsigned long busqueda; ///< Bytes ya revisados sin encontrar '\n' desde inicio
+
+    long bytesLeidos;    ///< Bytes recibidos desde la apertura
+    long lineasLeidas;   ///< Líneas entregadas desde la apertura
+    long llamadasRead;   ///< Llamadas a read() que devolvieron datos
+    std::chrono::steady_clock::time_point apertura; ///< Instante de apertura
+
+    /**
+     * @brief Configura el terminal en modo raw 8N1 a 9600 baudios
+     * @return true si la configuración se aplicó
+     */
+    bool configurar() {
+        struct termios tty;
+        memset(&tty, 0, sizeof(tty));
+
+        // Obtener configuración actual
+        if (tcgetattr(fd, &tty) != 0) {
+            return false;
+        }
+
+        // Configurar velocidad (9600 baud)
+        cfsetospeed(&tty, B9600);
+        cfsetispeed(&tty, B9600);
+
+        // Configurar 8N1 (8 bits, sin paridad, 1 bit de parada)
+        tty.c_cflag &= ~PARENB;        // Sin paridad
+        tty.c_cflag &= ~CSTOPB;        // 1 bit de parada
+        tty.c_cflag &= ~CSIZE;
+        tty.c_cflag |= CS8;            // 8 bits por byte
+        tty.c_cflag &= ~CRTSCTS;       // Sin control de flujo hardware
+        tty.c_cflag |= CREAD | CLOCAL; // Activar lectura, ignorar líneas de control
+
+        // Configurar modo raw (sin procesamiento)
+        tty.c_lflag &= ~ICANON;        // Modo no canónico
+        tty.c_lflag &= ~ECHO;          // Sin eco
+        tty.c_lflag &= ~ISIG;          // Sin señales
+        tty.c_cc[VMIN] = 1;            // read() sin datos: EAGAIN (no 0) en modo no bloqueante
+        tty.c_cc[VTIME] = 0;
+
+        // Desactivar control de flujo software
+        tty.c_iflag &= ~(IXON | IXOFF | IXANY);
+        tty.c_iflag &= ~(IGNBRK|BRKINT|PARMRK|ISTRIP|INLCR|IGNCR|ICRNL);
+
+        // Configurar modo de salida raw
+        tty.c_oflag &= ~OPOST;
+        tty.c_oflag &= ~ONLCR;
+
+        // Aplicar configuración
+        return tcsetattr(fd, TCSANOW, &tty) == 0;
+    }
+
+    /**
+     * @brief Inicializa búfer y contadores una vez abierto el descriptor
+     */
+    void iniciarBuffer() {
+        buffer = new char[CAPACIDAD];
+        inicio = fin = busqueda = 0;
+        bytesLeidos = lineasLeidas = llamadasRead = 0;
+        apertura = std::chrono::steady_clock::now();
+    }
+
+public:
+    /**
+     * @brief Constructor - Inicializa el puerto serial
+     * @param puerto Nombre del puerto (ej: "/dev/ttyACM0" o "/dev/ttyUSB0")
+     * @param timeout Espera máxima en ms de leerLinea() (-1 = indefinida)
+     * @param esperarReinicio true para esperar 2 s a que el Arduino se reinicie
+     */
+    SerialPort(const char* puerto, int timeout = 1000, bool esperarReinicio = true)
+        : fd(-1), conectado(false), propio(true), bloqueante(false), restaurar(false),
+          terminalGuardada(false), banderasOriginales(0), timeoutMs(timeout), buffer(nullptr) {
+        // Abrir el puerto serial
+        fd = open(puerto, O_RDWR | O_NOCTTY | O_NONBLOCK);
+
+        if (fd != -1) {
+            if (configurar()) {
+                conectado = true;
+                iniciarBuffer();
+                REGISTRO_INFO("Conectado al puerto " << puerto);
+                if (esperarReinicio) {
+                    sleep(2); // Esperar que Arduino se reinicie
+                }
+            } else {
+                REGISTRO_ERROR("No se pudo configurar el puerto " << puerto);
+                close(fd);
+                fd = -1;
+            }
+        } else {
+            REGISTRO_ERROR("No se pudo abrir el puerto " << puerto);
+            REGISTRO_INFO("Verifica:");
+            REGISTRO_INFO("  1. Que el Arduino esté conectado");
+            REGISTRO_INFO("  2. Que tengas permisos: sudo chmod 666 " << puerto);
+            REGISTRO_INFO("  3. O que estés en el grupo dialout: sudo usermod -a -G dialout $USER");
+        }
+    }
+
+    /**
+     * @brief Constructor sobre un descriptor ya abierto (p. ej. esclavo de openpty)
+     * @param descriptor Descriptor a leer
+     * @param cerrarAlFinal true si el destructor debe cerrar el descriptor
+     * @param timeout Espera máxima en ms de leerLinea() (-1 = indefinida)
+     * @param configurarTerminal true para pasarlo a no bloqueante y, si es una
+     *        terminal, a modo raw 8N1 (un dispositivo serial). Con false
+     *        (stdin, archivos) el descriptor no se modifica y cada read() va
+     *        precedido de un poll() sin espera.
+     *
+     * Las banderas y la configuración de terminal previas se restauran en el
+     * destructor: el descriptor puede compartir descripción de archivo con
+     * stdout/stderr o con la terminal del usuario.
+     */
+    SerialPort(int descriptor, bool cerrarAlFinal, int timeout = 1000, bool configurarTerminal = true)
+        : fd(descriptor), conectado(false), propio(cerrarAlFinal), bloqueante(!configurarTerminal),
+          restaurar(false), terminalGuardada(false), banderasOriginales(0), timeoutMs(timeout),
+          buffer(nullptr) {
+        if (fd >= 0) {
+            if (configurarTerminal) {
+                banderasOriginales = fcntl(fd, F_GETFL);
+                terminalGuardada = tcgetattr(fd, &terminalOriginal) == 0;
+                restaurar = banderasOriginales >= 0;
+                fcntl(fd, F_SETFL, banderasOriginales | O_NONBLOCK);
+                configurar(); // Un descriptor que no es terminal se acepta tal cual
+            }
+            conectado = true;
+            iniciarBuffer();
+        }
+    }
+
+    /**
+     * @brief Destructor - Restaura el descriptor ajeno y cierra el puerto serial
+     */
+    ~SerialPort() {
+        if (fd >= 0 && restaurar) {
+            if (terminalGuardada) {
+                tcsetattr(fd, TCSANOW, &terminalOriginal);
+            }
+            fcntl(fd, F_SETFL, banderasOriginales);
+        }
+        if (fd >= 0 && propio) {
+            close(fd);
+            REGISTRO_INFO("Puerto cerrado.");
+        }
+        delete[] buffer;
+    }
+
+    SerialPort(const SerialPort&) = delete;
+    SerialPort& operator=(const SerialPort&) = delete;
+
+    /**
+     * @brief Lee del descriptor todo lo disponible sin bloquear
+     * @return Bytes leídos (0 si no había datos o el búfer está lleno)
+     *
+     * Si el otro extremo cerró o hubo un error el puerto pasa a desconectado.
+     */
+    long llenarBuffer() {
+        if (!conectado) return 0;
+        long total = 0;
+        while (fin - inicio < (unsigned long)CAPACIDAD) {
+            unsigned long pos = fin & (CAPACIDAD - 1);
+            unsigned long libre = CAPACIDAD - (fin - inicio);
+            unsigned long hastaBorde = CAPACIDAD - pos;
+            if (bloqueante) {
+                struct pollfd pfd;
+                pfd.fd = fd;
+                pfd.events = POLLIN;
+                pfd.revents = 0;
+                if (poll(&pfd, 1, 0) <= 0) break;
+            }
+            ssize_t n = read(fd, buffer + pos, libre < hastaBorde ? libre : hastaBorde);
+            if (n > 0) {
+                fin += n;
+                total += n;
+                bytesLeidos += n;
+                llamadasRead++;
+            } else if (n == 0) {
+                conectado = false; // Fin de archivo: el otro extremo se cerró
+                break;
+            } else {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    conectado = false; // EIO al colgar un pty, desconexión USB, etc.
+                }
+                break;
+            }
+        }
+        return total;
+    }
+
+    /**
+     * @brief Extrae una línea completa del búfer, sin tocar el descriptor
+     * @param destino Buffer donde almacenar la línea (sin '\r' ni '\n')
+     * @param maxLen Tamaño máximo del buffer
+     * @return true si había una línea completa; false si aún no llega el '\n'
+     *
+     * Una línea más larga que maxLen - 1 se trunca y el resto se descarta.
+     */
+    bool extraerLinea(char* destino, int maxLen) {
+        // Buscar '\n' solo en los bytes aún no revisados
+        unsigned long p = inicio + busqueda;
+        while (p < fin) {
+            unsigned long pos = p & (CAPACIDAD - 1);
+            unsigned long tramo = fin - p;
+            if (tramo > CAPACIDAD - pos) tramo = CAPACIDAD - pos;
+            const char* salto = static_cast<const char*>(memchr(buffer + pos, '\n', tramo));
+            if (salto != nullptr) {
+                p += salto - (buffer + pos);
+                break;
+            }
+            p += tramo;
+        }
+        if (p >= fin) {
+            busqueda = fin - inicio;
+            // Búfer lleno sin '\n': entregar lo acumulado como línea truncada
+            if (fin - inicio < (unsigned long)CAPACIDAD) return false;
+        }
+
+        int len = 0;
+        for (unsigned long q = inicio; q < p; q++) {
+            char c = buffer[q & (CAPACIDAD - 1)];
+            if (c != '\r' && len < maxLen - 1) {
+                destino[len++] = c;
+            }
+        }
+        destino[len] = '\0';
+        inicio = p < fin ? p + 1 : p;
+        busqueda = 0;
+        lineasLeidas++;
+        return true;
+    }
+
+    /**
+     * @brief Lee una línea del puerto serial
+     * @param buffer Buffer donde almacenar los datos
+     * @param maxLen Tamaño máximo del buffer
+     * @return true si se leyó una línea; false si venció el tiempo límite o se perdió la conexión
+     */
+    bool leerLinea(char* buffer, int maxLen) {
+        if (extraerLinea(buffer, maxLen)) return true;
+
+        auto limite = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (conectado) {
+            int espera = timeoutMs;
+            if (timeoutMs >= 0) {
+                auto resta = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    limite - std::chrono::steady_clock::now()).count();
+                espera = resta > 0 ? (int)resta : 0;
+            }
+
+            struct pollfd pfd;
+            pfd.fd = fd;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+            int listo = poll(&pfd, 1, espera);
+            if (listo < 0 && errno != EINTR) {
+                conectado = false;
+                break;
+            }
+            if (listo > 0) {
+                llenarBuffer();
+                if (extraerLinea(buffer, maxLen)) return true;
+            } else if (espera == 0) {
+                break; // Tiempo agotado
+            }
+        }
+        return extraerLinea(buffer, maxLen);
+    }
+
+    /**
+     * @brief Espera con poll() a que lleguen datos y los pasa al búfer
+     * @return Bytes leídos (0 si venció el tiempo límite o se perdió la conexión)
+     */
+    long esperarDatos() {
+        if (!conectado) return 0;
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        int listo = poll(&pfd, 1, timeoutMs);
+        if (listo < 0 && errno != EINTR) {
+            conectado = false;
+            return 0;
+        }
+        return listo > 0 ? llenarBuffer() : 0;
+    }
+
+    /**
+     * @brief Envía bytes al dispositivo (p. ej. comandos de cambio de modo)
+     * @param datos Bytes a enviar
+     * @param n Número de bytes
+     * @return true si se enviaron todos antes del tiempo límite
+     */
+    bool escribir(const char* datos, long n) {
+        long enviados = 0;
+        while (conectado && enviados < n) {
+            ssize_t w = write(fd, datos + enviados, n - enviados);
+            if (w > 0) {
+                enviados += w;
+            } else if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+                struct pollfd pfd;
+                pfd.fd = fd;
+                pfd.events = POLLOUT;
+                pfd.revents = 0;
+                if (poll(&pfd, 1, timeoutMs) <= 0) return false;
+            } else {
+                conectado = false;
+            }
+        }
+        return enviados == n;
+    }
+
+    /**
+     * @brief Bytes recibidos aún sin consumir
+     */
+    long disponibles() const {
+        return (long)(fin - inicio);
+    }
+
+    /**
+     * @brief Consulta un byte pendiente sin consumirlo
+     * @param i Desplazamiento desde el primer byte sin consumir (< disponibles())
+     */
+    unsigned char byteEn(long i) const {
+        return (unsigned char)buffer[(inicio + i) & (CAPACIDAD - 1)];
+    }
+
+    /**
+     * @brief Tramo contiguo de bytes pendientes a partir del primero sin consumir
+     * @param n Recibe la longitud del tramo (hasta el borde del búfer circular)
+     * @return Puntero al primer byte pendiente
+     */
+    const unsigned char* contiguo(long& n) const {
+        unsigned long pos = inicio & (CAPACIDAD - 1);
+        n = (long)(fin - inicio);
+        if (n > (long)(CAPACIDAD - pos)) n = (long)(CAPACIDAD - pos);
+        return reinterpret_cast<const unsigned char*>(buffer + pos);
+    }
+
+    /**
+     * @brief Marca como consumidos los primeros n bytes pendientes
+     * @param n Bytes a consumir (<= disponibles())
+     */
+    void consumir(long n) {
+        inicio += n;
+        busqueda = 0;
+    }
+
+    /**
+     * @brief Cambia la espera máxima de leerLinea()
+     * @param ms Milisegundos (-1 = indefinida, 0 = no esperar)
+     */
+    void establecerTimeout(int ms) {
+        timeoutMs = ms;
+    }
+
+    /**
+     * @brief Descriptor del puerto (para registrarlo en poll/epoll externos)
+     * @return File descriptor o -1
+     */
+    int descriptor() const {
+        return fd;
+    }
+
+    /**
+     * @brief Verifica si está conectado
+     * @return true si está conectado
+     */
+    bool estaConectado() const {
+        return conectado;
+    }
+
+    /**
+     * @brief Bytes recibidos desde la apertura
+     */
+    long getBytesLeidos() const {
+        return bytesLeidos;
+    }
+
+    /**
+     * @brief Líneas entregadas desde la apertura
+     */
+    long getLineasLeidas() const {
+        return lineasLeidas;
+    }
+
+    /**
+     * @brief Llamadas a read() que devolvieron datos
+     */
+    long getLlamadasRead() const {
+        return llamadasRead;
+    }
+
+    /**
+     * @brief Tasa media de bytes recibidos desde la apertura
+     * @return Bytes por segundo
+     */
+    double bytesPorSegundo() const {
+        double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - apertura).count();
+        return s > 0.0 ? bytesLeidos / s : 0.0;
+    }
+
+    /**
+     * @brief Tasa media de líneas entregadas desde la apertura
+     * @return Líneas por segundo
+     */
+    double lineasPorSegundo() const {
+        double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - apertura).count();
+        return s > 0.0 ? lineasLeidas / s : 0.0;
+    }
+};
+
+#endif // SERIALPORT_H
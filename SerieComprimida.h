@@ -0,0 +1,788 @@
+/**
+ * @file SerieComprimida.h
+ * @brief Historial comprimido por bloques sellados (delta-de-delta para enteros, XOR para flotantes)
+ * @author Eliezer Mores Oyervides
+ * @date 2025
+ *
+ * Las lecturas llegan a una cola sin comprimir de LECTURAS_POR_SELLO
+ * posiciones. Cuando se llena se codifica en un bloque sellado de bytes:
+ * - int: primer valor, primera diferencia y luego diferencias de las
+ *   diferencias, todas en zigzag + varint (1 byte si la señal cambia
+ *   a ritmo constante).
+ * - float: codificación tipo Gorilla: XOR con la lectura anterior, 1 bit si
+ *   se repite y solo los bits significativos del XOR si no.
+ *
+ * Tras los valores, cada bloque guarda las marcas de tiempo de sus lecturas
+ * con delta-de-delta de ancho variable (CodecMarcas): un solo bit por
+ * lectura si llegan a ritmo constante.
+ *
+ * Cada bloque guarda además su mínimo, máximo, suma y primera y última
+ * marca, y los agregados se llevan en un AcumuladorLecturas, así que
+ * promedio y extremos no requieren descomprimir, y una consulta por
+ * intervalo de tiempo solo descomprime los bloques de los bordes. Los
+ * recorridos (imprimir, kernels) descomprimen un bloque a la vez en un
+ * búfer local.
+ */
+
+#ifndef SERIECOMPRIMIDA_H
+#define SERIECOMPRIMIDA_H
+
+#include "AcumuladorLecturas.h"
+#include "KernelesSimd.h"
+#include "Metricas.h"
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <climits>
+#include <type_traits>
+
+/**
+ * @brief Lecturas por bloque sellado
+ */
+const int LECTURAS_POR_SELLO = 512;
+
+/**
+ * @class EscritorBits
+ * @brief Escribe campos de bits (MSB primero) o varints en un búfer de bytes
+ */
+class EscritorBits {
+private:
+    unsigned char* destino;  ///< Búfer de salida (dimensionado por quien llama)
+    long bytes;              ///< Bytes completos escritos
+    uint64_t acumulado;      ///< Bits pendientes
+    int pendientes;          ///< Número de bits pendientes
+
+public:
+    EscritorBits(unsigned char* d) : destino(d), bytes(0), acumulado(0), pendientes(0) {}
+
+    /**
+     * @brief Escribe los n bits menos significativos de valor (n <= 32)
+     */
+    void bits(uint32_t valor, int n) {
+        if (n == 0) return;
+        acumulado = (acumulado << n) | (n == 32 ? valor : (valor & ((1u << n) - 1)));
+        pendientes += n;
+        while (pendientes >= 8) {
+            pendientes -= 8;
+            destino[bytes++] = (unsigned char)(acumulado >> pendientes);
+        }
+    }
+
+    /**
+     * @brief Escribe un entero sin signo como varint de 7 bits por byte
+     */
+    void varint(uint64_t valor) {
+        while (valor >= 0x80) {
+            destino[bytes++] = (unsigned char)(valor | 0x80);
+            valor >>= 7;
+        }
+        destino[bytes++] = (unsigned char)valor;
+    }
+
+    /**
+     * @brief Completa el último byte con ceros y devuelve el tamaño
+     */
+    long cerrar() {
+        if (pendientes > 0) {
+            destino[bytes++] = (unsigned char)(acumulado << (8 - pendientes));
+            pendientes = 0;
+        }
+        return bytes;
+    }
+};
+
+/**
+ * @class LectorBits
+ * @brief Lee lo que escribió EscritorBits
+ */
+class LectorBits {
+private:
+    const unsigned char* origen;
+    long pos;
+    uint64_t acumulado;
+    int disponibles;
+
+public:
+    LectorBits(const unsigned char* o) : origen(o), pos(0), acumulado(0), disponibles(0) {}
+
+    uint32_t bits(int n) {
+        if (n == 0) return 0;
+        while (disponibles < n) {
+            acumulado = (acumulado << 8) | origen[pos++];
+            disponibles += 8;
+        }
+        disponibles -= n;
+        uint64_t valor = acumulado >> disponibles;
+        return (uint32_t)(n == 32 ? valor : (valor & ((1u << n) - 1)));
+    }
+
+    uint64_t varint() {
+        uint64_t valor = 0;
+        int desplazamiento = 0;
+        while (true) {
+            unsigned char b = origen[pos++];
+            valor |= (uint64_t)(b & 0x7F) << desplazamiento;
+            if (!(b & 0x80)) return valor;
+            desplazamiento += 7;
+        }
+    }
+};
+
+/**
+ * @brief Codificación zigzag: enteros pequeños (positivos o negativos) -> sin signo pequeños
+ */
+inline uint64_t zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+inline int64_t deszigzag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+/**
+ * @brief Codec por tipo de lectura (solo int y float)
+ */
+template <typename T>
+struct CodecSerie;
+
+/**
+ * @brief Delta-de-delta con zigzag + varint para lecturas enteras
+ */
+template <>
+struct CodecSerie<int> {
+    static const int MAX_BYTES_POR_LECTURA = 10;
+
+    static long codificar(const int* d, int n, unsigned char* destino) {
+        EscritorBits w(destino);
+        int64_t previo = 0;
+        int64_t deltaPrevio = 0;
+        for (int i = 0; i < n; i++) {
+            int64_t delta = (int64_t)d[i] - previo;
+            w.varint(zigzag(i == 0 ? d[i] : delta - deltaPrevio));
+            deltaPrevio = i == 0 ? 0 : delta;
+            previo = d[i];
+        }
+        return w.cerrar();
+    }
+
+    static void decodificar(const unsigned char* origen, int n, int* d) {
+        LectorBits r(origen);
+        int64_t previo = 0;
+        int64_t delta = 0;
+        for (int i = 0; i < n; i++) {
+            int64_t v = deszigzag(r.varint());
+            if (i == 0) {
+                previo = v;
+            } else {
+                delta = (i == 1 ? 0 : delta) + v;
+                previo += delta;
+            }
+            d[i] = (int)previo;
+        }
+    }
+};
+
+/**
+ * @brief XOR con la lectura anterior (estilo Gorilla) para lecturas flotantes
+ */
+template <>
+struct CodecSerie<float> {
+    static const int MAX_BYTES_POR_LECTURA = 6;
+
+    static long codificar(const float* d, int n, unsigned char* destino) {
+        EscritorBits w(destino);
+        uint32_t previo = 0;
+        int ceros = -1;    // Ceros iniciales de la ventana vigente (-1 = ninguna)
+        int finales = 0;   // Ceros finales de la ventana vigente
+        for (int i = 0; i < n; i++) {
+            uint32_t actual;
+            memcpy(&actual, &d[i], sizeof(actual));
+            if (i == 0) {
+                w.bits(actual, 32);
+            } else {
+                uint32_t x = actual ^ previo;
+                if (x == 0) {
+                    w.bits(0, 1);
+                } else {
+                    int lz = __builtin_clz(x);
+                    int tz = __builtin_ctz(x);
+                    if (ceros >= 0 && lz >= ceros && tz >= finales) {
+                        w.bits(2, 2);  // '10': cabe en la ventana anterior
+                        w.bits(x >> finales, 32 - ceros - finales);
+                    } else {
+                        int significativos = 32 - lz - tz;
+                        w.bits(3, 2);  // '11': ventana nueva
+                        w.bits((uint32_t)lz, 5);
+                        w.bits((uint32_t)(significativos - 1), 5);
+                        w.bits(x >> tz, significativos);
+                        ceros = lz;
+                        finales = tz;
+                    }
+                }
+            }
+            previo = actual;
+        }
+        return w.cerrar();
+    }
+
+    static void decodificar(const unsigned char* origen, int n, float* d) {
+        LectorBits r(origen);
+        uint32_t previo = 0;
+        int ceros = 0;
+        int finales = 0;
+        for (int i = 0; i < n; i++) {
+            if (i == 0) {
+                previo = r.bits(32);
+            } else if (r.bits(1) == 1) {
+                if (r.bits(1) == 1) {
+                    ceros = (int)r.bits(5);
+                    int significativos = (int)r.bits(5) + 1;
+                    finales = 32 - ceros - significativos;
+                }
+                previo ^= r.bits(32 - ceros - finales) << finales;
+            }
+            memcpy(&d[i], &previo, sizeof(previo));
+        }
+    }
+};
+
+/**
+ * @brief Delta-de-delta de marcas de tiempo con prefijo de longitud (estilo Gorilla)
+ *
+ * La primera marca va completa (64 bits). Para las demás, la diferencia
+ * entre deltas consecutivos, en zigzag, se escribe como '0' si es cero,
+ * '10' + 7 bits, '110' + 12 bits, '1110' + 20 bits o '1111' + 64 bits.
+ */
+struct CodecMarcas {
+    static const int MAX_BYTES_POR_MARCA = 9;
+
+    static long codificar(const long long* t, int n, unsigned char* destino) {
+        EscritorBits w(destino);
+        int64_t deltaPrevio = 0;
+        for (int i = 0; i < n; i++) {
+            uint64_t u;
+            if (i == 0) {
+                u = (uint64_t)t[0];
+            } else {
+                int64_t delta = t[i] - t[i - 1];
+                u = zigzag(delta - deltaPrevio);
+                deltaPrevio = delta;
+            }
+            if (i > 0 && u == 0) {
+                w.bits(0, 1);
+            } else if (i > 0 && u < (1u << 7)) {
+                w.bits(2, 2);
+                w.bits((uint32_t)u, 7);
+            } else if (i > 0 && u < (1u << 12)) {
+                w.bits(6, 3);
+                w.bits((uint32_t)u, 12);
+            } else if (i > 0 && u < (1u << 20)) {
+                w.bits(14, 4);
+                w.bits((uint32_t)u, 20);
+            } else {
+                if (i > 0) w.bits(15, 4);
+                w.bits((uint32_t)(u >> 32), 32);
+                w.bits((uint32_t)u, 32);
+            }
+        }
+        return w.cerrar();
+    }
+
+    static void decodificar(const unsigned char* origen, int n, long long* t) {
+        LectorBits r(origen);
+        int64_t delta = 0;
+        for (int i = 0; i < n; i++) {
+            if (i == 0) {
+                uint64_t alto = r.bits(32);
+                t[0] = (long long)((alto << 32) | r.bits(32));
+                continue;
+            }
+            uint64_t u;
+            if (r.bits(1) == 0) {
+                u = 0;
+            } else if (r.bits(1) == 0) {
+                u = r.bits(7);
+            } else if (r.bits(1) == 0) {
+                u = r.bits(12);
+            } else if (r.bits(1) == 0) {
+                u = r.bits(20);
+            } else {
+                uint64_t alto = r.bits(32);
+                u = (alto << 32) | r.bits(32);
+            }
+            delta += deszigzag(u);
+            t[i] = t[i - 1] + delta;
+        }
+    }
+};
+
+/**
+ * @class SerieComprimida
+ * @brief Historial de lecturas con bloques sellados comprimidos y cola sin comprimir
+ * @tparam T int o float
+ *
+ * Misma semántica que ListaSensor para insertar, promedio, varianza,
+ * extremos, eliminarMinimo, imprimir, retención, marcas de tiempo y
+ * consultarVentana. La retención descarta bloques sellados completos
+ * (granularidad de LECTURAS_POR_SELLO lecturas).
+ */
+template <typename T>
+class SerieComprimida {
+    static_assert(std::is_same<T, int>::value || std::is_same<T, float>::value,
+                  "SerieComprimida solo admite lecturas int o float");
+
+private:
+    typedef typename VentanaLecturas<T>::Ancho Ancho;
+
+    /**
+     * @struct Bloque
+     * @brief Bloque sellado con su resumen
+     */
+    struct Bloque {
+        unsigned char* datos;  ///< Valores codificados seguidos de las marcas codificadas
+        int bytes;             ///< Tamaño de datos
+        int bytesValores;      ///< Bytes de los valores (las marcas empiezan ahí)
+        int cantidad;          ///< Lecturas del bloque
+        T minimo;              ///< Menor lectura
+        T maximo;              ///< Mayor lectura
+        Ancho suma;            ///< Suma de las lecturas
+        long long inicio;      ///< Milisegundos de la primera lectura
+        long long marca;       ///< Milisegundos de la última lectura
+    };
+
+    Bloque* bloques;           ///< Bloques sellados, del más antiguo al más reciente
+    int numBloques;            ///< Bloques en uso
+    int capacidadBloques;      ///< Capacidad del arreglo de bloques
+    long bytesSellados;        ///< Suma de bytes de todos los bloques
+    T cola[LECTURAS_POR_SELLO]; ///< Lecturas aún sin sellar
+    int desfaseCola[LECTURAS_POR_SELLO]; ///< Milisegundos de cada lectura de la cola desde baseCola
+    int enCola;                ///< Lecturas en la cola
+    long long baseCola;        ///< Milisegundos de la primera lectura de la cola
+    long long ultimaMarca;     ///< Marca más reciente (las siguientes no retroceden)
+    int tamanio;               ///< Lecturas totales
+    mutable AcumuladorLecturas<T> acumulador; ///< Agregados incrementales
+    int maxLecturas;           ///< Retención por cantidad (0 = sin límite)
+    long long maxMs;           ///< Retención por antigüedad en ms (0 = sin límite)
+    long descartadas;          ///< Lecturas descartadas por retención
+
+    /**
+     * @brief Reloj monótono grueso en milisegundos (el de ListaSensor)
+     */
+    static long long ahoraMs() {
+        return msHistorial(relojGruesoNs());
+    }
+
+    /**
+     * @brief Codifica n lecturas y sus marcas en un bloque nuevo con su resumen
+     */
+    static Bloque sellar(const T* d, const long long* t, int n) {
+        unsigned char temporal[LECTURAS_POR_SELLO * (CodecSerie<T>::MAX_BYTES_POR_LECTURA +
+                                                     CodecMarcas::MAX_BYTES_POR_MARCA) + 16];
+        Bloque b;
+        b.bytesValores = (int)CodecSerie<T>::codificar(d, n, temporal);
+        b.bytes = b.bytesValores + (int)CodecMarcas::codificar(t, n, temporal + b.bytesValores);
+        b.datos = new unsigned char[b.bytes];
+        memcpy(b.datos, temporal, b.bytes);
+        b.cantidad = n;
+        b.minimo = d[0];
+        b.maximo = d[0];
+        extremosLecturas(d, n, b.minimo, b.maximo);
+        b.suma = (Ancho)sumarLecturas(d, n);
+        b.inicio = t[0];
+        b.marca = t[n - 1];
+        return b;
+    }
+
+    /**
+     * @brief Decodifica valores y marcas de un bloque sellado
+     */
+    static void abrir(const Bloque& b, T* d, long long* t) {
+        CodecSerie<T>::decodificar(b.datos, b.cantidad, d);
+        CodecMarcas::decodificar(b.datos + b.bytesValores, b.cantidad, t);
+    }
+
+    /**
+     * @brief Sella la cola como un bloque nuevo
+     */
+    void sellarCola() {
+        long long marcas[LECTURAS_POR_SELLO];
+        for (int i = 0; i < enCola; i++) {
+            marcas[i] = baseCola + desfaseCola[i];
+        }
+        anexar(sellar(cola, marcas, enCola));
+        enCola = 0;
+    }
+
+    /**
+     * @brief Agrega un bloque al final del arreglo
+     */
+    void anexar(const Bloque& b) {
+        if (numBloques == capacidadBloques) {
+            int nuevaCapacidad = capacidadBloques == 0 ? 8 : capacidadBloques * 2;
+            Bloque* ampliado = new Bloque[nuevaCapacidad];
+            for (int i = 0; i < numBloques; i++) {
+                ampliado[i] = bloques[i];
+            }
+            delete[] bloques;
+            bloques = ampliado;
+            capacidadBloques = nuevaCapacidad;
+        }
+        bloques[numBloques++] = b;
+        bytesSellados += b.bytes;
+    }
+
+    /**
+     * @brief Quita el bloque i del arreglo y libera sus bytes
+     */
+    void quitarBloque(int i) {
+        bytesSellados -= bloques[i].bytes;
+        delete[] bloques[i].datos;
+        for (int j = i + 1; j < numBloques; j++) {
+            bloques[j - 1] = bloques[j];
+        }
+        numBloques--;
+    }
+
+    /**
+     * @brief Descarta el bloque sellado más antiguo por retención
+     */
+    void descartarBloque() {
+        T buffer[LECTURAS_POR_SELLO];
+        CodecSerie<T>::decodificar(bloques[0].datos, bloques[0].cantidad, buffer);
+        for (int i = 0; i < bloques[0].cantidad; i++) {
+            acumulador.quitar(buffer[i]);
+        }
+        tamanio -= bloques[0].cantidad;
+        descartadas += bloques[0].cantidad;
+        quitarBloque(0);
+    }
+
+    /**
+     * @brief Aplica la retención por cantidad y por antigüedad
+     */
+    void retener(long long ahora) {
+        while (maxLecturas > 0 && numBloques > 0 && tamanio - bloques[0].cantidad >= maxLecturas) {
+            descartarBloque();
+        }
+        while (maxMs > 0 && numBloques > 0 && bloques[0].marca < ahora - maxMs) {
+            descartarBloque();
+        }
+    }
+
+    /**
+     * @brief Recalcula mínimo y máximo desde los resúmenes si quedaron invalidados
+     */
+    void recalcularExtremos() const {
+        if (acumulador.extremosAlDia() || tamanio == 0) return;
+        T min = numBloques > 0 ? bloques[0].minimo : cola[0];
+        T max = min;
+        for (int i = 0; i < numBloques; i++) {
+            if (bloques[i].minimo < min) min = bloques[i].minimo;
+            if (max < bloques[i].maximo) max = bloques[i].maximo;
+        }
+        extremosLecturas(cola, enCola, min, max);
+        acumulador.establecerExtremos(min, max);
+    }
+
+public:
+    /**
+     * @brief Constructor (serie vacía)
+     */
+    SerieComprimida() : bloques(nullptr), numBloques(0), capacidadBloques(0), bytesSellados(0), enCola(0), baseCola(0),
+                        ultimaMarca(0), tamanio(0), maxLecturas(0), maxMs(0), descartadas(0) {}
+
+    /**
+     * @brief Destructor - libera los bloques sellados
+     */
+    ~SerieComprimida() {
+        for (int i = 0; i < numBloques; i++) {
+            delete[] bloques[i].datos;
+        }
+        delete[] bloques;
+    }
+
+    SerieComprimida(const SerieComprimida&) = delete;
+    SerieComprimida& operator=(const SerieComprimida&) = delete;
+
+    /**
+     * @brief Agrega una lectura a la cola; sella la cola cuando se llena
+     * @param valor Lectura
+     * @param marcaMs Milisegundos monótonos de la lectura (0 = ahora; no retrocede)
+     */
+    void insertar(T valor, long long marcaMs = 0) {
+        long long ahora = (marcaMs <= 0 || maxMs > 0) ? ahoraMs() : 0;
+        long long marca = marcaMs > 0 ? marcaMs : ahora;
+        if (marca < ultimaMarca) {
+            marca = ultimaMarca;
+        }
+        ultimaMarca = marca;
+        if (enCola == LECTURAS_POR_SELLO || (enCola > 0 && marca - baseCola > INT_MAX)) {
+            sellarCola();
+        }
+        if (enCola == 0) {
+            baseCola = marca;
+        }
+        desfaseCola[enCola] = (int)(marca - baseCola);
+        cola[enCola++] = valor;
+        tamanio++;
+        acumulador.agregar(valor);
+        if (maxLecturas > 0 || maxMs > 0) {
+            retener(ahora);
+        }
+    }
+
+    /**
+     * @brief Promedio en O(1)
+     */
+    T calcularPromedio() const {
+        if (tamanio == 0) return T(0);
+        return (T)(acumulador.getSuma() / tamanio);
+    }
+
+    /**
+     * @brief Varianza poblacional en O(1)
+     */
+    double calcularVarianza() const {
+        return acumulador.varianza();
+    }
+
+    /**
+     * @brief Menor lectura, desde los resúmenes de bloque
+     */
+    T obtenerMinimo() const {
+        if (tamanio == 0) return T(0);
+        recalcularExtremos();
+        return acumulador.getMinimo();
+    }
+
+    /**
+     * @brief Mayor lectura, desde los resúmenes de bloque
+     */
+    T obtenerMaximo() const {
+        if (tamanio == 0) return T(0);
+        recalcularExtremos();
+        return acumulador.getMaximo();
+    }
+
+    /**
+     * @brief Elimina la primera aparición del mínimo
+     * @return Valor eliminado
+     *
+     * Los resúmenes indican qué bloque contiene el mínimo; solo ese bloque se
+     * descomprime y se vuelve a sellar, O(bloques + LECTURAS_POR_SELLO).
+     */
+    T eliminarMinimo() {
+        if (tamanio == 0) return T(0);
+        T minimo = obtenerMinimo();
+        int i = 0;
+        while (i < numBloques && minimo < bloques[i].minimo) {
+            i++;
+        }
+        if (i < numBloques) {
+            T buffer[LECTURAS_POR_SELLO];
+            long long marcas[LECTURAS_POR_SELLO];
+            int n = bloques[i].cantidad;
+            abrir(bloques[i], buffer, marcas);
+            long pos = buscarLectura(buffer, (long)n, minimo);
+            minimo = buffer[pos];   // -0.0 y 0.0 comparan iguales: se devuelve la lectura quitada
+            for (int j = (int)pos + 1; j < n; j++) {
+                buffer[j - 1] = buffer[j];
+                marcas[j - 1] = marcas[j];
+            }
+            n--;
+            if (n == 0) {
+                quitarBloque(i);
+            } else {
+                bytesSellados -= bloques[i].bytes;
+                delete[] bloques[i].datos;
+                bloques[i] = sellar(buffer, marcas, n);
+                bytesSellados += bloques[i].bytes;
+            }
+        } else {
+            long pos = buscarLectura(cola, (long)enCola, minimo);
+            minimo = cola[pos];
+            for (int j = (int)pos + 1; j < enCola; j++) {
+                cola[j - 1] = cola[j];
+                desfaseCola[j - 1] = desfaseCola[j];
+            }
+            enCola--;
+        }
+        tamanio--;
+        acumulador.quitar(minimo);
+        return minimo;
+    }
+
+    /**
+     * @brief Recorre las lecturas en orden, descomprimiendo un bloque a la vez
+     * @param f Función f(const T* datos, int cantidad)
+     */
+    template <typename F>
+    void paraCadaBloque(F f) const {
+        T buffer[LECTURAS_POR_SELLO];
+        for (int i = 0; i < numBloques; i++) {
+            CodecSerie<T>::decodificar(bloques[i].datos, bloques[i].cantidad, buffer);
+            f((const T*)buffer, bloques[i].cantidad);
+        }
+        if (enCola > 0) {
+            f((const T*)cola, enCola);
+        }
+    }
+
+    /**
+     * @brief Recorre las lecturas en orden junto con su marca de tiempo
+     * @param f Función f(T valor, long long marcaMs)
+     */
+    template <typename F>
+    void paraCadaLectura(F f) const {
+        T buffer[LECTURAS_POR_SELLO];
+        long long marcas[LECTURAS_POR_SELLO];
+        for (int b = 0; b < numBloques; b++) {
+            abrir(bloques[b], buffer, marcas);
+            for (int i = 0; i < bloques[b].cantidad; i++) {
+                f(buffer[i], marcas[i]);
+            }
+        }
+        for (int i = 0; i < enCola; i++) {
+            f(cola[i], baseCola + desfaseCola[i]);
+        }
+    }
+
+    /**
+     * @brief Conteo, suma y extremos de las lecturas con marca en [desde, hasta]
+     * @param desde Milisegundos monótonos del inicio (inclusive)
+     * @param hasta Milisegundos monótonos del final (inclusive)
+     * @return Agregados del intervalo
+     *
+     * El arreglo de bloques es el índice: la bisección sobre la última marca
+     * ubica el primer bloque y los que caen enteros dentro se toman de su
+     * resumen sin descomprimir. Solo se decodifican los bloques de los bordes.
+     */
+    VentanaLecturas<T> consultarVentana(long long desde, long long hasta) const {
+        VentanaLecturas<T> v;
+        if (tamanio == 0 || hasta < desde) return v;
+        const Bloque* fin = bloques + numBloques;
+        const Bloque* b = std::lower_bound((const Bloque*)bloques, fin, desde,
+                                           [](const Bloque& x, long long t) { return x.marca < t; });
+        for (; b != fin; ++b) {
+            if (b->inicio > hasta) return v;
+            if (b->inicio >= desde && b->marca <= hasta) {
+                v.agregarTramo(b->cantidad, b->suma, b->minimo, b->maximo, b->inicio, b->marca);
+                continue;
+            }
+            T buffer[LECTURAS_POR_SELLO];
+            long long marcas[LECTURAS_POR_SELLO];
+            abrir(*b, buffer, marcas);
+            for (int i = 0; i < b->cantidad; i++) {
+                if (marcas[i] >= desde && marcas[i] <= hasta) {
+                    v.agregar(buffer[i], marcas[i]);
+                }
+            }
+        }
+        for (int i = 0; i < enCola; i++) {
+            long long t = baseCola + desfaseCola[i];
+            if (t > hasta) break;
+            if (t >= desde) {
+                v.agregar(cola[i], t);
+            }
+        }
+        return v;
+    }
+
+    /**
+     * @brief Cuenta las lecturas mayores que un umbral (descompresión en flujo)
+     */
+    int contarMayoresQue(T umbral) const {
+        long cuenta = 0;
+        paraCadaBloque([&cuenta, umbral](const T* d, int n) { cuenta += contarMayores(d, n, umbral); });
+        return (int)cuenta;
+    }
+
+    /**
+     * @brief Imprime todas las lecturas en orden de inserción
+     */
+    void imprimir() const {
+        std::cout << "    Lecturas: ";
+        paraCadaBloque([](const T* d, int n) {
+            for (int i = 0; i < n; i++) {
+                std::cout << d[i] << " ";
+            }
+        });
+        std::cout << std::endl;
+    }
+
+    /**
+     * @brief Define la ventana retenida (ver ListaSensor::establecerRetencion)
+     * @param lecturas Máximo de lecturas (0 = sin límite)
+     * @param segundos Antigüedad máxima (0 = sin límite)
+     */
+    void establecerRetencion(int lecturas, double segundos) {
+        maxLecturas = lecturas > 0 ? lecturas : 0;
+        maxMs = segundos > 0.0 ? (long long)(segundos * 1000.0) : 0;
+        retener(ahoraMs());
+    }
+
+    /**
+     * @brief Descarta los bloques que superaron la antigüedad máxima
+     */
+    void aplicarRetencion() {
+        if (maxMs > 0) {
+            retener(ahoraMs());
+        }
+    }
+
+    int getMaxLecturas() const {
+        return maxLecturas;
+    }
+
+    double getMaxSegundos() const {
+        return maxMs / 1000.0;
+    }
+
+    long getDescartadas() const {
+        return descartadas;
+    }
+
+    /**
+     * @brief Número de lecturas almacenadas
+     */
+    int getTamanio() const {
+        return tamanio;
+    }
+
+    /**
+     * @brief Número de bloques sellados
+     */
+    int getNumBloques() const {
+        return numBloques;
+    }
+
+    /**
+     * @brief Verifica si la serie está vacía
+     */
+    bool estaVacia() const {
+        return tamanio == 0;
+    }
+
+    /**
+     * @brief Bytes ocupados por la serie (bloques, su arreglo y la cola)
+     */
+    long memoriaBytes() const {
+        return (long)sizeof(*this) + (long)capacidadBloques * (long)sizeof(Bloque) + bytesSellados;
+    }
+
+    /**
+     * @brief Bytes codificados por lectura sellada
+     */
+    double bytesPorLectura() const {
+        long bytes = 0;
+        long lecturas = 0;
+        for (int i = 0; i < numBloques; i++) {
+            bytes += bloques[i].bytes;
+            lecturas += bloques[i].cantidad;
+        }
+        return lecturas > 0 ? (double)bytes / lecturas : 0.0;
+    }
+};
+
+#endif // SERIECOMPRIMIDA_H
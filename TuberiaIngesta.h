@@ -0,0 +1,340 @@
+/**
+ * @file TuberiaIngesta.h
+ * @brief Tubería de dos etapas: un hilo lee el puerto y otro entrega y procesa
+ * @author Eliezer Mores Oyervides
+ * @date 2025
+ *
+ * Con un solo hilo, mientras se procesan los sensores nadie lee el puerto y
+ * el búfer del kernel puede desbordarse. Aquí un hilo lector es dueño del
+ * SerialPort: separa líneas y tramas (DecodificadorTramas::extraer) y las
+ * deja, con su instante de llegada, en una ColaSpsc. El hilo que llama a
+ * ejecutar() las saca del anillo, las entrega a los sensores y, si se pidió,
+ * ejecuta procesarTodos() cada cierto intervalo. El lector nunca toca los
+ * sensores, así que no hacen falta candados sobre la ListaGestion.
+ */
+
+#ifndef TUBERIAINGESTA_H
+#define TUBERIAINGESTA_H
+
+#include "SerialPort.h"
+#include "ListaGestion.h"
+#include "ProtocoloBinario.h"
+#include "EnrutadorLineas.h"
+#include "ColaSpsc.h"
+#include "Metricas.h"
+#include <iostream>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <functional>
+
+/**
+ * @struct UnidadCruda
+ * @brief Línea o trama separada por el lector, aún sin entregar
+ */
+struct UnidadCruda {
+    long long recibido;       ///< relojNs() al leer los bytes del puerto
+    UnidadRecibida tipo;      ///< LINEA_TEXTO o TRAMA_BINARIA
+    char datos[100];          ///< Línea terminada en '\0' o bytes de la trama
+};
+
+/**
+ * @class TuberiaIngesta
+ * @brief Lector serial en su propio hilo unido a la etapa de almacenamiento por un anillo SPSC
+ */
+class TuberiaIngesta {
+private:
+    static const int ESPERA_LECTOR_MS = 50;  ///< Cada cuánto revisa el lector si debe detenerse
+
+    ListaGestion& gestor;            ///< Sensores destino
+    SerialPort* puerto;              ///< Puerto propio (lo usa solo el hilo lector mientras corre)
+    DecodificadorTramas decodificador; ///< extraer() en el lector, entregarTrama() en el consumidor
+    EnrutadorLineas enrutador;       ///< Despacho de líneas "ID:valor"
+    ColaSpsc<UnidadCruda> cola;      ///< Unidades del lector al consumidor
+    std::function<void(const char*)> sinEtiqueta; ///< Destino de las líneas sin "ID:"
+    long long intervaloProcesoNs;    ///< Periodo de procesarTodos() (0 = no procesar)
+    UnidadCruda pendiente;           ///< Unidad ya extraída que no cupo en el anillo al detenerse
+    bool hayPendiente;               ///< pendiente espera ser encolada (solo la toca el lector)
+
+    std::atomic<bool> detener;       ///< Pide al lector que termine
+    std::atomic<bool> lectorTerminado; ///< El lector ya no encolará más
+
+    // Contadores del lector (se leen desde otros hilos)
+    std::atomic<long> encoladas;
+    std::atomic<long> profundidadMaxima;
+    std::atomic<long> estancamientosLector;  ///< Veces que el anillo estaba lleno
+    std::atomic<long long> nsEstancado;      ///< Tiempo total esperando espacio
+
+    // Contadores del consumidor
+    std::atomic<long> entregadas;
+    std::atomic<long> descartadas;
+    std::atomic<long> esperasConsumidor;     ///< Veces que el anillo estaba vacío
+    std::atomic<long> procesamientos;
+    double segundos;                         ///< Tiempo acumulado dentro de ejecutar()
+
+    /**
+     * @brief Encola una unidad; si el anillo está lleno espera a que haya espacio
+     * @return false si se pidió detener mientras esperaba
+     */
+    bool encolar(const UnidadCruda& u) {
+        if (!cola.intentarEncolar(u)) {
+            estancamientosLector++;
+            long long inicio = relojNs();
+            while (!cola.intentarEncolar(u)) {
+                if (detener.load(std::memory_order_acquire)) return false;
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+            nsEstancado += relojNs() - inicio;
+        }
+        encoladas++;
+        long p = cola.profundidad();
+        if (p > profundidadMaxima.load(std::memory_order_relaxed)) {
+            profundidadMaxima.store(p, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Bucle del hilo lector
+     */
+    void leer() {
+        // Lo que se quedó sin encolar en la llamada anterior va primero
+        if (hayPendiente) {
+            if (!encolar(pendiente)) {
+                lectorTerminado.store(true, std::memory_order_release);
+                return;
+            }
+            hayPendiente = false;
+        }
+        UnidadCruda u;
+        while (!detener.load(std::memory_order_acquire) && puerto->estaConectado()) {
+            // Vuelve a lo sumo cada ESPERA_LECTOR_MS para revisar detener
+            puerto->esperarDatos();
+            u.recibido = relojNs();
+            while ((u.tipo = decodificador.extraer(*puerto, u.datos, sizeof(u.datos))) != SIN_DATOS) {
+                if (!encolar(u)) {
+                    // Ya salió del puerto: se guarda para no perderla
+                    pendiente = u;
+                    hayPendiente = true;
+                    break;
+                }
+            }
+        }
+        lectorTerminado.store(true, std::memory_order_release);
+    }
+
+    /**
+     * @brief Entrega una unidad a su sensor (hilo consumidor)
+     */
+    void entregar(UnidadCruda& u) {
+        // La latencia de ingesta incluye la espera en el anillo
+        MarcaRecepcion marca(u.recibido);
+        if (u.tipo == TRAMA_BINARIA) {
+            if (decodificador.entregarTrama(reinterpret_cast<const unsigned char*>(u.datos), gestor)) {
+                entregadas++;
+            } else {
+                descartadas++;
+            }
+            return;
+        }
+        ResultadoRuta ruta = enrutador.enrutar(u.datos);
+        if (ruta == RUTA_ENTREGADA) {
+            entregadas++;
+        } else if (ruta != RUTA_SIN_ETIQUETA) {
+            descartadas++;
+        } else if (sinEtiqueta) {
+            sinEtiqueta(u.datos);
+            entregadas++;
+        } else {
+            descartadas++;
+        }
+    }
+
+public:
+    /**
+     * @brief Constructor
+     * @param g Lista de gestión cuyos sensores reciben las lecturas
+     * @param p Puerto abierto; la tubería lo cierra al destruirse
+     * @param capacidad Unidades que caben en el anillo entre las etapas
+     */
+    TuberiaIngesta(ListaGestion& g, SerialPort* p, int capacidad = 4096)
+        : gestor(g), puerto(p), enrutador(g), cola(capacidad), intervaloProcesoNs(0),
+          hayPendiente(false),
+          detener(false), lectorTerminado(false), encoladas(0), profundidadMaxima(0),
+          estancamientosLector(0), nsEstancado(0), entregadas(0), descartadas(0),
+          esperasConsumidor(0), procesamientos(0), segundos(0.0) {
+        puerto->establecerTimeout(ESPERA_LECTOR_MS);
+    }
+
+    /**
+     * @brief Destructor - Cierra el puerto (las unidades no entregadas se descartan)
+     */
+    ~TuberiaIngesta() {
+        delete puerto;
+    }
+
+    TuberiaIngesta(const TuberiaIngesta&) = delete;
+    TuberiaIngesta& operator=(const TuberiaIngesta&) = delete;
+
+    /**
+     * @brief Define qué hacer con las líneas que no traen "ID:"
+     * @param f Función f(const char* linea), llamada desde el hilo de ejecutar()
+     *
+     * Sin ella esas líneas se cuentan como descartadas.
+     */
+    void establecerSinEtiqueta(std::function<void(const char*)> f) {
+        sinEtiqueta = f;
+    }
+
+    /**
+     * @brief Ejecuta procesarTodos() periódicamente mientras corre la tubería
+     * @param s Segundos entre procesamientos (0 = no procesar)
+     *
+     * El procesamiento ocurre en el hilo consumidor; mientras dura, el lector
+     * sigue leyendo el puerto y acumulando unidades en el anillo.
+     */
+    void establecerIntervaloProceso(double s) {
+        intervaloProcesoNs = s > 0.0 ? (long long)(s * 1e9) : 0;
+    }
+
+    /**
+     * @brief Arranca el lector y entrega unidades hasta reunir un número de ellas
+     * @param objetivo Unidades a entregar (-1 = hasta que el puerto se desconecte)
+     * @return Unidades atendidas en esta llamada (entregadas o descartadas)
+     *
+     * Termina también cuando el puerto se desconecta y el anillo queda vacío.
+     * Al volver, el hilo lector ya se detuvo; lo que quedó en el anillo, y
+     * la unidad que el lector no alcanzó a encolar por tenerlo lleno, se
+     * atienden en la siguiente llamada y en ese orden.
+     */
+    long ejecutar(long objetivo) {
+        detener.store(false, std::memory_order_release);
+        lectorTerminado.store(false, std::memory_order_release);
+        std::thread lector(&TuberiaIngesta::leer, this);
+        auto inicio = std::chrono::steady_clock::now();
+
+        long long proximoProceso = intervaloProcesoNs > 0 ? relojNs() + intervaloProcesoNs : 0;
+        long atendidas = 0;
+        int vacias = 0;
+        UnidadCruda u;
+        while (objetivo < 0 || atendidas < objetivo) {
+            if (cola.intentarDesencolar(u)) {
+                entregar(u);
+                atendidas++;
+                vacias = 0;
+            } else if (lectorTerminado.load(std::memory_order_acquire)) {
+                // El lector publicó todo antes de terminar: un último intento basta
+                if (!cola.intentarDesencolar(u)) break;
+                entregar(u);
+                atendidas++;
+            } else {
+                esperasConsumidor++;
+                if (++vacias < 64) {
+                    std::this_thread::yield();
+                } else {
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                }
+            }
+            if (proximoProceso > 0 && relojNs() >= proximoProceso) {
+                gestor.procesarTodos();
+                procesamientos++;
+                proximoProceso = relojNs() + intervaloProcesoNs;
+            }
+        }
+
+        detener.store(true, std::memory_order_release);
+        lector.join();
+        segundos += std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+        return atendidas;
+    }
+
+    /**
+     * @brief Unidades en el anillo en este momento
+     */
+    long getProfundidad() const {
+        return cola.profundidad();
+    }
+
+    /**
+     * @brief Mayor número de unidades que llegó a acumular el anillo
+     */
+    long getProfundidadMaxima() const {
+        return profundidadMaxima;
+    }
+
+    /**
+     * @brief Veces que el lector encontró el anillo lleno y tuvo que esperar
+     */
+    long getEstancamientosLector() const {
+        return estancamientosLector;
+    }
+
+    /**
+     * @brief Milisegundos que el lector pasó esperando espacio en el anillo
+     */
+    double getMsEstancado() const {
+        return nsEstancado / 1e6;
+    }
+
+    /**
+     * @brief Veces que el consumidor encontró el anillo vacío
+     */
+    long getEsperasConsumidor() const {
+        return esperasConsumidor;
+    }
+
+    /**
+     * @brief Unidades entregadas a un sensor
+     */
+    long getEntregadas() const {
+        return entregadas;
+    }
+
+    /**
+     * @brief Unidades sin sensor destino o con valor inválido
+     */
+    long getDescartadas() const {
+        return descartadas;
+    }
+
+    /**
+     * @brief Veces que se ejecutó procesarTodos()
+     */
+    long getProcesamientos() const {
+        return procesamientos;
+    }
+
+    /**
+     * @brief Puerto de la tubería (no usarlo mientras ejecutar() corre)
+     */
+    const SerialPort& getPuerto() const {
+        return *puerto;
+    }
+
+    /**
+     * @brief Enrutador de líneas etiquetadas (contadores de descartes)
+     */
+    const EnrutadorLineas& getEnrutador() const {
+        return enrutador;
+    }
+
+    /**
+     * @brief Imprime unidades, profundidad del anillo y estancamientos
+     */
+    void imprimirEstadisticas() const {
+        std::cout << "\n--- Estadísticas de la Tubería ---" << std::endl;
+        std::cout << "Unidades: " << encoladas << " leídas, " << entregadas << " entregadas, "
+                  << descartadas << " descartadas (" << (segundos > 0.0 ? entregadas / segundos : 0.0)
+                  << " lecturas/s)" << std::endl;
+        std::cout << "Anillo: " << cola.profundidad() << " pendientes, máximo " << profundidadMaxima
+                  << " de " << cola.capacidad() << std::endl;
+        std::cout << "Lector estancado (anillo lleno): " << estancamientosLector << " veces, "
+                  << getMsEstancado() << " ms" << std::endl;
+        std::cout << "Consumidor sin datos (anillo vacío): " << esperasConsumidor << " veces" << std::endl;
+        if (procesamientos > 0) {
+            std::cout << "Procesamientos periódicos: " << procesamientos << std::endl;
+        }
+    }
+};
+
+#endif // TUBERIAINGESTA_H
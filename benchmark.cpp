@@ -0,0 +1,2001 @@
+/**
+ * @file benchmark.cpp
+ * @brief Mediciones de rendimiento de las estructuras del sistema IoT
+ * @author Eliezer Mores Oyervides
+ * @date 2025
+ *
+ * Programa independiente del menú interactivo. Compilar con:
+ * @code
+ * g++ -std=c++17 -O2 -pthread benchmark.cpp -o benchmark
+ * ./benchmark [seccion] [--csv | --json] [--max=N]
+ * @endcode
+ * Sin argumentos ejecuta todas las secciones.
+ *
+ * La sección "barrido" mide las operaciones principales con tamaños de
+ * 1e2 a 1e7 (o hasta --max). Con --csv o --json sus resultados se emiten
+ * en ese formato y solo se ejecuta el barrido, para comparar corridas y
+ * detectar regresiones.
+ *
+ * La sección "verificacion" compara la serie comprimida con la lista y
+ * recupera segmentos dañados a propósito; si algo no coincide el programa
+ * termina con código 1.
+ */
+
+#include "ListaSensor.h"
+#include "ArenaNodos.h"
+#include "ListaGestion.h"
+#include "GestionTipada.h"
+#include "GestionConcurrente.h"
+#include "SensorPresion.h"
+#include "SensorTemperatura.h"
+#include "SerialPort.h"
+#include "MotorIngesta.h"
+#include "ProtocoloBinario.h"
+#include "EnrutadorLineas.h"
+#include "Registro.h"
+#include "KernelesSimd.h"
+#include "SerieComprimida.h"
+#include "ResumenesTiempo.h"
+#include "AlmacenPersistente.h"
+#include "ExportadorMetricas.h"
+#include "TuberiaIngesta.h"
+#include "ModoLote.h"
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <malloc.h>
+#include <thread>
+#include <pty.h>
+#include <fcntl.h>
+#include <fstream>
+#include <climits>
+#include <cfloat>
+#include <cmath>
+#include <type_traits>
+
+/**
+ * @brief Segundos transcurridos desde un instante de referencia
+ * @param inicio Instante de referencia
+ * @return Segundos en punto flotante
+ */
+double segundosDesde(std::chrono::steady_clock::time_point inicio) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+}
+
+/**
+ * @brief Bytes ocupados actualmente en el heap (según el reservador de glibc)
+ * @return Bytes en uso
+ */
+long bytesEnHeap() {
+    struct mallinfo2 info = mallinfo2();
+    return (long)info.uordblks + (long)info.hblkhd;
+}
+
+/**
+ * @enum FormatoSalida
+ * @brief Formato de las filas del barrido
+ */
+enum FormatoSalida {
+    SALIDA_TEXTO,   ///< Tabla legible
+    SALIDA_CSV,     ///< operacion,tamanio,ns_por_op,operaciones
+    SALIDA_JSON     ///< Arreglo de objetos con los mismos campos
+};
+
+FormatoSalida formatoSalida = SALIDA_TEXTO;  ///< Elegido con --csv / --json
+int filasEmitidas = 0;                       ///< Filas del barrido ya escritas
+
+/**
+ * @brief Escribe una fila de resultado del barrido
+ * @param operacion Operación medida (p. ej. "ListaSensor::insertar")
+ * @param tamanio Tamaño de la estructura (lecturas o sensores)
+ * @param nsPorOp Nanosegundos por llamada a la operación
+ * @param operaciones Llamadas medidas
+ */
+void emitirFila(const char* operacion, long tamanio, double nsPorOp, long operaciones) {
+    if (formatoSalida == SALIDA_CSV) {
+        if (filasEmitidas == 0) printf("operacion,tamanio,ns_por_op,operaciones\n");
+        printf("%s,%ld,%.3f,%ld\n", operacion, tamanio, nsPorOp, operaciones);
+    } else if (formatoSalida == SALIDA_JSON) {
+        printf("%s\n  {\"operacion\": \"%s\", \"tamanio\": %ld, \"ns_por_op\": %.3f, \"operaciones\": %ld}",
+               filasEmitidas == 0 ? "[" : ",", operacion, tamanio, nsPorOp, operaciones);
+    } else {
+        printf("%-36s n=%-9ld %14.2f ns/op  (%ld ops)\n", operacion, tamanio, nsPorOp, operaciones);
+    }
+    filasEmitidas++;
+    fflush(stdout);
+}
+
+/**
+ * @brief Mide memoria por lectura y velocidad de recorrido de una disposición de ListaSensor
+ * @tparam T Tipo de lectura
+ * @tparam N Lecturas por nodo
+ * @param etiqueta Nombre de la disposición medida
+ * @param lecturas Número de lecturas a insertar
+ */
+template <typename T, int N>
+void medirAlmacenamiento(const char* etiqueta, int lecturas) {
+    long heapInicial = bytesEnHeap();
+    ListaSensor<T, N>* lista = new ListaSensor<T, N>();
+
+    auto inicio = std::chrono::steady_clock::now();
+    for (int i = 0; i < lecturas; i++) {
+        lista->insertar(T(i % 1000));
+    }
+    double tInsercion = segundosDesde(inicio);
+    long bytes = bytesEnHeap() - heapInicial;
+
+    // Recorrido completo nodo a nodo (calcularPromedio ya es O(1) y no recorre)
+    const int pasadas = 10;
+    volatile double sumidero = 0.0;
+    inicio = std::chrono::steady_clock::now();
+    for (int p = 0; p < pasadas; p++) {
+        double suma = 0.0;
+        lista->paraCadaBloque([&suma](const T* d, int n) {
+            for (int i = 0; i < n; i++) suma += d[i];
+        });
+        sumidero = sumidero + suma;
+    }
+    double tRecorrido = segundosDesde(inicio);
+
+    printf("%-28s lecturas=%-9d bytes/lectura=%6.2f  insercion=%7.1f Mlect/s  recorrido=%7.1f Mlect/s\n",
+           etiqueta, lecturas, (double)bytes / lecturas,
+           lecturas / tInsercion / 1e6,
+           (double)lecturas * pasadas / tRecorrido / 1e6);
+    delete lista;
+}
+
+/**
+ * @brief Compara la lista clásica (un nodo por lectura) con la lista desenrollada
+ */
+void benchAlmacenamiento() {
+    printf("\n== Almacenamiento: lista clásica vs desenrollada ==\n");
+    int tamanios[] = {1000000, 4000000};
+    for (int t = 0; t < 2; t++) {
+        medirAlmacenamiento<int, 1>("int  N=1", tamanios[t]);
+        medirAlmacenamiento<int, LECTURAS_POR_BLOQUE>("int  N=LECTURAS_POR_BLOQUE", tamanios[t]);
+        medirAlmacenamiento<float, 1>("float N=1", tamanios[t]);
+        medirAlmacenamiento<float, LECTURAS_POR_BLOQUE>("float N=LECTURAS_POR_BLOQUE", tamanios[t]);
+    }
+}
+
+/**
+ * @struct NodoHeap
+ * @brief Nodo equivalente a ListaSensor<int, 1> reservado con new/delete (referencia)
+ */
+struct NodoHeap {
+    int dato;           ///< Valor almacenado
+    NodoHeap* siguiente; ///< Siguiente nodo
+};
+
+/**
+ * @brief Compara la arena de nodos con new/delete por nodo
+ */
+void benchArena() {
+    printf("\n== Reservador: arena por lista vs new/delete por nodo ==\n");
+    const int lecturas = 2000000;
+
+    // Referencia: un new por inserción y un delete por nodo al liberar
+    auto inicio = std::chrono::steady_clock::now();
+    NodoHeap* cabeza = nullptr;
+    NodoHeap* cola = nullptr;
+    for (int i = 0; i < lecturas; i++) {
+        NodoHeap* nuevo = new NodoHeap{i, nullptr};
+        if (cola == nullptr) cabeza = nuevo; else cola->siguiente = nuevo;
+        cola = nuevo;
+    }
+    double tInsercion = segundosDesde(inicio);
+    inicio = std::chrono::steady_clock::now();
+    while (cabeza != nullptr) {
+        NodoHeap* temp = cabeza;
+        cabeza = cabeza->siguiente;
+        delete temp;
+    }
+    double tLiberacion = segundosDesde(inicio);
+    printf("%-28s insercion=%7.1f Mlect/s  liberacion=%8.2f ms\n",
+           "new/delete", lecturas / tInsercion / 1e6, tLiberacion * 1e3);
+
+    // Arena: nodos tallados de bloques grandes, liberación por bloques
+    ArenaNodos<NodoHeap> arena;
+    inicio = std::chrono::steady_clock::now();
+    cabeza = nullptr;
+    cola = nullptr;
+    for (int i = 0; i < lecturas; i++) {
+        NodoHeap* nuevo = arena.crear(NodoHeap{i, nullptr});
+        if (cola == nullptr) cabeza = nuevo; else cola->siguiente = nuevo;
+        cola = nuevo;
+    }
+    tInsercion = segundosDesde(inicio);
+    // Devolver uno de cada mil nodos para observar la fragmentación
+    NodoHeap* actual = cabeza;
+    while (actual != nullptr && actual->siguiente != nullptr) {
+        NodoHeap* victima = actual->siguiente;
+        if (victima->dato % 1000 == 0) {
+            actual->siguiente = victima->siguiente;
+            arena.destruir(victima);
+        }
+        actual = actual->siguiente;
+    }
+    EstadisticasArena e = arena.estadisticas();
+    inicio = std::chrono::steady_clock::now();
+    arena.liberarTodo();
+    tLiberacion = segundosDesde(inicio);
+    printf("%-28s insercion=%7.1f Mlect/s  liberacion=%8.2f ms\n",
+           "ArenaNodos", lecturas / tInsercion / 1e6, tLiberacion * 1e3);
+    printf("  vivos=%ld libres=%ld bloques=%ld bytes=%ld fragmentacion=%.4f\n",
+           e.nodosVivos, e.nodosLibres, e.bloques, e.bytesReservados, e.fragmentacion);
+}
+
+/**
+ * @brief Mide eliminarMinimo y consultas de orden con y sin índice
+ * @param conIndice true para activar el IndiceOrden de la lista
+ */
+void medirIndice(bool conIndice) {
+    const int lecturas = 200000;
+    const int extracciones = 20000;
+    ListaSensor<float, LECTURAS_POR_BLOQUE> lista;
+    if (conIndice) lista.activarIndice();
+    for (int i = 0; i < lecturas; i++) {
+        lista.insertar((float)((i * 7919) % 100000) / 10.0f);
+    }
+
+    volatile float sumidero = 0.0f;
+    auto inicio = std::chrono::steady_clock::now();
+    for (int i = 0; i < extracciones; i++) {
+        sumidero = sumidero + lista.eliminarMinimo();
+    }
+    double tMin = segundosDesde(inicio);
+
+    inicio = std::chrono::steady_clock::now();
+    for (int i = 0; i < 1000; i++) {
+        sumidero = sumidero + lista.obtenerPercentil(i % 100);
+    }
+    double tPercentil = segundosDesde(inicio);
+
+    printf("%-28s eliminarMinimo=%9.2f us/op  percentil=%9.2f us/op\n",
+           conIndice ? "con IndiceOrden" : "sin indice",
+           tMin / extracciones * 1e6, tPercentil / 1000 * 1e6);
+}
+
+/**
+ * @brief Compara el índice de orden con los recorridos lineales
+ */
+void benchIndice() {
+    printf("\n== Índice de orden: eliminarMinimo y percentiles (200k lecturas) ==\n");
+    medirIndice(false);
+    medirIndice(true);
+}
+
+/**
+ * @brief Mide la búsqueda de sensores por nombre y por handle
+ */
+void benchBuscar() {
+    printf("\n== ListaGestion: búsqueda por nombre (hash) y despacho por handle ==\n");
+    int flotas[] = {100, 1000, 10000};
+    for (int f = 0; f < 3; f++) {
+        int sensores = flotas[f];
+        ListaGestion* gestor = new ListaGestion();
+        char (*nombres)[16] = new char[sensores][16];
+        for (int i = 0; i < sensores; i++) {
+            snprintf(nombres[i], sizeof(nombres[i]), "P-%05d", i);
+            gestor->insertar(new SensorPresion(nombres[i]));
+        }
+
+        const int consultas = 1000000;
+        volatile long encontrados = 0;
+        auto inicio = std::chrono::steady_clock::now();
+        for (int i = 0; i < consultas; i++) {
+            if (gestor->buscar(nombres[(long)i * 7919 % sensores]) != nullptr) encontrados = encontrados + 1;
+        }
+        double tNombre = segundosDesde(inicio);
+
+        int handle = gestor->internar("P-00000");
+        inicio = std::chrono::steady_clock::now();
+        for (int i = 0; i < consultas; i++) {
+            if (gestor->obtener((handle + i) % sensores) != nullptr) encontrados = encontrados + 1;
+        }
+        double tHandle = segundosDesde(inicio);
+
+        printf("sensores=%-6d buscar(nombre)=%7.1f ns/op  obtener(handle)=%6.2f ns/op\n",
+               sensores, tNombre / consultas * 1e9, tHandle / consultas * 1e9);
+        delete[] nombres;
+        delete gestor;
+    }
+}
+
+/**
+ * @brief Mide el enrutamiento de líneas "ID:valor" con flotas de distinto tamaño
+ */
+void benchEnrutar() {
+    printf("\n== EnrutadorLineas: despacho de líneas etiquetadas ==\n");
+    int flotas[] = {10, 100, 1000};
+    for (int f = 0; f < 3; f++) {
+        int sensores = flotas[f];
+        ListaGestion* gestor = new ListaGestion();
+        const int distintas = 4096;
+        char (*lineas)[32] = new char[distintas][32];
+        for (int i = 0; i < sensores; i++) {
+            char nombre[16];
+            snprintf(nombre, sizeof(nombre), "P-%05d", i);
+            gestor->insertar(new SensorPresion(nombre));
+        }
+        for (int i = 0; i < distintas; i++) {
+            // Una de cada 16 líneas trae un ID que no está registrado
+            int id = i % 16 == 0 ? sensores + i : (int)((long)i * 7919 % sensores);
+            snprintf(lineas[i], sizeof(lineas[i]), i % 2 ? "P-%05d:%d" : "P-%05d:%d.5", id, 900 + i % 300);
+        }
+
+        EnrutadorLineas enrutador(*gestor);
+        const int total = 1000000;
+        char linea[32];
+        auto inicio = std::chrono::steady_clock::now();
+        for (int i = 0; i < total; i++) {
+            memcpy(linea, lineas[i & (distintas - 1)], sizeof(linea));
+            enrutador.enrutar(linea);
+        }
+        double t = segundosDesde(inicio);
+
+        printf("sensores=%-5d %6.1f ns/linea  entregadas=%ld desconocidas=%ld\n",
+               sensores, t / total * 1e9, enrutador.getEntregadas(), enrutador.getDesconocidas());
+        delete[] lineas;
+        delete gestor;
+    }
+}
+
+/**
+ * @brief Escribe lecturas simuladas en el extremo maestro de un pseudo-terminal
+ * @param fd Descriptor maestro
+ * @param lineas Número de líneas a escribir
+ */
+void simularArduino(int fd, int lineas) {
+    char bloque[4096];
+    int usado = 0;
+    for (int i = 0; i < lineas; i++) {
+        usado += snprintf(bloque + usado, sizeof(bloque) - usado, "%d.%d\r\n", 20 + i % 15, i % 10);
+        if (usado > (int)sizeof(bloque) - 32 || i == lineas - 1) {
+            int escrito = 0;
+            while (escrito < usado) {
+                ssize_t n = write(fd, bloque + escrito, usado - escrito);
+                if (n <= 0) return;
+                escrito += n;
+            }
+            usado = 0;
+        }
+    }
+}
+
+/**
+ * @brief Mide el lector serial contra un pseudo-terminal (openpty)
+ */
+void benchSerial() {
+    printf("\n== SerialPort: lectura de líneas desde un pseudo-terminal ==\n");
+    const int lineas = 200000;
+    int maestro, esclavo;
+    if (openpty(&maestro, &esclavo, nullptr, nullptr, nullptr) != 0) {
+        printf("openpty no disponible\n");
+        return;
+    }
+
+    SerialPort serial(esclavo, true, 1000);
+    std::thread arduino(simularArduino, maestro, lineas);
+
+    char linea[100];
+    int recibidas = 0;
+    auto inicio = std::chrono::steady_clock::now();
+    while (recibidas < lineas && serial.leerLinea(linea, sizeof(linea))) {
+        recibidas++;
+    }
+    double t = segundosDesde(inicio);
+    arduino.join();
+    close(maestro);
+
+    printf("lineas=%d  %.2f Mlineas/s  %.1f MB/s  bytes/read()=%.0f\n",
+           recibidas, recibidas / t / 1e6, serial.getBytesLeidos() / t / 1e6,
+           (double)serial.getBytesLeidos() / (serial.getLlamadasRead() > 0 ? serial.getLlamadasRead() : 1));
+}
+
+/**
+ * @brief Mide el motor epoll con 1 a 64 dispositivos simulados
+ */
+void benchIngesta() {
+    printf("\n== MotorIngesta: un bucle epoll para N pseudo-terminales ==\n");
+    const int lineasPorDispositivo = 20000;
+    int dispositivos[] = {1, 4, 16, 64};
+    for (int d = 0; d < 4; d++) {
+        int n = dispositivos[d];
+        ListaGestion* gestor = new ListaGestion();
+        MotorIngesta* motor = new MotorIngesta(*gestor);
+        int* maestros = new int[n];
+        char nombre[50];
+        for (int i = 0; i < n; i++) {
+            snprintf(nombre, sizeof(nombre), "P-%03d", i);
+            gestor->insertar(new SensorPresion(nombre));
+            int esclavo;
+            openpty(&maestros[i], &esclavo, nullptr, nullptr, nullptr);
+            motor->agregarDescriptor(esclavo, gestor->internar(nombre));
+        }
+
+        std::thread* arduinos = new std::thread[n];
+        auto inicio = std::chrono::steady_clock::now();
+        for (int i = 0; i < n; i++) {
+            arduinos[i] = std::thread(simularArduino, maestros[i], lineasPorDispositivo);
+        }
+        long total = motor->ejecutar((long)n * lineasPorDispositivo, 2000);
+        double t = segundosDesde(inicio);
+        for (int i = 0; i < n; i++) {
+            arduinos[i].join();
+            close(maestros[i]);
+        }
+
+        printf("dispositivos=%-3d lineas=%-8ld %.2f Mlineas/s  %.1f klineas/s por dispositivo\n",
+               n, total, total / t / 1e6, total / t / n / 1e3);
+        delete[] arduinos;
+        delete[] maestros;
+        delete motor;
+        delete gestor;
+    }
+}
+
+/**
+ * @brief Escribe un bloque de bytes completo en un descriptor
+ * @param fd Descriptor destino
+ * @param datos Bytes a escribir
+ * @param n Número de bytes
+ */
+void escribirTodo(int fd, const unsigned char* datos, long n) {
+    long escrito = 0;
+    while (escrito < n) {
+        ssize_t w = write(fd, datos + escrito, n - escrito);
+        if (w <= 0) return;
+        escrito += w;
+    }
+}
+
+/**
+ * @brief Emula un dispositivo que transmite a ritmo fijo y pierde lo que no cabe
+ * @param fd Descriptor maestro (se pasa a no bloqueante y se cierra al terminar)
+ * @param lineas Número de líneas "P-xxx:valor" a transmitir
+ * @param sensores Sensores entre los que se reparten las líneas
+ * @param lineasPorSegundo Ritmo de transmisión
+ * @param perdidas Recibe las líneas descartadas por búfer lleno
+ *
+ * Como un UART, no espera al lector: si el búfer del pseudo-terminal está
+ * lleno, el bloque se pierde.
+ */
+void simularDispositivo(int fd, int lineas, int sensores, int lineasPorSegundo, long* perdidas) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    const int lineasPorBloque = 16;
+    char bloque[512];
+    long descartadas = 0;
+    auto inicio = std::chrono::steady_clock::now();
+    for (int i = 0; i < lineas; i += lineasPorBloque) {
+        int usado = 0;
+        int n = lineas - i < lineasPorBloque ? lineas - i : lineasPorBloque;
+        for (int k = 0; k < n; k++) {
+            usado += snprintf(bloque + usado, sizeof(bloque) - usado, "P-%03d:%d\r\n",
+                              (i + k) % sensores, 900 + (i + k) % 200);
+        }
+        std::this_thread::sleep_until(inicio + std::chrono::microseconds((long long)i * 1000000 / lineasPorSegundo));
+        ssize_t w = write(fd, bloque, usado);
+        if (w < usado) {
+            // Un bloque a medias deja una línea cortada que también se pierde
+            descartadas += w <= 0 ? n : n - (int)(w * n / usado);
+        }
+    }
+    *perdidas = descartadas;
+    // Dar tiempo al lector a vaciar el búfer antes de colgar
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    close(fd);
+}
+
+/**
+ * @class SensorPresionLento
+ * @brief Sensor de presión cuyo procesamiento tarda un tiempo fijo
+ *
+ * Representa un procesamiento costoso (filtrado, exportación) para ver qué
+ * pasa con el puerto mientras dura.
+ */
+class SensorPresionLento : public SensorPresion {
+private:
+    long long duracionNs;
+
+public:
+    SensorPresionLento(const char* nombre, double ms) : SensorPresion(nombre), duracionNs((long long)(ms * 1e6)) {}
+
+    ResultadoProceso procesar() override {
+        long long fin = relojNs() + duracionNs;
+        while (relojNs() < fin) {
+        }
+        return SensorPresion::procesar();
+    }
+};
+
+/**
+ * @brief Crea sensores de presión que tardan msPorSensor en procesarse
+ */
+ListaGestion* crearGestorLento(int sensores, double msPorSensor) {
+    ListaGestion* gestor = new ListaGestion();
+    char nombre[50];
+    for (int i = 0; i < sensores; i++) {
+        snprintf(nombre, sizeof(nombre), "P-%03d", i);
+        gestor->insertar(new SensorPresionLento(nombre, msPorSensor));
+    }
+    return gestor;
+}
+
+/**
+ * @brief Compara un solo hilo con la TuberiaIngesta procesando cada 100 ms
+ *
+ * El dispositivo transmite a ritmo fijo; mientras un solo hilo ejecuta
+ * procesarTodos() nadie lee el puerto y el búfer del kernel se desborda.
+ */
+void benchTuberia() {
+    printf("\n== TuberiaIngesta: lector en su hilo frente a leer y procesar en uno ==\n");
+    const int lineas = 200000;
+    const int lineasPorSegundo = 400000;
+    const int sensores = 64;
+    const double msPorSensor = 0.25;   // Ronda de ~16 ms
+    const double intervalo = 0.1;
+
+    for (int modo = 0; modo < 2; modo++) {
+        ListaGestion* gestor = crearGestorLento(sensores, msPorSensor);
+        int maestro, esclavo;
+        if (openpty(&maestro, &esclavo, nullptr, nullptr, nullptr) != 0) {
+            printf("openpty no disponible\n");
+            delete gestor;
+            return;
+        }
+        long perdidas = 0;
+        std::thread dispositivo(simularDispositivo, maestro, lineas, sensores, lineasPorSegundo, &perdidas);
+        long recibidas = 0;
+        if (modo == 0) {
+            SerialPort serial(esclavo, true, 1000);
+            EnrutadorLineas enrutador(*gestor);
+            char linea[100];
+            long procesamientos = 0;
+            long long proximo = relojNs() + (long long)(intervalo * 1e9);
+            while (serial.leerLinea(linea, sizeof(linea))) {
+                enrutador.enrutar(linea);
+                recibidas++;
+                if (relojNs() >= proximo) {
+                    gestor->procesarTodos();
+                    procesamientos++;
+                    proximo = relojNs() + (long long)(intervalo * 1e9);
+                }
+            }
+            dispositivo.join();
+            printf("un hilo  recibidas=%-7ld perdidas=%-7ld procesamientos=%-3ld ronda máx=%.2f ms\n",
+                   recibidas, perdidas, procesamientos, gestor->getDuracionRonda().getMaximo() / 1e6);
+        } else {
+            TuberiaIngesta* tuberia = new TuberiaIngesta(*gestor, new SerialPort(esclavo, true, 1000), 65536);
+            tuberia->establecerIntervaloProceso(intervalo);
+            recibidas = tuberia->ejecutar(-1);
+            dispositivo.join();
+            printf("tubería  recibidas=%-7ld perdidas=%-7ld procesamientos=%-3ld ronda máx=%.2f ms\n",
+                   recibidas, perdidas, tuberia->getProcesamientos(), gestor->getDuracionRonda().getMaximo() / 1e6);
+            printf("         anillo máx=%ld de %ld  lector estancado=%ld veces\n",
+                   tuberia->getProfundidadMaxima(), 65536L, tuberia->getEstancamientosLector());
+            delete tuberia;
+        }
+        delete gestor;
+    }
+}
+
+/**
+ * @brief Escribe un archivo de líneas "ID:valor" y lo pasa por ModoLote
+ * @param etiqueta Nombre de la fila
+ * @param manifiesto Contenido del manifiesto
+ * @param lineas Líneas a generar
+ * @param flotantes true para repartir también lecturas a sensores de temperatura
+ */
+void medirLote(const char* etiqueta, const char* manifiesto, int lineas, bool flotantes) {
+    char rutaManifiesto[] = "/tmp/iot_bench_manifiestoXXXXXX";
+    char rutaEntrada[] = "/tmp/iot_bench_entradaXXXXXX";
+    int fdManifiesto = mkstemp(rutaManifiesto);
+    int fdEntrada = mkstemp(rutaEntrada);
+    if (fdManifiesto < 0 || fdEntrada < 0) return;
+    escribirTodo(fdManifiesto, (const unsigned char*)manifiesto, strlen(manifiesto));
+    close(fdManifiesto);
+
+    char* bloque = new char[1 << 20];
+    int usado = 0;
+    for (int i = 0; i < lineas; i++) {
+        if (flotantes && i % 2 == 1) {
+            usado += snprintf(bloque + usado, 64, "T-%d:%d.%d\n", i % 4, 20 + i % 15, i % 10);
+        } else {
+            usado += snprintf(bloque + usado, 64, "P-%d:%d\n", i % 4, 900 + i % 200);
+        }
+        if (usado > (1 << 20) - 64) {
+            escribirTodo(fdEntrada, (const unsigned char*)bloque, usado);
+            usado = 0;
+        }
+    }
+    escribirTodo(fdEntrada, (const unsigned char*)bloque, usado);
+    delete[] bloque;
+    lseek(fdEntrada, 0, SEEK_SET);
+
+    FILE* nulo = fopen("/dev/null", "w");
+    {
+        ListaGestion gestor;
+        ModoLote lote(gestor, nulo, LOTE_CSV, 0.0);
+        lote.cargarManifiesto(rutaManifiesto);
+        SerialPort entrada(fdEntrada, true);
+        auto inicio = std::chrono::steady_clock::now();
+        long unidades = lote.ingerir(entrada, -1);
+        double t = segundosDesde(inicio);
+        printf("%-22s lineas=%-8ld %6.2f Mlineas/s\n", etiqueta, unidades, unidades / t / 1e6);
+    }
+    fclose(nulo);
+    remove(rutaManifiesto);
+    remove(rutaEntrada);
+}
+
+/**
+ * @brief Velocidad del modo sin menú leyendo un archivo
+ */
+void benchLote() {
+    printf("\n== ModoLote: archivo -> sensores del manifiesto ==\n");
+    const int lineas = 4000000;
+    medirLote("presion", "P-0 presion\nP-1 presion\nP-2 presion\nP-3 presion\n", lineas, false);
+    medirLote("presion+temperatura",
+              "P-0 i\nP-1 i\nP-2 i\nP-3 i\nT-0 f 1000\nT-1 f 1000\nT-2 f 1000\nT-3 f 1000\n", lineas, true);
+}
+
+/**
+ * @brief Mide decodificación de un flujo (texto o binario) por un pseudo-terminal
+ * @param etiqueta Nombre del formato
+ * @param flujo Bytes a transmitir
+ * @param n Número de bytes
+ * @param lecturas Lecturas contenidas en el flujo
+ */
+void medirProtocolo(const char* etiqueta, const unsigned char* flujo, long n, int lecturas) {
+    ListaGestion* gestor = new ListaGestion();
+    SensorPresion* sensor = new SensorPresion("P-000");
+    gestor->insertar(sensor);
+    int maestro, esclavo;
+    openpty(&maestro, &esclavo, nullptr, nullptr, nullptr);
+    SerialPort* puerto = new SerialPort(esclavo, true, 1000);
+    DecodificadorTramas decodificador;
+
+    std::thread arduino(escribirTodo, maestro, flujo, n);
+    char linea[100];
+    int recibidas = 0;
+    auto inicio = std::chrono::steady_clock::now();
+    while (recibidas < lecturas && puerto->estaConectado()) {
+        UnidadRecibida u = decodificador.siguiente(*puerto, *gestor, linea, sizeof(linea));
+        if (u == SIN_DATOS) {
+            if (puerto->esperarDatos() == 0) break;
+        } else {
+            if (u == LINEA_TEXTO) sensor->agregarLectura(linea);
+            recibidas++;
+        }
+    }
+    double t = segundosDesde(inicio);
+    arduino.join();
+    close(maestro);
+
+    printf("%-8s bytes/lectura=%5.2f  %.2f Mlect/s  (a 9600 baudios: %.0f lect/s)\n",
+           etiqueta, (double)n / lecturas, recibidas / t / 1e6, 960.0 / ((double)n / lecturas));
+    delete puerto;
+    delete gestor;
+}
+
+/**
+ * @brief Compara el protocolo de texto con las tramas binarias
+ */
+void benchProtocolo() {
+    printf("\n== Protocolo: líneas de texto vs tramas binarias ==\n");
+    const int lecturas = 300000;
+    unsigned char* texto = new unsigned char[(long)lecturas * 16];
+    unsigned char* binario = new unsigned char[(long)lecturas * TAM_MAX_TRAMA];
+    long nTexto = 0;
+    long nBinario = 0;
+    for (int i = 0; i < lecturas; i++) {
+        int valor = 900 + (i * 37) % 300;
+        nTexto += snprintf((char*)texto + nTexto, 16, "%d\r\n", valor);
+        nBinario += codificarTramaEntero(binario + nBinario, 0, valor);
+    }
+    medirProtocolo("texto", texto, nTexto, lecturas);
+    medirProtocolo("binario", binario, nBinario, lecturas);
+    delete[] texto;
+    delete[] binario;
+}
+
+/**
+ * @brief Compara std::cout con std::endl contra el registro asíncrono
+ *
+ * Ambos escriben a /dev/null para medir el costo del lado del productor.
+ */
+void benchRegistro() {
+    printf("\n== Registro: std::endl por línea vs escritura asíncrona en lotes ==\n");
+    const int mensajes = 1000000;
+    std::ofstream nulo("/dev/null");
+    auto inicio = std::chrono::steady_clock::now();
+    for (int i = 0; i < mensajes; i++) {
+        nulo << "ID: P-105. Valor: " << i << " (int)" << std::endl;
+    }
+    double tEndl = segundosDesde(inicio);
+
+    int fd = open("/dev/null", O_WRONLY);
+    Registro::instancia().establecerDescriptor(fd);
+    inicio = std::chrono::steady_clock::now();
+    for (int i = 0; i < mensajes; i++) {
+        REGISTRAR(NIVEL_ERROR, "ID: P-105. Valor: " << i << " (int)");
+    }
+    Registro::instancia().vaciar();
+    double tRegistro = segundosDesde(inicio);
+
+    inicio = std::chrono::steady_clock::now();
+    for (int i = 0; i < mensajes; i++) {
+        REGISTRO_TRAZA("ID: P-105. Valor: " << i << " (int)");
+    }
+    double tTraza = segundosDesde(inicio);
+    Registro::instancia().establecerDescriptor(2);
+    close(fd);
+
+    printf("std::endl=%6.1f ns/msg  registro=%6.1f ns/msg  traza compilada fuera=%5.2f ns/msg\n",
+           tEndl / mensajes * 1e9, tRegistro / mensajes * 1e9, tTraza / mensajes * 1e9);
+}
+
+/**
+ * @brief Escalamiento de procesarEnParalelo de 1 a N hilos
+ */
+void benchParalelo() {
+    printf("\n== ListaGestion: procesamiento paralelo con robo de trabajo ==\n");
+    const int sensores = 1000;
+    const int lecturasPorSensor = 2000;
+    const int pasadas = 200;
+    ListaGestion* gestor = new ListaGestion();
+    for (int i = 0; i < sensores; i++) {
+        char nombre[16];
+        snprintf(nombre, sizeof(nombre), "T-%05d", i);
+        SensorTemperatura* sensor = new SensorTemperatura(nombre);
+        // Historiales desiguales para que el reparto estático no baste
+        int lecturas = i % 10 == 0 ? lecturasPorSensor * 5 : lecturasPorSensor;
+        for (int j = 0; j < lecturas; j++) {
+            sensor->agregarFlotante(20.0f + (float)((long)j * 7919 % 1000) / 100.0f);
+        }
+        gestor->insertar(sensor);
+    }
+
+    ResultadoProceso* resultados = new ResultadoProceso[sensores];
+    int maxHilos = (int)std::thread::hardware_concurrency();
+    if (maxHilos < 1) maxHilos = 1;
+    double base = 0.0;
+    for (int hilos = 1; hilos <= maxHilos; hilos = hilos * 2 > maxHilos && hilos < maxHilos ? maxHilos : hilos * 2) {
+        PoolTrabajo pool(hilos);
+        auto inicio = std::chrono::steady_clock::now();
+        for (int p = 0; p < pasadas; p++) {
+            gestor->procesarEnParalelo(resultados, pool);
+        }
+        double t = segundosDesde(inicio);
+        if (hilos == 1) base = t;
+        printf("hilos=%-3d %8.2f ms/pasada  %6.2f Msensores/s  aceleracion=%.2fx\n",
+               hilos, t / pasadas * 1e3, (double)sensores * pasadas / t / 1e6, base / t);
+    }
+    delete[] resultados;
+    delete gestor;
+}
+
+/**
+ * @brief Compara ListaGestion (SensorBase* y llamadas virtuales) con GestionTipada
+ *
+ * Los mismos sensores, alternando temperatura y presión, reciben lecturas
+ * por handle y se procesan sin imprimir.
+ */
+void benchTipada() {
+    printf("\n== GestionTipada: almacenes por tipo vs SensorBase* virtual ==\n");
+    const int sensores = 1024;
+    const int lecturas = 1000000;
+    const int pasadas = 200;
+    char nombre[50];
+
+    ListaGestion* lista = new ListaGestion();
+    GestionTipada<SensorTemperatura, SensorPresion>* tipada = new GestionTipada<SensorTemperatura, SensorPresion>();
+    for (int i = 0; i < sensores; i++) {
+        snprintf(nombre, sizeof(nombre), "S-%04d", i);
+        if (i % 2 == 0) {
+            lista->insertar(new SensorTemperatura(nombre));
+            tipada->crear<SensorTemperatura>(nombre);
+        } else {
+            lista->insertar(new SensorPresion(nombre));
+            tipada->crear<SensorPresion>(nombre);
+        }
+    }
+    auto inicio = std::chrono::steady_clock::now();
+    for (int i = 0; i < lecturas; i++) {
+        lista->obtener((i * 7) & (sensores - 1))->agregarEntero(900 + i % 200);
+    }
+    double tListaAgregar = segundosDesde(inicio);
+    inicio = std::chrono::steady_clock::now();
+    for (int i = 0; i < lecturas; i++) {
+        tipada->agregarEntero((i * 7) & (sensores - 1), 900 + i % 200);
+    }
+    double tTipadaAgregar = segundosDesde(inicio);
+
+    ResultadoProceso* resultados = new ResultadoProceso[sensores];
+    inicio = std::chrono::steady_clock::now();
+    for (int p = 0; p < pasadas; p++) {
+        for (int i = 0; i < sensores; i++) {
+            resultados[i] = lista->obtener(i)->procesar();
+        }
+        lista->obtener(p & (sensores - 1))->agregarEntero(p);
+    }
+    double tListaProcesar = segundosDesde(inicio);
+    inicio = std::chrono::steady_clock::now();
+    for (int p = 0; p < pasadas; p++) {
+        tipada->procesarLote(resultados);
+        tipada->agregarEntero(p & (sensores - 1), p);
+    }
+    double tTipadaProcesar = segundosDesde(inicio);
+
+    // Recorrido ligero: aquí pesa solo el despacho (la versión tipada se resuelve en compilación)
+    long suma = 0;
+    inicio = std::chrono::steady_clock::now();
+    for (int p = 0; p < pasadas * 10; p++) {
+        for (int i = 0; i < sensores; i++) {
+            suma += lista->obtener(i)->getTipo();
+        }
+    }
+    double tListaTipo = segundosDesde(inicio);
+    inicio = std::chrono::steady_clock::now();
+    for (int p = 0; p < pasadas * 10; p++) {
+        tipada->paraCada([&suma](auto& s, int) {
+            typedef typename std::decay<decltype(s)>::type T;
+            suma += s.T::getTipo();
+        });
+    }
+    double tTipadaTipo = segundosDesde(inicio);
+    volatile long sumidero = suma;
+    (void)sumidero;
+
+    printf("sensores=%d\n", sensores);
+    printf("agregarEntero por handle  virtual=%6.1f ns  tipada=%6.1f ns\n",
+           tListaAgregar / lecturas * 1e9, tTipadaAgregar / lecturas * 1e9);
+    printf("procesar (por sensor)     virtual=%6.1f ns  tipada=%6.1f ns\n",
+           tListaProcesar / ((double)pasadas * sensores) * 1e9,
+           tTipadaProcesar / ((double)pasadas * sensores) * 1e9);
+    printf("getTipo (por sensor)      virtual=%6.2f ns  tipada=%6.2f ns\n",
+           tListaTipo / ((double)pasadas * 10 * sensores) * 1e9,
+           tTipadaTipo / ((double)pasadas * 10 * sensores) * 1e9);
+    delete[] resultados;
+    delete tipada;
+    delete lista;
+}
+
+/**
+ * @brief Contención de 1 a 32 productores: candado global vs GestionConcurrente
+ *
+ * Cada productor escribe en sus propios sensores (como un hilo por
+ * dispositivo) y, en la segunda tabla, registra sensores nuevos.
+ */
+void benchConcurrente() {
+    printf("\n== GestionConcurrente: productores concurrentes (%u núcleos) ==\n",
+           std::thread::hardware_concurrency());
+    const int sensores = 1024;
+    const int lecturas = 2000000;
+    const int nuevosPorHilo = 2000;
+    int productores[] = {1, 2, 4, 8, 16, 32};
+    char nombre[50];
+
+    ListaGestion* lista = new ListaGestion();
+    GestionConcurrente* concurrente = new GestionConcurrente();
+    for (int i = 0; i < sensores; i++) {
+        snprintf(nombre, sizeof(nombre), "P-%04d", i);
+        lista->insertar(new SensorPresion(nombre));
+        concurrente->insertar(new SensorPresion(nombre));
+    }
+    std::mutex global;
+
+    printf("agregarEntero (Mlect/s en total)\n");
+    for (int p = 0; p < 6; p++) {
+        int n = productores[p];
+        int porHilo = lecturas / n;
+        std::thread* hilos = new std::thread[n];
+
+        auto inicio = std::chrono::steady_clock::now();
+        for (int t = 0; t < n; t++) {
+            hilos[t] = std::thread([lista, &global, t, n, porHilo]() {
+                for (int i = 0; i < porHilo; i++) {
+                    std::lock_guard<std::mutex> lock(global);
+                    lista->obtener((t + (i % 64) * n) & (sensores - 1))->agregarEntero(900 + i % 200);
+                }
+            });
+        }
+        for (int t = 0; t < n; t++) hilos[t].join();
+        double tGlobal = segundosDesde(inicio);
+
+        inicio = std::chrono::steady_clock::now();
+        for (int t = 0; t < n; t++) {
+            hilos[t] = std::thread([concurrente, t, n, porHilo]() {
+                for (int i = 0; i < porHilo; i++) {
+                    concurrente->agregarEntero((t + (i % 64) * n) & (sensores - 1), 900 + i % 200);
+                }
+            });
+        }
+        for (int t = 0; t < n; t++) hilos[t].join();
+        double tConcurrente = segundosDesde(inicio);
+
+        printf("hilos=%-3d candado global=%6.2f  por sensor=%6.2f\n",
+               n, (double)porHilo * n / tGlobal / 1e6, (double)porHilo * n / tConcurrente / 1e6);
+        delete[] hilos;
+    }
+
+    printf("insertar (ksensores/s en total)\n");
+    for (int p = 0; p < 6; p++) {
+        int n = productores[p];
+        std::thread* hilos = new std::thread[n];
+        ListaGestion* otraLista = new ListaGestion();
+        GestionConcurrente* otroRegistro = new GestionConcurrente();
+
+        auto inicio = std::chrono::steady_clock::now();
+        for (int t = 0; t < n; t++) {
+            hilos[t] = std::thread([otraLista, t]() {
+                char id[16];
+                for (int i = 0; i < nuevosPorHilo; i++) {
+                    snprintf(id, sizeof(id), "N-%02d-%05d", t, i);
+                    otraLista->insertar(new SensorPresion(id));
+                }
+            });
+        }
+        for (int t = 0; t < n; t++) hilos[t].join();
+        double tLista = segundosDesde(inicio);
+
+        inicio = std::chrono::steady_clock::now();
+        for (int t = 0; t < n; t++) {
+            hilos[t] = std::thread([otroRegistro, t]() {
+                char id[16];
+                for (int i = 0; i < nuevosPorHilo; i++) {
+                    snprintf(id, sizeof(id), "N-%02d-%05d", t, i);
+                    otroRegistro->insertar(new SensorPresion(id));
+                }
+            });
+        }
+        for (int t = 0; t < n; t++) hilos[t].join();
+        double tRegistro = segundosDesde(inicio);
+
+        printf("hilos=%-3d ListaGestion=%8.1f  fragmentado=%8.1f\n",
+               n, (double)nuevosPorHilo * n / tLista / 1e3, (double)nuevosPorHilo * n / tRegistro / 1e3);
+        delete otroRegistro;
+        delete otraLista;
+        delete[] hilos;
+    }
+    delete concurrente;
+    delete lista;
+}
+
+/**
+ * @brief Lecturas por segundo de una reducción repetida sobre n lecturas
+ * @param f Reducción; su resultado se acumula para que no se elimine
+ * @param n Lecturas que procesa cada llamada
+ */
+template <typename F>
+double lecturasPorSegundo(F f, long n) {
+    const int pasadas = 20;
+    volatile double sumidero = 0.0;
+    auto inicio = std::chrono::steady_clock::now();
+    for (int p = 0; p < pasadas; p++) {
+        sumidero = sumidero + (double)f();
+    }
+    return (double)n * pasadas / segundosDesde(inicio);
+}
+
+/**
+ * @brief Compara recorridos por punteros, por bloques y sobre arreglo exportado
+ * @tparam T Tipo de lectura (int o float)
+ * @param tipo Nombre del tipo para la tabla
+ */
+template <typename T>
+void medirSimd(const char* tipo) {
+    const int lecturas = 2000000;
+    ListaSensor<T, 1>* clasica = new ListaSensor<T, 1>();
+    ListaSensor<T, LECTURAS_POR_BLOQUE>* bloques = new ListaSensor<T, LECTURAS_POR_BLOQUE>();
+    for (int i = 0; i < lecturas; i++) {
+        T v = (T)((long)i * 7919 % 100000) / (T)10;
+        clasica->insertar(v);
+        bloques->insertar(v);
+    }
+    T* arreglo = new T[lecturas];
+    bloques->exportar(arreglo);
+    T umbral = (T)5000;
+
+    // Referencia: el recorrido nodo a nodo de la lista clásica
+    double sumaPunteros = lecturasPorSegundo([&] {
+        double s = 0;
+        clasica->paraCadaBloque([&](const T* d, int n) { for (int i = 0; i < n; i++) s += d[i]; });
+        return s;
+    }, lecturas);
+    double extremosPunteros = lecturasPorSegundo([&] {
+        T mn = arreglo[0], mx = arreglo[0];
+        clasica->paraCadaBloque([&](const T* d, int n) {
+            for (int i = 0; i < n; i++) { if (d[i] < mn) mn = d[i]; if (mx < d[i]) mx = d[i]; }
+        });
+        return mn + mx;
+    }, lecturas);
+    double contarPunteros = lecturasPorSegundo([&] {
+        long c = 0;
+        clasica->paraCadaBloque([&](const T* d, int n) { for (int i = 0; i < n; i++) c += umbral < d[i]; });
+        return c;
+    }, lecturas);
+    printf("%-5s %-8s %-9s suma=%8.0f  extremos=%8.0f  contar=%8.0f Mlect/s\n", tipo, "punteros", "escalar",
+           sumaPunteros / 1e6, extremosPunteros / 1e6, contarPunteros / 1e6);
+
+    NivelSimd detectado = detectarSimd();
+    for (int nivel = SIMD_ESCALAR; nivel <= detectado; nivel++) {
+        establecerNivelSimd((NivelSimd)nivel);
+        double sumaBloques = lecturasPorSegundo([&] {
+            double s = 0;
+            bloques->paraCadaBloque([&](const T* d, int n) { s += (double)sumarLecturas(d, n); });
+            return s;
+        }, lecturas);
+        double extremosBloques = lecturasPorSegundo([&] {
+            T mn = arreglo[0], mx = arreglo[0];
+            bloques->paraCadaBloque([&](const T* d, int n) { extremosLecturas(d, n, mn, mx); });
+            return mn + mx;
+        }, lecturas);
+        double contarBloques = lecturasPorSegundo([&] { return bloques->contarMayoresQue(umbral); }, lecturas);
+        printf("%-5s %-8s %-9s suma=%8.0f  extremos=%8.0f  contar=%8.0f Mlect/s\n", tipo, "bloques",
+               nombreSimd((NivelSimd)nivel), sumaBloques / 1e6, extremosBloques / 1e6, contarBloques / 1e6);
+
+        double sumaArreglo = lecturasPorSegundo([&] { return sumarLecturas(arreglo, lecturas); }, lecturas);
+        double extremosArreglo = lecturasPorSegundo([&] {
+            T mn = arreglo[0], mx = arreglo[0];
+            extremosLecturas(arreglo, lecturas, mn, mx);
+            return mn + mx;
+        }, lecturas);
+        double contarArreglo = lecturasPorSegundo([&] { return contarMayores(arreglo, lecturas, umbral); }, lecturas);
+        printf("%-5s %-8s %-9s suma=%8.0f  extremos=%8.0f  contar=%8.0f Mlect/s\n", tipo, "arreglo",
+               nombreSimd((NivelSimd)nivel), sumaArreglo / 1e6, extremosArreglo / 1e6, contarArreglo / 1e6);
+    }
+
+    // eliminarMinimo sin índice: recorrido completo por extracción
+    const int extracciones = 200;
+    for (int nivel = SIMD_ESCALAR; nivel <= detectado; nivel += detectado > 0 ? detectado : 1) {
+        establecerNivelSimd((NivelSimd)nivel);
+        auto inicio = std::chrono::steady_clock::now();
+        for (int i = 0; i < extracciones; i++) clasica->eliminarMinimo();
+        double tClasica = segundosDesde(inicio);
+        inicio = std::chrono::steady_clock::now();
+        for (int i = 0; i < extracciones; i++) bloques->eliminarMinimo();
+        double tBloques = segundosDesde(inicio);
+        printf("%-5s eliminarMinimo (%s): clasica=%7.2f ms/op  bloques=%6.2f ms/op\n", tipo,
+               nombreSimd((NivelSimd)nivel), tClasica / extracciones * 1e3, tBloques / extracciones * 1e3);
+    }
+    establecerNivelSimd(detectado);
+
+    delete[] arreglo;
+    delete clasica;
+    delete bloques;
+}
+
+/**
+ * @brief Kernels vectoriales contra los recorridos escalares
+ */
+void benchSimd() {
+    printf("\n== Kernels SIMD (detectado: %s) ==\n", nombreSimd(detectarSimd()));
+    medirSimd<int>("int");
+    medirSimd<float>("float");
+}
+
+/**
+ * @brief Inserción en régimen estable con ventana de retención por cantidad
+ */
+void benchRetencion() {
+    printf("\n== Retención: ventana circular de lecturas ==\n");
+    const int lecturas = 10000000;
+    int ventanas[] = {1000, 100000, 0};
+    for (int v = 0; v < 3; v++) {
+        ListaSensor<int, LECTURAS_POR_BLOQUE>* lista = new ListaSensor<int, LECTURAS_POR_BLOQUE>();
+        lista->establecerRetencion(ventanas[v], 0.0);
+        // Calentamiento: llenar la ventana antes de medir
+        int calentamiento = ventanas[v] > 0 ? ventanas[v] : 0;
+        for (int i = 0; i < calentamiento; i++) lista->insertar(i);
+        long heapInicial = bytesEnHeap();
+        auto inicio = std::chrono::steady_clock::now();
+        for (int i = 0; i < lecturas; i++) {
+            lista->insertar(i % 1000);
+        }
+        double t = segundosDesde(inicio);
+        long crecimiento = bytesEnHeap() - heapInicial;
+        printf("ventana=%-8d %5.2f ns/insercion  heap durante la medicion=%+ld bytes  retenidas=%d\n",
+               ventanas[v], t / lecturas * 1e9, crecimiento, lista->getTamanio());
+        delete lista;
+    }
+}
+
+/**
+ * @brief Mide bytes por lectura e inserción/recorrido de la serie comprimida frente a ListaSensor
+ * @tparam T Tipo de lectura (int o float)
+ * @param tipo Nombre del tipo para la tabla
+ * @param senal Genera la lectura i (señal de variación lenta)
+ */
+template <typename T, typename Senal>
+void medirCompresion(const char* tipo, Senal senal) {
+    const int lecturas = 2000000;
+    long heapInicial = bytesEnHeap();
+    ListaSensor<T, LECTURAS_POR_BLOQUE>* lista = new ListaSensor<T, LECTURAS_POR_BLOQUE>();
+    auto inicio = std::chrono::steady_clock::now();
+    for (int i = 0; i < lecturas; i++) lista->insertar(senal(i));
+    double tListaInsertar = segundosDesde(inicio);
+    long bytesLista = bytesEnHeap() - heapInicial;
+    lista->activarIndice();
+    long bytesListaIndice = bytesEnHeap() - heapInicial;
+    lista->desactivarIndice();
+
+    heapInicial = bytesEnHeap();
+    SerieComprimida<T>* serie = new SerieComprimida<T>();
+    inicio = std::chrono::steady_clock::now();
+    for (int i = 0; i < lecturas; i++) serie->insertar(senal(i));
+    double tSerieInsertar = segundosDesde(inicio);
+    long bytesSerie = bytesEnHeap() - heapInicial;
+
+    double recorridoLista = lecturasPorSegundo([&] {
+        double s = 0;
+        lista->paraCadaBloque([&](const T* d, int n) { s += (double)sumarLecturas(d, n); });
+        return s;
+    }, lecturas);
+    double recorridoSerie = lecturasPorSegundo([&] {
+        double s = 0;
+        serie->paraCadaBloque([&](const T* d, int n) { s += (double)sumarLecturas(d, n); });
+        return s;
+    }, lecturas);
+
+    printf("%-5s lista:      %6.2f bytes/lectura (%6.2f con indice)  insertar=%6.2f ns  recorrido=%7.0f Mlect/s\n",
+           tipo, (double)bytesLista / lecturas, (double)bytesListaIndice / lecturas,
+           tListaInsertar / lecturas * 1e9, recorridoLista / 1e6);
+    printf("%-5s comprimida: %6.2f bytes/lectura (%5.2f codificados)    insertar=%6.2f ns  recorrido=%7.0f Mlect/s\n",
+           tipo, (double)bytesSerie / lecturas, serie->bytesPorLectura(),
+           tSerieInsertar / lecturas * 1e9, recorridoSerie / 1e6);
+
+    delete serie;
+    delete lista;
+}
+
+/**
+ * @brief Historial comprimido sobre señales de sensor de variación lenta
+ */
+void benchCompresion() {
+    printf("\n== Compresion del historial (bloques de %d lecturas) ==\n", LECTURAS_POR_SELLO);
+    // Presión en hPa con deriva lenta y ruido de +-1
+    medirCompresion<int>("int", [](int i) { return 1013 + (i / 5000) % 20 + (int)((unsigned)i * 2654435761u >> 31); });
+    // Temperatura con resolución de 0.1 grados que cambia cada pocas lecturas
+    medirCompresion<float>("float", [](int i) { return (float)(200 + (i / 7) % 50) / 10.0f; });
+}
+
+/**
+ * @brief Mide consultas por intervalo de tiempo frente a filtrar el historial completo
+ * @tparam Serie ListaSensor<int, LECTURAS_POR_BLOQUE> o SerieComprimida<int>
+ * @param etiqueta Nombre del historial para la tabla
+ * @param serie Historial con una lectura por milisegundo desde la marca 1
+ * @param lecturas Lecturas del historial
+ */
+template <typename Serie>
+void medirVentana(const char* etiqueta, const Serie& serie, long lecturas) {
+    long anchos[] = {1000, 60000, 3600000};   // 1 s, 1 min, 1 h
+    for (int a = 0; a < 3; a++) {
+        long ancho = anchos[a];
+        int consultas = ancho >= 1000000 ? 5 : 200;
+        long encontradas = 0;
+        auto inicio = std::chrono::steady_clock::now();
+        for (int q = 0; q < consultas; q++) {
+            long long desde = 1 + (long long)(((unsigned long)q * 2654435761u) % (unsigned long)(lecturas - ancho));
+            encontradas += serie.consultarVentana(desde, desde + ancho - 1).cantidad;
+        }
+        double t = segundosDesde(inicio) / consultas;
+        printf("%-11s ventana=%-8ld %10.1f us/consulta  (%ld lecturas por ventana)\n",
+               etiqueta, ancho, t * 1e6, encontradas / consultas);
+    }
+}
+
+/**
+ * @brief Consultas por intervalo de tiempo sobre historiales de una lectura por milisegundo
+ */
+void benchVentana() {
+    printf("\n== Ventanas de tiempo: promedio/extremos de un intervalo ==\n");
+    const long lecturas = 8000000;   // ~2.2 h a 1 kHz
+    ListaSensor<int, LECTURAS_POR_BLOQUE>* lista = new ListaSensor<int, LECTURAS_POR_BLOQUE>();
+    SerieComprimida<int>* serie = new SerieComprimida<int>();
+    long heapInicial = bytesEnHeap();
+    auto inicio = std::chrono::steady_clock::now();
+    for (long i = 0; i < lecturas; i++) lista->insertar(1000 + (int)(i % 97), 1 + i);
+    double tLista = segundosDesde(inicio);
+    long bytesLista = bytesEnHeap() - heapInicial;
+    heapInicial = bytesEnHeap();
+    inicio = std::chrono::steady_clock::now();
+    for (long i = 0; i < lecturas; i++) serie->insertar(1000 + (int)(i % 97), 1 + i);
+    double tSerie = segundosDesde(inicio);
+    long bytesSerie = bytesEnHeap() - heapInicial;
+    printf("lista:      %5.2f bytes/lectura con marca, insertar=%5.2f ns\n",
+           (double)bytesLista / lecturas, tLista / lecturas * 1e9);
+    printf("comprimida: %5.2f bytes/lectura con marca, insertar=%5.2f ns\n",
+           (double)bytesSerie / lecturas, tSerie / lecturas * 1e9);
+
+    // Sin índice por tiempo: filtrar todas las lecturas por su marca
+    long long desde = lecturas / 2;
+    long long hasta = desde + 59999;
+    inicio = std::chrono::steady_clock::now();
+    VentanaLecturas<int> v;
+    lista->paraCadaLectura([&v, desde, hasta](int x, long long t) {
+        if (t >= desde && t <= hasta) v.agregar(x, t);
+    });
+    printf("recorrido completo (ventana=60000): %10.1f us  (%ld lecturas)\n",
+           segundosDesde(inicio) * 1e6, v.cantidad);
+
+    // Con el índice disperso por tiempo (se mantuvo al insertar)
+    inicio = std::chrono::steady_clock::now();
+    lista->consultarVentana(desde, hasta);
+    printf("primera consulta indexada (ventana=60000): %10.1f us\n", segundosDesde(inicio) * 1e6);
+    medirVentana("lista", *lista, lecturas);
+    medirVentana("comprimida", *serie, lecturas);
+    delete serie;
+    delete lista;
+}
+
+/**
+ * @brief Resúmenes por tiempo: costo al insertar y vistas largas frente al historial crudo
+ */
+void benchResumenes() {
+    printf("\n== Resumenes por tiempo (1 s, 1 min, 1 h, 1 dia) ==\n");
+    const long lecturas = 3456000;   // 400 días a una lectura cada 10 s
+    const long long paso = 10000;
+    ListaSensor<int, LECTURAS_POR_BLOQUE>* lista = new ListaSensor<int, LECTURAS_POR_BLOQUE>();
+    ResumenesTiempo<int>* resumenes = new ResumenesTiempo<int>();
+    auto inicio = std::chrono::steady_clock::now();
+    for (long i = 0; i < lecturas; i++) lista->insertar(1000 + (int)(i % 97), 1 + i * paso);
+    double tLista = segundosDesde(inicio);
+    inicio = std::chrono::steady_clock::now();
+    for (long i = 0; i < lecturas; i++) resumenes->agregar(1000 + (int)(i % 97), 1 + i * paso);
+    double tResumenes = segundosDesde(inicio);
+    printf("insertar: lista=%5.2f ns  resumenes=%5.2f ns/lectura  (%ld bytes de resumenes)\n",
+           tLista / lecturas * 1e9, tResumenes / lecturas * 1e9, resumenes->memoriaBytes());
+
+    long long fin = 1 + (lecturas - 1) * paso;
+    long long anchos[] = {3600000LL, 86400000LL, 30LL * 86400000LL, 365LL * 86400000LL};
+    const char* nombres[] = {"1 h", "1 dia", "30 dias", "365 dias"};
+    for (int a = 0; a < 4; a++) {
+        long long desde = fin - anchos[a] + 1;
+        int consultas = a < 2 ? 200 : 5;
+        long n = 0;
+        inicio = std::chrono::steady_clock::now();
+        for (int q = 0; q < consultas; q++) n += lista->consultarVentana(desde - q, fin - q).cantidad;
+        double tCrudo = segundosDesde(inicio) / consultas;
+        long long resolucion = 0;
+        inicio = std::chrono::steady_clock::now();
+        for (int q = 0; q < consultas; q++) n -= resumenes->consultar(desde - q, fin - q, &resolucion).cantidad;
+        double tResumen = segundosDesde(inicio) / consultas;
+        printf("ventana=%-9s historial=%10.1f us  resumenes=%8.2f us  (diferencia %ld lecturas, resolucion %lld ms)\n",
+               nombres[a], tCrudo * 1e6, tResumen * 1e6, n / consultas, resolucion);
+    }
+    delete resumenes;
+    delete lista;
+}
+
+/**
+ * @brief Bosquejo de cuantiles: costo por lectura, error frente al orden exacto y combinación de la flota
+ */
+void benchCuantiles() {
+    printf("\n== Bosquejo de cuantiles (KLL, K=%d) ==\n", BosquejoCuantiles::K);
+    const long lecturas = 10000000;
+    double* valores = new double[lecturas];
+    unsigned x = 12345;
+    for (long i = 0; i < lecturas; i++) {
+        x = x * 1664525u + 1013904223u;
+        // Presión alrededor de 1013 con colas: 1% de picos lejanos
+        valores[i] = (x >> 28) == 0 ? 1100.0 + (x >> 20) % 200 : 1000.0 + (x >> 16) % 27;
+    }
+    BosquejoCuantiles bosquejo;
+    auto inicio = std::chrono::steady_clock::now();
+    for (long i = 0; i < lecturas; i++) bosquejo.agregar(valores[i]);
+    double t = segundosDesde(inicio);
+    printf("agregar=%5.2f ns/lectura  muestras=%d  memoria=%ld bytes (vs %ld bytes de lecturas)\n",
+           t / lecturas * 1e9, bosquejo.getMuestras(), bosquejo.memoriaBytes(), lecturas * (long)sizeof(double));
+
+    double q[] = {0.5, 0.95, 0.99};
+    double estimado[3];
+    inicio = std::chrono::steady_clock::now();
+    for (int r = 0; r < 1000; r++) bosquejo.cuantiles(q, estimado, 3);
+    printf("consultar p50/p95/p99: %6.2f us\n", segundosDesde(inicio) / 1000 * 1e6);
+    std::sort(valores, valores + lecturas);
+    for (int j = 0; j < 3; j++) {
+        // Con valores repetidos el estimado ocupa un intervalo de rangos
+        double desde = (double)(std::lower_bound(valores, valores + lecturas, estimado[j]) - valores) / lecturas;
+        double hasta = (double)(std::upper_bound(valores, valores + lecturas, estimado[j]) - valores) / lecturas;
+        double error = q[j] < desde ? desde - q[j] : (q[j] > hasta ? q[j] - hasta : 0.0);
+        printf("p%-4g estimado=%8.1f exacto=%8.1f  error de rango=%.4f\n", q[j] * 100, estimado[j],
+               valores[(long)(q[j] * (lecturas - 1))], error);
+    }
+    delete[] valores;
+
+    // Percentiles de la flota sin tocar los historiales
+    ListaGestion gestor;
+    const int sensores = 1000;
+    for (int s = 0; s < sensores; s++) {
+        char nombre[32];
+        snprintf(nombre, sizeof(nombre), "P-%04d", s);
+        gestor.insertar(new SensorPresion(nombre));
+    }
+    for (long i = 0; i < 2000000; i++) {
+        gestor.obtener((int)(i % sensores))->agregarEntero(1000 + (int)(i % 97) + (int)(i % sensores) / 10);
+    }
+    inicio = std::chrono::steady_clock::now();
+    BosquejoCuantiles flota = gestor.combinarCuantiles();
+    double tFlota = segundosDesde(inicio);
+    flota.cuantiles(q, estimado, 3);
+    printf("flota de %d sensores: combinar=%8.1f us  p50=%g p95=%g p99=%g (%lld lecturas)\n",
+           sensores, tFlota * 1e6, estimado[0], estimado[1], estimado[2], flota.getCantidad());
+}
+
+/**
+ * @brief Borra los segmentos de un directorio de datos y el directorio
+ */
+void borrarDirectorio(const char* dir) {
+    DIR* d = opendir(dir);
+    if (d == nullptr) return;
+    struct dirent* entrada;
+    while ((entrada = readdir(d)) != nullptr) {
+        if (entrada->d_name[0] == '.') continue;
+        char ruta[512];
+        snprintf(ruta, sizeof(ruta), "%s/%s", dir, entrada->d_name);
+        unlink(ruta);
+    }
+    closedir(d);
+    rmdir(dir);
+}
+
+/**
+ * @brief Anexado a segmentos y arranque (restaurar) según lecturas por sensor
+ */
+void benchPersistencia() {
+    printf("\n== Persistencia: segmentos por sensor ==\n");
+    const int sensores = 16;
+    int lecturasPorSensor[] = {1000, 100000, 1000000};
+    for (int k = 0; k < 3; k++) {
+        char dir[] = "/tmp/iot_benchXXXXXX";
+        if (mkdtemp(dir) == nullptr) return;
+        int lecturas = lecturasPorSensor[k];
+
+        double tAnexar;
+        {
+            ListaGestion gestor;
+            AlmacenPersistente almacen(gestor, dir);
+            for (int s = 0; s < sensores; s++) {
+                char nombre[16];
+                snprintf(nombre, sizeof(nombre), "P-%03d", s);
+                SensorBase* sensor = new SensorPresion(nombre);
+                gestor.insertar(sensor);
+                almacen.adjuntar(sensor);
+            }
+            auto inicio = std::chrono::steady_clock::now();
+            for (int i = 0; i < lecturas; i++) {
+                for (int s = 0; s < sensores; s++) {
+                    gestor.obtener(s)->agregarEntero(1000 + i % 50);
+                }
+            }
+            almacen.sincronizar(true);
+            tAnexar = segundosDesde(inicio);
+        }
+
+        ListaGestion gestor;
+        AlmacenPersistente almacen(gestor, dir);
+        auto inicio = std::chrono::steady_clock::now();
+        int restaurados = almacen.restaurar();
+        double tRestaurar = segundosDesde(inicio);
+        inicio = std::chrono::steady_clock::now();
+        ResultadoProceso r = gestor.obtener(0)->procesar();
+        double tPrimerUso = segundosDesde(inicio);
+
+        printf("%d sensores x %-8d anexar=%6.1f ns/lectura  restaurar=%7.3f ms  primer uso de un sensor=%8.3f ms (%d lecturas)\n",
+               restaurados, lecturas, tAnexar / ((double)lecturas * sensores) * 1e9, tRestaurar * 1e3,
+               tPrimerUso * 1e3, r.lecturas);
+        borrarDirectorio(dir);
+    }
+}
+
+int fallas = 0;  ///< Verificaciones fallidas (el programa termina con código 1)
+
+/**
+ * @brief Registra el resultado de una verificación
+ * @param ok Resultado
+ * @param descripcion Qué se verificó
+ */
+void verificar(bool ok, const char* descripcion) {
+    if (!ok) {
+        printf("FALLA: %s\n", descripcion);
+        fallas++;
+    }
+}
+
+/**
+ * @brief Igualdad exacta: bit a bit para float (distingue -0.0 de 0.0)
+ */
+template <typename T>
+bool mismoValor(T a, T b) {
+    return memcmp(&a, &b, sizeof(T)) == 0;
+}
+
+/**
+ * @brief Igualdad de promedios: exacta para int, relativa para float (el orden de la suma difiere)
+ */
+template <typename T>
+bool mismoPromedio(T a, T b) {
+    if (std::is_integral<T>::value || mismoValor(a, b)) return true;
+    return std::fabs((double)a - (double)b) <= 1e-4 * std::fabs((double)a);
+}
+
+/**
+ * @brief Compara lecturas y marcas de una serie comprimida con las de una lista
+ * @return true si coinciden en orden, valor (bit a bit) y marca
+ */
+template <typename T, typename Serie>
+bool mismasLecturas(const ListaSensor<T, LECTURAS_POR_BLOQUE>& lista, const Serie& serie) {
+    if (lista.getTamanio() != serie.getTamanio()) return false;
+    T* valores = new T[lista.getTamanio() > 0 ? lista.getTamanio() : 1];
+    long long* marcas = new long long[lista.getTamanio() > 0 ? lista.getTamanio() : 1];
+    int n = 0;
+    lista.paraCadaLectura([&](T x, long long t) {
+        valores[n] = x;
+        marcas[n++] = t;
+    });
+    bool iguales = true;
+    int i = 0;
+    serie.paraCadaLectura([&](T x, long long t) {
+        if (i >= n || !mismoValor(x, valores[i]) || t != marcas[i]) iguales = false;
+        i++;
+    });
+    delete[] valores;
+    delete[] marcas;
+    return iguales && i == n;
+}
+
+/**
+ * @brief Compara una serie comprimida contra una lista con las mismas lecturas
+ * @param valores Lecturas a insertar
+ * @param marcas Marcas crecientes (con saltos mayores a INT_MAX)
+ * @param n Número de lecturas
+ * @param tipo Nombre del tipo para los mensajes
+ */
+template <typename T>
+void verificarSerie(const T* valores, const long long* marcas, int n, const char* tipo) {
+    char msg[160];
+    ListaSensor<T, LECTURAS_POR_BLOQUE> lista;
+    SerieComprimida<T> serie;
+    for (int i = 0; i < n; i++) {
+        lista.insertar(valores[i], marcas[i]);
+        serie.insertar(valores[i], marcas[i]);
+    }
+    snprintf(msg, sizeof(msg), "%s: paraCadaLectura de la serie comprimida", tipo);
+    verificar(mismasLecturas(lista, serie), msg);
+    snprintf(msg, sizeof(msg), "%s: calcularPromedio", tipo);
+    verificar(mismoPromedio(lista.calcularPromedio(), serie.calcularPromedio()), msg);
+    snprintf(msg, sizeof(msg), "%s: obtenerMinimo / obtenerMaximo", tipo);
+    verificar(mismoValor(lista.obtenerMinimo(), serie.obtenerMinimo()) &&
+              mismoValor(lista.obtenerMaximo(), serie.obtenerMaximo()), msg);
+    for (int q = 0; q < 20; q++) {
+        long long desde = marcas[(q * 7919) % n];
+        long long hasta = marcas[(q * 7919 + q * 131) % n];
+        if (hasta < desde) std::swap(desde, hasta);
+        VentanaLecturas<T> a = lista.consultarVentana(desde, hasta);
+        VentanaLecturas<T> b = serie.consultarVentana(desde, hasta);
+        snprintf(msg, sizeof(msg), "%s: consultarVentana [%lld, %lld]", tipo, desde, hasta);
+        verificar(a.cantidad == b.cantidad && mismoValor(a.minimo, b.minimo) &&
+                  mismoValor(a.maximo, b.maximo) && a.primera == b.primera && a.ultima == b.ultima, msg);
+    }
+
+    // eliminarMinimo vuelve a sellar el bloque del mínimo o lo quita si queda vacío
+    bool iguales = true;
+    int eliminadas = 0;
+    while (lista.getTamanio() > 0 && iguales) {
+        T a = lista.eliminarMinimo();
+        T b = serie.eliminarMinimo();
+        eliminadas++;
+        iguales = mismoValor(a, b) && lista.getTamanio() == serie.getTamanio();
+        if (iguales && (eliminadas % 97 == 0 || lista.getTamanio() < 3)) {
+            iguales = mismasLecturas(lista, serie) &&
+                      mismoValor(lista.obtenerMinimo(), serie.obtenerMinimo()) &&
+                      mismoValor(lista.obtenerMaximo(), serie.obtenerMaximo());
+        }
+    }
+    snprintf(msg, sizeof(msg), "%s: eliminarMinimo (%d de %d lecturas)", tipo, eliminadas, n);
+    verificar(iguales && serie.getTamanio() == 0 && serie.getNumBloques() == 0, msg);
+
+    // La retención quita bloques completos (quitarBloque): queda un sufijo de al menos maxLecturas
+    SerieComprimida<T> retenida;
+    for (int i = 0; i < n; i++) retenida.insertar(valores[i], marcas[i]);
+    retenida.establecerRetencion(n / 3, 0.0);
+    ListaSensor<T, LECTURAS_POR_BLOQUE> sufijo;
+    for (int i = n - retenida.getTamanio(); i < n; i++) sufijo.insertar(valores[i], marcas[i]);
+    snprintf(msg, sizeof(msg), "%s: retención por bloques (%d lecturas retenidas)", tipo, retenida.getTamanio());
+    verificar(retenida.getTamanio() >= n / 3 && retenida.getTamanio() < n / 3 + LECTURAS_POR_SELLO &&
+              retenida.getDescartadas() == n - retenida.getTamanio() && mismasLecturas(sufijo, retenida), msg);
+}
+
+/**
+ * @brief Ida y vuelta de SerieComprimida contra ListaSensor con valores aleatorios y extremos
+ */
+void verificarCompresion() {
+    printf("\n== Verificacion: SerieComprimida contra ListaSensor ==\n");
+    const int n = 7 * LECTURAS_POR_SELLO + 45;   // Varios bloques sellados y una cola parcial
+    int* enteros = new int[n];
+    float* flotantes = new float[n];
+    long long* marcas = new long long[n];
+    const int extremosInt[] = {INT_MIN, INT_MAX, 0, -1, 1, INT_MIN + 1, INT_MAX - 1};
+    const float extremosFloat[] = {0.0f, -0.0f, 1e-45f, -1e-45f, FLT_MIN / 4, FLT_MIN, FLT_MAX, -FLT_MAX, 1.0f, -1.0f};
+    unsigned long long x = 88172645463325252ULL;
+    long long marca = 1;
+    for (int i = 0; i < n; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        int tramo = (i / 300) % 4;
+        if (tramo == 0) {
+            // Aleatorios en todo el rango (deltas enormes)
+            enteros[i] = (int)(uint32_t)x;
+            uint32_t bitsFloat = (uint32_t)(x >> 32);
+            if ((bitsFloat & 0x7F800000u) == 0x7F800000u) bitsFloat &= 0xFF7FFFFFu;  // Sin NaN ni infinitos
+            memcpy(&flotantes[i], &bitsFloat, 4);
+        } else if (tramo == 1) {
+            enteros[i] = extremosInt[x % 7];
+            flotantes[i] = extremosFloat[x % 10];
+        } else if (tramo == 2) {
+            // Señal suave, el caso para el que está pensada la compresión
+            enteros[i] = 1013 + (i % 17);
+            flotantes[i] = (float)(200 + (i / 7) % 50) / 10.0f;
+        } else {
+            // Alterna los extremos: delta y delta de deltas máximos
+            enteros[i] = (i & 1) ? INT_MAX : INT_MIN;
+            flotantes[i] = (i & 1) ? FLT_MAX : -FLT_MAX;
+        }
+        // Marcas repetidas, pasos irregulares y saltos mayores que INT_MAX ms
+        marcas[i] = marca;
+        unsigned long long salto = (x >> 40) % 1000;
+        marca += salto < 900 ? (long long)(salto % 5) : salto < 995 ? (long long)salto * 1000 : 3000000000LL;
+    }
+    int fallasPrevias = fallas;
+    verificarSerie<int>(enteros, marcas, n, "int");
+    verificarSerie<float>(flotantes, marcas, n, "float");
+    printf("%d lecturas por tipo: %s\n", n, fallas == fallasPrevias ? "OK" : "con fallas");
+    delete[] enteros;
+    delete[] flotantes;
+    delete[] marcas;
+}
+
+/**
+ * @brief Tamaño de un archivo
+ */
+long long tamanioArchivo(const char* ruta) {
+    struct stat info;
+    return stat(ruta, &info) == 0 ? (long long)info.st_size : -1;
+}
+
+/**
+ * @brief Invierte un byte de un archivo
+ */
+void danarByte(const char* ruta, long long pos) {
+    int fd = open(ruta, O_RDWR);
+    unsigned char b;
+    if (pread(fd, &b, 1, pos) == 1) {
+        b ^= 0x5A;
+        if (pwrite(fd, &b, 1, pos) != 1) fallas++;
+    }
+    close(fd);
+}
+
+/**
+ * @brief Recupera un segmento y cuenta las lecturas entregadas
+ * @param ruta Archivo del segmento
+ * @param truncados Recibe los bytes de cola descartados
+ * @return Lecturas recuperadas, -1 si el segmento no abre o si alguna
+ *         lectura no es la esperada (valor i con marca base + i)
+ */
+int recuperarSegmento(const char* ruta, long long base, long long* truncados) {
+    SegmentoSensor s;
+    if (!s.recuperar(ruta)) return -1;
+    *truncados = s.getBytesTruncados();
+    int n = 0;
+    bool correctas = true;
+    s.paraCadaLoteMapeado<int>([&](const int* d, const int32_t* desfases, long long inicio, int cantidad) {
+        for (int i = 0; i < cantidad; i++, n++) {
+            // Pared <-> monótono se redondea a ms en cada sentido
+            long long error = inicio + desfases[i] - (base + n);
+            if (d[i] != n || error < -2 || error > 2) correctas = false;
+        }
+    });
+    s.liberarMapa();
+    return correctas ? n : -1;
+}
+
+/**
+ * @brief Recuperación de segmentos tras cortes y daños simulados
+ *
+ * Cada caso parte de un segmento con 3 lotes completos y uno parcial.
+ */
+void verificarSegmentos() {
+    printf("\n== Verificacion: recuperacion de segmentos ==\n");
+    char dir[] = "/tmp/iot_verifXXXXXX";
+    if (mkdtemp(dir) == nullptr) {
+        verificar(false, "mkdtemp");
+        return;
+    }
+    char ruta[512];
+    snprintf(ruta, sizeof(ruta), "%s/S.seg", dir);
+    const int lecturas = 3 * LECTURAS_POR_LOTE + 100;
+    const long long cabecera = sizeof(CabeceraSegmento);
+    const long long loteLleno = sizeof(CabeceraLote) + LECTURAS_POR_LOTE * 8;
+    const long long completo = cabecera + 3 * loteLleno + (long long)sizeof(CabeceraLote) + 100 * 8;
+    long long base = instanteIngestaMs();
+
+    struct Caso {
+        const char* descripcion;
+        int lotesDanados;       ///< Lote cuyo CRC se rompe (0 = ninguno, 1 = el primero)
+        bool danarCabecera;     ///< Rompe el CRC de la cabecera
+        long long recorte;      ///< Bytes que se quitan al final (corte a media escritura)
+        long long basura;       ///< Bytes que se agregan al final (escritura no confirmada)
+        int esperadas;          ///< Lecturas recuperadas
+        long long tamanio;      ///< Tamaño del archivo tras recuperar
+        long long truncados;    ///< getBytesTruncados()
+    };
+    const Caso casos[] = {
+        {"intacto", 0, false, 0, 0, lecturas, completo, 0},
+        {"corte dentro del ultimo lote", 0, false, 37, 0, 3 * LECTURAS_POR_LOTE,
+         cabecera + 3 * loteLleno, (long long)sizeof(CabeceraLote) + 100 * 8 - 37},
+        {"cola sin confirmar", 0, false, 0, 30, lecturas, completo, 30},
+        {"CRC del lote 2 (confirmado)", 2, false, 0, 0, LECTURAS_POR_LOTE, completo, 0},
+        {"CRC de la cabecera", 0, true, 0, 0, lecturas, completo, 0},
+        {"CRC de la cabecera y del lote 3", 3, true, 0, 0, 2 * LECTURAS_POR_LOTE,
+         cabecera + 2 * loteLleno, loteLleno + (long long)sizeof(CabeceraLote) + 100 * 8},
+    };
+    for (const Caso& c : casos) {
+        unlink(ruta);
+        {
+            SegmentoSensor s;
+            if (!s.crear(ruta, "S", 'i', 0)) {
+                verificar(false, "crear segmento");
+                continue;
+            }
+            for (int i = 0; i < lecturas; i++) s.anexar(&i, base + i);
+        }
+        if (c.recorte > 0 && truncate(ruta, completo - c.recorte) != 0) fallas++;
+        if (c.basura > 0) {
+            int fd = open(ruta, O_WRONLY | O_APPEND);
+            unsigned char basura[64];
+            memset(basura, 0xA7, sizeof(basura));
+            if (write(fd, basura, c.basura) != c.basura) fallas++;
+            close(fd);
+        }
+        if (c.lotesDanados > 0) {
+            // Un byte de las lecturas del lote: solo lo detecta el CRC
+            danarByte(ruta, cabecera + (c.lotesDanados - 1) * loteLleno + (long long)sizeof(CabeceraLote) + 5);
+        }
+        if (c.danarCabecera) {
+            danarByte(ruta, offsetof(CabeceraSegmento, crc));
+        }
+        long long truncados = -1;
+        int recuperadas = recuperarSegmento(ruta, base, &truncados);
+        long long tamanio = tamanioArchivo(ruta);
+        // Reabrir no debe descartar nada más: la cabecera quedó confirmada
+        long long truncados2 = -1;
+        int segunda = recuperarSegmento(ruta, base, &truncados2);
+        bool ok = recuperadas == c.esperadas && tamanio == c.tamanio && truncados == c.truncados &&
+                  segunda == c.esperadas && truncados2 == 0 && tamanioArchivo(ruta) == c.tamanio;
+        printf("%-34s lecturas=%4d (esperadas %4d)  archivo=%6lld bytes (esperados %6lld)  %s\n",
+               c.descripcion, recuperadas, c.esperadas, tamanio, c.tamanio, ok ? "OK" : "FALLA");
+        if (!ok) fallas++;
+    }
+    unlink(ruta);
+    rmdir(dir);
+}
+
+/**
+ * @brief Costo de la instrumentación: reloj, histograma y agregar() de un sensor
+ */
+void benchMetricas() {
+    printf("\n== Metricas: costo por lectura ==\n");
+    const int lecturas = 5000000;
+
+    volatile long long sumidero = 0;
+    auto inicio = std::chrono::steady_clock::now();
+    for (int i = 0; i < lecturas; i++) sumidero = sumidero + relojNs();
+    double tReloj = segundosDesde(inicio);
+
+    HistogramaLatencia histograma;
+    inicio = std::chrono::steady_clock::now();
+    for (int i = 0; i < lecturas; i++) histograma.registrar(i & 0xFFFF);
+    double tHistograma = segundosDesde(inicio);
+
+    ListaSensor<int, LECTURAS_POR_BLOQUE>* lista = new ListaSensor<int, LECTURAS_POR_BLOQUE>();
+    inicio = std::chrono::steady_clock::now();
+    for (int i = 0; i < lecturas; i++) lista->insertar(i % 1000);
+    double tLista = segundosDesde(inicio);
+    delete lista;
+
+    SensorPresion* sensor = new SensorPresion("P-bench");
+    inicio = std::chrono::steady_clock::now();
+    for (int i = 0; i < lecturas; i++) sensor->agregarEntero(i % 1000);
+    double tSensor = segundosDesde(inicio);
+
+    printf("relojNs()          %6.2f ns\n", tReloj / lecturas * 1e9);
+    printf("histograma         %6.2f ns\n", tHistograma / lecturas * 1e9);
+    printf("ListaSensor        %6.2f ns/insercion\n", tLista / lecturas * 1e9);
+    printf("SensorPresion      %6.2f ns/insercion (con metricas, p99 ingesta=%llu ns)\n",
+           tSensor / lecturas * 1e9, (unsigned long long)sensor->getMetricas().latenciaIngesta.percentil(99));
+
+    // Exportación de 1000 sensores
+    ListaGestion gestor;
+    gestor.insertar(sensor);
+    for (int i = 1; i < 1000; i++) {
+        char nombre[24];
+        snprintf(nombre, sizeof(nombre), "P-%04d", i);
+        SensorPresion* s = new SensorPresion(nombre);
+        for (int j = 0; j < 100; j++) s->agregarEntero(j);
+        gestor.insertar(s);
+    }
+    ExportadorMetricas exportador(gestor, "/tmp/iot_bench_metricas.prom", 3600.0);
+    const int exportaciones = 20;
+    inicio = std::chrono::steady_clock::now();
+    for (int i = 0; i < exportaciones; i++) exportador.exportar();
+    printf("exportar 1000 sensores %6.2f ms\n", segundosDesde(inicio) / exportaciones * 1e3);
+    remove("/tmp/iot_bench_metricas.prom");
+}
+
+/**
+ * @brief Lectura flotante determinista i para los barridos
+ */
+float lecturaBarrido(long i) {
+    return (float)(i * 7919 % 100000) / 10.0f;
+}
+
+/**
+ * @brief Barrido de ListaSensor: inserción, promedio, eliminarMinimo, copia y empalme
+ * @param n Lecturas de la lista
+ */
+void barrerLista(long n) {
+    typedef ListaSensor<float, LECTURAS_POR_BLOQUE> Lista;
+    // Repetir estructuras pequeñas para medir al menos ~1e6 operaciones
+    long rondas = 1000000 / n > 1 ? 1000000 / n : 1;
+
+    for (int conIndice = 0; conIndice <= 1; conIndice++) {
+        double t = 0.0;
+        for (long r = 0; r < rondas; r++) {
+            Lista* lista = new Lista();
+            if (conIndice) lista->activarIndice();
+            auto inicio = std::chrono::steady_clock::now();
+            for (long i = 0; i < n; i++) lista->insertar(lecturaBarrido(i));
+            t += segundosDesde(inicio);
+            delete lista;
+        }
+        emitirFila(conIndice ? "ListaSensor::insertar+indice" : "ListaSensor::insertar", n,
+                   t / ((double)n * rondas) * 1e9, n * rondas);
+    }
+
+    Lista* lista = new Lista();
+    for (long i = 0; i < n; i++) lista->insertar(lecturaBarrido(i));
+
+    const long consultas = 1000000;
+    volatile float sumidero = 0.0f;
+    auto inicio = std::chrono::steady_clock::now();
+    for (long i = 0; i < consultas; i++) sumidero = sumidero + lista->calcularPromedio();
+    emitirFila("ListaSensor::calcularPromedio", n, segundosDesde(inicio) / consultas * 1e9, consultas);
+
+    long copias = rondas;
+    inicio = std::chrono::steady_clock::now();
+    for (long c = 0; c < copias; c++) {
+        Lista copia(*lista);
+        sumidero = sumidero + (float)copia.getTamanio();
+    }
+    emitirFila("ListaSensor(const ListaSensor&)", n, segundosDesde(inicio) / copias * 1e9, copias);
+
+    // Lotes de 1000 lecturas anexados a un historial de n lecturas
+    const int lotes = 200;
+    Lista* pendientes = new Lista[lotes];
+    for (int l = 0; l < lotes; l++) {
+        for (int i = 0; i < 1000; i++) pendientes[l].insertar(lecturaBarrido(i + l));
+    }
+    inicio = std::chrono::steady_clock::now();
+    for (int l = 0; l < lotes; l++) lista->empalmar(pendientes[l]);
+    emitirFila("ListaSensor::empalmar(lote de 1000)", n, segundosDesde(inicio) / lotes * 1e9, lotes);
+    delete[] pendientes;
+    delete lista;
+
+    // eliminarMinimo: sin índice es O(n) por llamada, así que se acota el
+    // número de extracciones en listas grandes y se repite en las pequeñas
+    long porRonda = 20000000 / n > 20 ? 20000000 / n : 20;
+    if (porRonda > n / 2) porRonda = n / 2;
+    long rondasMin = 100000 / porRonda > 1 ? 100000 / porRonda : 1;
+    if (rondasMin > 20000000 / n) rondasMin = 20000000 / n > 1 ? 20000000 / n : 1;
+    for (int conIndice = 0; conIndice <= 1; conIndice++) {
+        double t = 0.0;
+        for (long r = 0; r < rondasMin; r++) {
+            Lista* l = new Lista();
+            if (conIndice) l->activarIndice();
+            for (long i = 0; i < n; i++) l->insertar(lecturaBarrido(i));
+            inicio = std::chrono::steady_clock::now();
+            for (long k = 0; k < porRonda; k++) sumidero = sumidero + l->eliminarMinimo();
+            t += segundosDesde(inicio);
+            delete l;
+        }
+        emitirFila(conIndice ? "ListaSensor::eliminarMinimo+indice" : "ListaSensor::eliminarMinimo", n,
+                   t / ((double)porRonda * rondasMin) * 1e9, porRonda * rondasMin);
+    }
+}
+
+/**
+ * @brief Barrido de ListaGestion: insertar y buscar con n sensores
+ * @param n Sensores registrados
+ */
+void barrerGestion(long n) {
+    char (*nombres)[24] = new char[n][24];
+    for (long i = 0; i < n; i++) {
+        snprintf(nombres[i], sizeof(nombres[i]), "P-%07ld", i);
+    }
+    long rondas = 100000 / n > 1 ? 100000 / n : 1;
+    double t = 0.0;
+    ListaGestion* gestor = nullptr;
+    for (long r = 0; r < rondas; r++) {
+        delete gestor;
+        gestor = new ListaGestion();
+        SensorBase** sensores = new SensorBase*[n];
+        for (long i = 0; i < n; i++) sensores[i] = new SensorPresion(nombres[i]);
+        auto inicio = std::chrono::steady_clock::now();
+        for (long i = 0; i < n; i++) gestor->insertar(sensores[i]);
+        t += segundosDesde(inicio);
+        delete[] sensores;
+    }
+    emitirFila("ListaGestion::insertar", n, t / ((double)n * rondas) * 1e9, n * rondas);
+
+    const long consultas = 1000000;
+    volatile long encontrados = 0;
+    auto inicio = std::chrono::steady_clock::now();
+    for (long i = 0; i < consultas; i++) {
+        if (gestor->buscar(nombres[i * 7919 % n]) != nullptr) encontrados = encontrados + 1;
+    }
+    emitirFila("ListaGestion::buscar", n, segundosDesde(inicio) / consultas * 1e9, consultas);
+    delete gestor;
+    delete[] nombres;
+}
+
+/**
+ * @brief Barrido del análisis de texto: n líneas por SensorBase::agregarLectura
+ * @param n Líneas entregadas al sensor
+ */
+void barrerLineas(long n) {
+    const int distintas = 4096;
+    char (*lineas)[16] = new char[distintas][16];
+    for (int i = 0; i < distintas; i++) {
+        snprintf(lineas[i], sizeof(lineas[i]), "%.1f", lecturaBarrido(i));
+    }
+    long rondas = 1000000 / n > 1 ? 1000000 / n : 1;
+    double t = 0.0;
+    for (long r = 0; r < rondas; r++) {
+        SensorBase* sensor = new SensorTemperatura("T-BARRIDO");
+        auto inicio = std::chrono::steady_clock::now();
+        for (long i = 0; i < n; i++) sensor->agregarLectura(lineas[i % distintas]);
+        t += segundosDesde(inicio);
+        delete sensor;
+    }
+    emitirFila("SensorBase::agregarLectura", n, t / ((double)n * rondas) * 1e9, n * rondas);
+    delete[] lineas;
+}
+
+/**
+ * @brief Barrido de tamaños 1e2 .. maximo de las operaciones principales
+ * @param maximo Tamaño mayor (ListaGestion se limita a 1e6 sensores por memoria)
+ */
+void benchBarrido(long maximo) {
+    if (formatoSalida == SALIDA_TEXTO) {
+        printf("\n== Barrido de tamaños (1e2 .. %ld) ==\n", maximo);
+    }
+    for (long n = 100; n <= maximo; n *= 10) {
+        barrerLista(n);
+        if (n <= 1000000) barrerGestion(n);
+        barrerLineas(n);
+    }
+    if (formatoSalida == SALIDA_JSON) {
+        printf(filasEmitidas == 0 ? "[]\n" : "\n]\n");
+    }
+}
+
+/**
+ * @brief Punto de entrada del benchmark
+ * @param argc Número de argumentos
+ * @param argv Argumentos; el primero opcional selecciona la sección
+ */
+int main(int argc, char* argv[]) {
+    // Las estructuras registran cada operación en consola; se silencian
+    // std::cout y el registro para medir únicamente el costo de las estructuras.
+    std::cout.setstate(std::ios::badbit);
+    Registro::instancia().establecerNivel(NIVEL_ERROR);
+
+    const char* seccion = "todas";
+    long maximoBarrido = 10000000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--csv") == 0) {
+            formatoSalida = SALIDA_CSV;
+        } else if (strcmp(argv[i], "--json") == 0) {
+            formatoSalida = SALIDA_JSON;
+        } else if (strncmp(argv[i], "--max=", 6) == 0) {
+            maximoBarrido = atol(argv[i] + 6);
+        } else {
+            seccion = argv[i];
+        }
+    }
+    // Las salidas legibles por máquina contienen solo el barrido
+    if (formatoSalida != SALIDA_TEXTO) {
+        seccion = "barrido";
+    }
+    bool todas = strcmp(seccion, "todas") == 0;
+
+    if (todas || strcmp(seccion, "almacenamiento") == 0) {
+        benchAlmacenamiento();
+    }
+    if (todas || strcmp(seccion, "barrido") == 0) {
+        benchBarrido(maximoBarrido);
+    }
+    if (todas || strcmp(seccion, "arena") == 0) {
+        benchArena();
+    }
+    if (todas || strcmp(seccion, "indice") == 0) {
+        benchIndice();
+    }
+    if (todas || strcmp(seccion, "buscar") == 0) {
+        benchBuscar();
+    }
+    if (todas || strcmp(seccion, "enrutar") == 0) {
+        benchEnrutar();
+    }
+    if (todas || strcmp(seccion, "registro") == 0) {
+        benchRegistro();
+    }
+    if (todas || strcmp(seccion, "paralelo") == 0) {
+        benchParalelo();
+    }
+    if (todas || strcmp(seccion, "tipada") == 0) {
+        benchTipada();
+    }
+    if (todas || strcmp(seccion, "concurrente") == 0) {
+        benchConcurrente();
+    }
+    if (todas || strcmp(seccion, "simd") == 0) {
+        benchSimd();
+    }
+    if (todas || strcmp(seccion, "retencion") == 0) {
+        benchRetencion();
+    }
+    if (todas || strcmp(seccion, "compresion") == 0) {
+        benchCompresion();
+    }
+    if (todas || strcmp(seccion, "ventana") == 0) {
+        benchVentana();
+    }
+    if (todas || strcmp(seccion, "resumenes") == 0) {
+        benchResumenes();
+    }
+    if (todas || strcmp(seccion, "cuantiles") == 0) {
+        benchCuantiles();
+    }
+    if (todas || strcmp(seccion, "persistencia") == 0) {
+        benchPersistencia();
+    }
+    if (todas || strcmp(seccion, "metricas") == 0) {
+        benchMetricas();
+    }
+    if (todas || strcmp(seccion, "serial") == 0) {
+        benchSerial();
+    }
+    if (todas || strcmp(seccion, "ingesta") == 0) {
+        benchIngesta();
+    }
+    if (todas || strcmp(seccion, "protocolo") == 0) {
+        benchProtocolo();
+    }
+    if (todas || strcmp(seccion, "tuberia") == 0) {
+        benchTuberia();
+    }
+    if (todas || strcmp(seccion, "lote") == 0) {
+        benchLote();
+    }
+    if (todas || strcmp(seccion, "verificacion") == 0) {
+        verificarCompresion();
+        verificarSegmentos();
+    }
+    return fallas > 0 ? 1 : 0;
+}
@@ -8,11 +8,35 @@
  *
  * @section Secciones_Proyecto Estructura del Proyecto:
  * Para ver el detalle de las clases, revisa el menú superior "Clases".
- * @li SensorBase.h: Interfaz abstracta para todos los sensores.
+ * @li SensorBase.h: Interfaz abstracta para todos los sensores e historial común por tipo de lectura (SensorHistorial).
  * @li SensorTemperatura.h: Implementación para datos FLOAT.
  * @li SensorPresion.h: Implementación para datos INT.
  * @li ListaSensor.h: Contenedor genérico (Lista Enlazada) para lecturas.
  * @li ListaGestion.h: Contenedor no genérico para punteros a SensorBase (Polimorfismo).
+ * @li GestionTipada.h: Registro alternativo con un almacén por tipo de sensor y despacho sin llamadas virtuales.
+ * @li GestionConcurrente.h: Registro seguro entre hilos con candados por fragmento de nombres y por sensor.
+ * @li ArenaNodos.h: Reservador por bloques para los nodos de ambas listas.
+ * @li AcumuladorLecturas.h: Agregados incrementales (promedio, varianza, extremos).
+ * @li IndiceOrden.h: Índice de estadísticos de orden para mínimo, máximo y percentiles.
+ * @li IndiceNombres.h: Tabla hash de nombres de sensor a handles (búsqueda O(1)).
+ * @li SerialPort.h: Lectura serial con búfer circular y espera por poll().
+ * @li MotorIngesta.h: Ingesta de varios puertos con un solo bucle epoll.
+ * @li ProtocoloBinario.h: Tramas binarias con CRC, detectadas junto al protocolo de texto.
+ * @li EnrutadorLineas.h: Enrutamiento de líneas "ID:valor" al sensor de su ID.
+ * @li Registro.h: Registro por niveles con escritura asíncrona (salida de errores).
+ * @li PoolTrabajo.h: Pool de hilos con robo de trabajo (procesamiento paralelo, variable IOT_PROCESO_PARALELO).
+ * @li KernelesSimd.h: Reducciones SSE4.1/AVX2 con selección en ejecución.
+ * @li SerieComprimida.h: Historial comprimido por bloques sellados (delta-de-delta / XOR).
+ * @li SegmentoSensor.h: Archivo de lecturas por sensor con lotes verificados por CRC.
+ * @li AlmacenPersistente.h: Restauración de sensores desde sus segmentos (variable IOT_DIRECTORIO_DATOS).
+ * @li Metricas.h: Contadores e histogramas de latencia por sensor.
+ * @li RelojDispositivo.h: Marcas de tiempo del dispositivo y de pared traducidas al reloj de los historiales.
+ * @li ResumenesTiempo.h: Resúmenes por segundo, minuto, hora y día mantenidos al insertar (vistas largas sin el historial crudo).
+ * @li BosquejoCuantiles.h: Bosquejo KLL combinable para p50/p95/p99 por sensor y de toda la flota.
+ * @li ExportadorMetricas.h: Exportación periódica en formato Prometheus (variable IOT_ARCHIVO_METRICAS).
+ * @li ColaSpsc.h: Cola circular sin bloqueo de un productor y un consumidor.
+ * @li TuberiaIngesta.h: Lector serial en su propio hilo separado del almacenamiento (variable IOT_INTERVALO_PROCESO).
+ * @li ModoLote.h: Ejecución sin menú con manifiesto de sensores y resultados CSV/JSON (ver ejecutarSinMenu()).
  * * @author Eliezer Mores Oyervides
  * @date 2025
  */
@@ -22,139 +46,29 @@
 #include "SensorTemperatura.h"
 #include "SensorPresion.h"
 #include "ListaGestion.h"
+#include "SerialPort.h"
+#include "MotorIngesta.h"
+#include "ProtocoloBinario.h"
+#include "EnrutadorLineas.h"
+#include "Registro.h"
+#include "AlmacenPersistente.h"
+#include "ExportadorMetricas.h"
+#include "TuberiaIngesta.h"
+#include "ModoLote.h"
 #include <iostream>
 #include <cstring>
-
-// Para comunicación serial en Linux
-#include <fcntl.h>
-#include <unistd.h>
-#include <termios.h>
+#include <cstdlib>
+#include <cstdio>
+#include <ctime>
 
 using namespace std;
 
-/**
- * @brief Clase para manejar la comunicación con el puerto serial en Linux
- */
-class SerialPort {
-private:
-    int fd;              ///< File descriptor del puerto serial
-    bool conectado;      ///< Estado de la conexión
-
-public:
-    /**
-     * @brief Constructor - Inicializa el puerto serial
-     * @param puerto Nombre del puerto (ej: "/dev/ttyACM0" o "/dev/ttyUSB0")
-     */
-    SerialPort(const char* puerto) {
-        conectado = false;
-        
-        // Abrir el puerto serial
-        fd = open(puerto, O_RDWR | O_NOCTTY);
-        
-        if (fd != -1) {
-            struct termios tty;
-            memset(&tty, 0, sizeof(tty));
-            
-            // Obtener configuración actual
-            if (tcgetattr(fd, &tty) == 0) {
-                // Configurar velocidad (9600 baud)
-                cfsetospeed(&tty, B9600);
-                cfsetispeed(&tty, B9600);
-                
-                // Configurar 8N1 (8 bits, sin paridad, 1 bit de parada)
-                tty.c_cflag &= ~PARENB;        // Sin paridad
-                tty.c_cflag &= ~CSTOPB;        // 1 bit de parada
-                tty.c_cflag &= ~CSIZE;
-                tty.c_cflag |= CS8;            // 8 bits por byte
-                tty.c_cflag &= ~CRTSCTS;       // Sin control de flujo hardware
-                tty.c_cflag |= CREAD | CLOCAL; // Activar lectura, ignorar líneas de control
-                
-                // Configurar modo raw (sin procesamiento)
-                tty.c_lflag &= ~ICANON;        // Modo no canónico
-                tty.c_lflag &= ~ECHO;          // Sin eco
-                tty.c_lflag &= ~ISIG;          // Sin señales
-                
-                // Desactivar control de flujo software
-                tty.c_iflag &= ~(IXON | IXOFF | IXANY);
-                tty.c_iflag &= ~(IGNBRK|BRKINT|PARMRK|ISTRIP|INLCR|IGNCR|ICRNL);
-                
-                // Configurar modo de salida raw
-                tty.c_oflag &= ~OPOST;
-                tty.c_oflag &= ~ONLCR;
-                
-                // Aplicar configuración
-                if (tcsetattr(fd, TCSANOW, &tty) == 0) {
-                    conectado = true;
-                    cout << "Conectado al puerto " << puerto << endl;
-                    sleep(2); // Esperar que Arduino se reinicie
-                } else {
-                    cout << "No se pudo configurar el puerto " << puerto << endl;
-                    close(fd);
-                }
-            } else {
-                cout << "No se pudo leer la configuración del puerto " << puerto << endl;
-                close(fd);
-            }
-        } else {
-            cout << "No se pudo abrir el puerto " << puerto << endl;
-            cout << "Verifica:" << endl;
-            cout << "  1. Que el Arduino esté conectado" << endl;
-            cout << "  2. Que tengas permisos: sudo chmod 666 " << puerto << endl;
-            cout << "  3. O que estés en el grupo dialout: sudo usermod -a -G dialout $USER" << endl;
-        }
-    }
-    
-    /**
-     * @brief Destructor - Cierra el puerto serial
-     */
-    ~SerialPort() {
-        if (conectado) {
-            close(fd);
-            cout << "Puerto cerrado." << endl;
-        }
-    }
-    
-    /**
-     * @brief Lee una línea del puerto serial
-     * @param buffer Buffer donde almacenar los datos
-     * @param maxLen Tamaño máximo del buffer
-     * @return true si se leyó correctamente
-     */
-    bool leerLinea(char* buffer, int maxLen) {
-        if (!conectado) return false;
-        
-        int pos = 0;
-        char c;
-        
-        while (pos < maxLen - 1) {
-            if (read(fd, &c, 1) > 0) {
-                if (c == '\n') {
-                    buffer[pos] = '\0';
-                    return true;
-                }
-                if (c != '\r') {
-                    buffer[pos++] = c;
-                }
-            }
-        }
-        
-        buffer[pos] = '\0';
-        return false;
-    }
-    
-    /**
-     * @brief Verifica si está conectado
-     * @return true si está conectado
-     */
-    bool estaConectado() const {
-        return conectado;
-    }
-};
-
 /**
  * @brief Muestra el menú principal
  */
 void mostrarMenu() {
+    // Los registros de la operación anterior deben salir antes del prompt
+    Registro::instancia().vaciar();
     cout << "\n=== Sistema IoT de Monitoreo Polimórfico ===" << endl;
     cout << "1. Crear Sensor de Temperatura (FLOAT)" << endl;
     cout << "2. Crear Sensor de Presión (INT)" << endl;
@@ -163,6 +77,12 @@ void mostrarMenu() {
     cout << "5. Ejecutar Procesamiento Polimórfico" << endl;
     cout << "6. Mostrar información de sensores" << endl;
     cout << "7. Cerrar Sistema" << endl;
+    cout << "8. Leer varios dispositivos (epoll)" << endl;
+    cout << "9. Configurar retención de un sensor" << endl;
+    cout << "10. Comprimir historial de un sensor" << endl;
+    cout << "11. Mostrar métricas" << endl;
+    cout << "12. Activar resúmenes por tiempo de un sensor" << endl;
+    cout << "13. Consultar un intervalo de tiempo de un sensor" << endl;
     cout << "Opción: ";
 }
 
@@ -178,18 +98,173 @@ bool esFloat(const char* valor) {
     return false;
 }
 
+/**
+ * @brief Convierte una hora de hoy "HH:MM[:SS]" al reloj de los historiales
+ * @param texto Hora local
+ * @param monotonoMs Recibe los milisegundos monótonos equivalentes
+ * @return false si el texto no es una hora válida
+ */
+bool horaDeHoy(const char* texto, long long& monotonoMs) {
+    int horas, minutos, segundos = 0;
+    char resto;
+    int campos = sscanf(texto, "%d:%d:%d%c", &horas, &minutos, &segundos, &resto);
+    if ((campos != 2 && campos != 3) || horas < 0 || horas > 23 || minutos < 0 || minutos > 59
+        || segundos < 0 || segundos > 59) {
+        return false;
+    }
+    time_t ahora = time(nullptr);
+    struct tm local;
+    localtime_r(&ahora, &local);
+    local.tm_hour = horas;
+    local.tm_min = minutos;
+    local.tm_sec = segundos;
+    local.tm_isdst = -1;
+    monotonoMs = monotonoDesdeEpocaMs((long long)mktime(&local) * 1000);
+    return true;
+}
+
+/**
+ * @brief Muestra el uso del modo sin menú
+ */
+void mostrarUso(const char* programa) {
+    cerr << "Uso: " << programa << " --manifiesto archivo [--entrada archivo|-|/dev/ttyX]" << endl
+         << "       [--intervalo segundos] [--formato csv|json] [--salida archivo] [--limite unidades]" << endl
+         << "Sin argumentos se abre el menú interactivo." << endl;
+}
+
+/**
+ * @brief Modo sin menú: lleva un flujo de lecturas a los sensores de un manifiesto
+ * @return Código de salida (0 = éxito, 1 = error de E/S o manifiesto, 2 = argumentos)
+ *
+ * Los resultados van a --salida (stdout por omisión) en CSV o JSON Lines;
+ * el resumen de la ingesta y los errores, a stderr.
+ */
+int ejecutarSinMenu(int argc, char* argv[]) {
+    const char* manifiesto = nullptr;
+    const char* entrada = "-";
+    const char* rutaSalida = nullptr;
+    double intervalo = 0.0;
+    long limite = -1;
+    FormatoLote formato = LOTE_CSV;
+    for (int i = 1; i < argc; i++) {
+        bool conValor = i + 1 < argc;
+        if (strcmp(argv[i], "--manifiesto") == 0 && conValor) {
+            manifiesto = argv[++i];
+        } else if (strcmp(argv[i], "--entrada") == 0 && conValor) {
+            entrada = argv[++i];
+        } else if (strcmp(argv[i], "--salida") == 0 && conValor) {
+            rutaSalida = argv[++i];
+        } else if (strcmp(argv[i], "--intervalo") == 0 && conValor) {
+            intervalo = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--limite") == 0 && conValor) {
+            limite = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--formato") == 0 && conValor) {
+            i++;
+            if (strcmp(argv[i], "json") == 0) {
+                formato = LOTE_JSON;
+            } else if (strcmp(argv[i], "csv") != 0) {
+                mostrarUso(argv[0]);
+                return 2;
+            }
+        } else {
+            mostrarUso(argv[0]);
+            return 2;
+        }
+    }
+    if (manifiesto == nullptr) {
+        mostrarUso(argv[0]);
+        return 2;
+    }
+
+    // Sensores y puertos anuncian su ciclo de vida por el registro (stderr), no
+    // en los resultados; queda en avisos salvo que IOT_NIVEL_REGISTRO diga otra cosa
+    if (getenv("IOT_NIVEL_REGISTRO") == nullptr) {
+        Registro::instancia().establecerNivel(NIVEL_AVISO);
+    }
+
+    int codigo = 0;
+    FILE* salida = rutaSalida != nullptr ? fopen(rutaSalida, "w") : stdout;
+    if (salida == nullptr) {
+        REGISTRO_ERROR("No se pudo abrir el archivo de salida " << rutaSalida);
+        Registro::instancia().vaciar();
+        return 1;
+    }
+    {
+        ListaGestion gestor;
+        ModoLote lote(gestor, salida, formato, intervalo);
+        int fd = strcmp(entrada, "-") == 0 ? 0 : open(entrada, O_RDONLY | O_NOCTTY);
+        if (lote.cargarManifiesto(manifiesto) < 0) {
+            codigo = 1;
+        } else if (fd < 0) {
+            REGISTRO_ERROR("No se pudo abrir la entrada " << entrada);
+            codigo = 1;
+        } else {
+            // Solo un dispositivo nombrado explícitamente (ruta a una terminal) se
+            // pasa a modo raw; stdin se lee tal cual para que Ctrl-C/Ctrl-D sigan funcionando
+            SerialPort puerto(fd, fd != 0, 1000, fd != 0 && isatty(fd));
+            lote.iniciarSalida();
+            lote.ingerir(puerto, limite);
+            lote.imprimirResumen(stderr);
+            fd = -1;
+        }
+        if (fd > 0) close(fd);
+    }
+    if (salida != stdout) fclose(salida);
+    Registro::instancia().vaciar();
+    return codigo;
+}
+
 /**
  * @brief Función principal del programa
+ * 
+ * Con argumentos se ejecuta sin menú (ejecutarSinMenu()).
  */
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        return ejecutarSinMenu(argc, argv);
+    }
+    
     ListaGestion gestorSensores;
     SensorBase* sensorTemp = nullptr;
     SensorBase* sensorPres = nullptr;
     
     cout << "--- Sistema IoT de Monitoreo Polimórfico ---\n" << endl;
     
+    // Persistencia opcional: con IOT_DIRECTORIO_DATOS los sensores y sus
+    // lecturas sobreviven al cierre del programa
+    AlmacenPersistente* almacen = nullptr;
+    const char* directorioDatos = getenv("IOT_DIRECTORIO_DATOS");
+    if (directorioDatos != nullptr && directorioDatos[0] != '\0') {
+        almacen = new AlmacenPersistente(gestorSensores, directorioDatos);
+        int restaurados = almacen->restaurar();
+        cout << restaurados << " sensores restaurados desde " << almacen->getDirectorio() << "." << endl;
+    }
+    
+    // Métricas opcionales: con IOT_ARCHIVO_METRICAS se reescribe ese archivo
+    // cada IOT_INTERVALO_METRICAS segundos (10 por omisión)
+    ExportadorMetricas* exportador = nullptr;
+    const char* archivoMetricas = getenv("IOT_ARCHIVO_METRICAS");
+    if (archivoMetricas != nullptr && archivoMetricas[0] != '\0') {
+        const char* intervalo = getenv("IOT_INTERVALO_METRICAS");
+        exportador = new ExportadorMetricas(gestorSensores, archivoMetricas,
+                                            intervalo != nullptr ? atof(intervalo) : 10.0);
+    }
+    
+    // Con IOT_INTERVALO_PROCESO la lectura del Arduino ejecuta el procesamiento
+    // polimórfico cada tantos segundos sin dejar de leer el puerto
+    const char* variableProceso = getenv("IOT_INTERVALO_PROCESO");
+    double intervaloProceso = variableProceso != nullptr ? atof(variableProceso) : 0.0;
+    
+    // La opción 5 procesa en el pool de hilos solo desde IOT_PROCESO_PARALELO
+    // sensores; con pocos, arrancar el pool cuesta más que procesarlos en serie
+    const char* variableParalelo = getenv("IOT_PROCESO_PARALELO");
+    int minimoParalelo = variableParalelo != nullptr ? atoi(variableParalelo) : 0;
+    
     int opcion;
     do {
+        if (almacen != nullptr) {
+            almacen->sincronizar();
+        }
         mostrarMenu();
         cin >> opcion;
         cin.ignore(); // Limpiar buffer
@@ -202,6 +277,9 @@ int main() {
                 
                 sensorTemp = new SensorTemperatura(nombre);
                 gestorSensores.insertar(sensorTemp);
+                if (almacen != nullptr) {
+                    almacen->adjuntar(sensorTemp);
+                }
                 break;
             }
             
@@ -212,6 +290,9 @@ int main() {
                 
                 sensorPres = new SensorPresion(nombre);
                 gestorSensores.insertar(sensorPres);
+                if (almacen != nullptr) {
+                    almacen->adjuntar(sensorPres);
+                }
                 break;
             }
             
@@ -225,37 +306,47 @@ int main() {
                 cin >> numLecturas;
                 cin.ignore();
                 
-                SerialPort serial(puerto);
+                SerialPort* serial = new SerialPort(puerto);
                 
-                if (serial.estaConectado()) {
+                if (serial->estaConectado()) {
                     cout << "\nLeyendo " << numLecturas << " valores del Arduino..." << endl;
                     
-                    char buffer[100];
-                    int lecturas = 0;
-                    
-                    while (lecturas < numLecturas) {
-                        if (serial.leerLinea(buffer, 100)) {
-                            cout << "Valor recibido: " << buffer << endl;
-                            
-                            // Determinar tipo y asignar al sensor correspondiente
-                            if (esFloat(buffer)) {
-                                if (sensorTemp != nullptr) {
-                                    sensorTemp->agregarLectura(buffer);
-                                } else {
-                                    cout << "No hay sensor de temperatura creado." << endl;
-                                }
+                    // Un hilo lee el puerto mientras este entrega las lecturas a los sensores
+                    TuberiaIngesta tuberia(gestorSensores, serial);
+                    tuberia.establecerIntervaloProceso(intervaloProceso);
+                    tuberia.establecerSinEtiqueta([&](const char* linea) {
+                        cout << "Valor recibido: " << linea << endl;
+                        
+                        // Sin etiqueta: asignar al último sensor creado de ese tipo
+                        if (esFloat(linea)) {
+                            if (sensorTemp != nullptr) {
+                                sensorTemp->agregarLectura(linea);
                             } else {
-                                if (sensorPres != nullptr) {
-                                    sensorPres->agregarLectura(buffer);
-                                } else {
-                                    cout << "No hay sensor de presión creado." << endl;
-                                }
+                                cout << "No hay sensor de temperatura creado." << endl;
+                            }
+                        } else {
+                            if (sensorPres != nullptr) {
+                                sensorPres->agregarLectura(linea);
+                            } else {
+                                cout << "No hay sensor de presión creado." << endl;
                             }
-                            lecturas++;
                         }
-                    }
+                    });
+                    tuberia.ejecutar(numLecturas);
                     
-                    cout << "Lectura completada." << endl;
+                    const SerialPort& leido = tuberia.getPuerto();
+                    cout << "Lectura completada (" << leido.getBytesLeidos() << " bytes, "
+                         << leido.getLineasLeidas() << " líneas, "
+                         << leido.lineasPorSegundo() << " líneas/s)." << endl;
+                    const EnrutadorLineas& enrutador = tuberia.getEnrutador();
+                    if (enrutador.getDesconocidas() > 0 || enrutador.getInvalidas() > 0) {
+                        cout << "Líneas etiquetadas descartadas: " << enrutador.getDesconocidas()
+                             << " con ID desconocido, " << enrutador.getInvalidas()
+                             << " con valor inválido." << endl;
+                    }
+                    tuberia.imprimirEstadisticas();
+                } else {
+                    delete serial;
                 }
                 break;
             }
@@ -272,6 +363,7 @@ int main() {
                 SensorBase* sensor = gestorSensores.buscar(nombre);
                 if (sensor != nullptr) {
                     sensor->agregarLectura(valor);
+                    cout << "Lectura registrada en " << sensor->getNombre() << "." << endl;
                 } else {
                     cout << "Sensor no encontrado." << endl;
                 }
@@ -279,7 +371,10 @@ int main() {
             }
             
             case 5: {
-                if (!gestorSensores.estaVacia()) {
+                if (!gestorSensores.estaVacia() && minimoParalelo > 0 &&
+                    gestorSensores.getTamanio() >= minimoParalelo) {
+                    gestorSensores.procesarTodosParalelo();
+                } else if (!gestorSensores.estaVacia()) {
                     gestorSensores.procesarTodos();
                 } else {
                     cout << "No hay sensores registrados." << endl;
@@ -301,11 +396,136 @@ int main() {
                 break;
             }
             
+            case 8: {
+                int numPuertos;
+                cout << "Número de dispositivos: ";
+                cin >> numPuertos;
+                cin.ignore();
+                
+                MotorIngesta motor(gestorSensores);
+                for (int i = 0; i < numPuertos; i++) {
+                    char puerto[50];
+                    char nombre[50];
+                    cout << "Puerto #" << i + 1 << " (ej: /dev/ttyACM0): ";
+                    cin.getline(puerto, 50);
+                    cout << "ID del sensor destino (vacío si envía \"ID:valor\"): ";
+                    cin.getline(nombre, 50);
+                    if (motor.agregarPuerto(puerto, nombre) < 0) {
+                        cout << "No se registró el puerto (sensor inexistente o puerto no disponible)." << endl;
+                    }
+                }
+                
+                if (motor.getNumPuntos() > 0) {
+                    long numLecturas;
+                    cout << "Número total de lecturas a tomar: ";
+                    cin >> numLecturas;
+                    cin.ignore();
+                    
+                    motor.ejecutar(numLecturas, 5000);
+                    motor.imprimirEstadisticas();
+                }
+                break;
+            }
+            
+            case 9: {
+                char nombre[50];
+                int lecturas;
+                double segundos;
+                cout << "ID del sensor: ";
+                cin.getline(nombre, 50);
+                cout << "Máximo de lecturas a conservar (0 = sin límite): ";
+                cin >> lecturas;
+                cout << "Antigüedad máxima en segundos (0 = sin límite): ";
+                cin >> segundos;
+                cin.ignore();
+                
+                SensorBase* sensor = gestorSensores.buscar(nombre);
+                if (sensor != nullptr) {
+                    sensor->establecerRetencion(lecturas, segundos);
+                    cout << "Retención actualizada para " << sensor->getNombre() << "." << endl;
+                } else {
+                    cout << "Sensor no encontrado." << endl;
+                }
+                break;
+            }
+            
+            case 10: {
+                char nombre[50];
+                cout << "ID del sensor: ";
+                cin.getline(nombre, 50);
+                
+                SensorBase* sensor = gestorSensores.buscar(nombre);
+                if (sensor != nullptr) {
+                    sensor->activarCompresion();
+                    cout << "Historial de " << sensor->getNombre() << " comprimido." << endl;
+                } else {
+                    cout << "Sensor no encontrado." << endl;
+                }
+                break;
+            }
+            
+            case 11:
+                gestorSensores.imprimirMetricas();
+                break;
+            
+            case 12: {
+                char nombre[50];
+                cout << "ID del sensor: ";
+                cin.getline(nombre, 50);
+                
+                SensorBase* sensor = gestorSensores.buscar(nombre);
+                if (sensor != nullptr) {
+                    sensor->activarResumenes();
+                    cout << "Resúmenes por segundo, minuto, hora y día activos para "
+                         << sensor->getNombre() << "." << endl;
+                } else {
+                    cout << "Sensor no encontrado." << endl;
+                }
+                break;
+            }
+            
+            case 13: {
+                char nombre[50];
+                char inicio[20];
+                char fin[20];
+                cout << "ID del sensor: ";
+                cin.getline(nombre, 50);
+                cout << "Desde (HH:MM[:SS] de hoy): ";
+                cin.getline(inicio, 20);
+                cout << "Hasta (HH:MM[:SS] de hoy): ";
+                cin.getline(fin, 20);
+                
+                SensorBase* sensor = gestorSensores.buscar(nombre);
+                long long desdeMs, hastaMs;
+                if (sensor == nullptr) {
+                    cout << "Sensor no encontrado." << endl;
+                } else if (!horaDeHoy(inicio, desdeMs) || !horaDeHoy(fin, hastaMs)) {
+                    cout << "Hora inválida." << endl;
+                } else {
+                    // El segundo final se incluye completo
+                    ResumenVentana r = sensor->consultarResumen(desdeMs, hastaMs + 999);
+                    if (r.lecturas == 0) {
+                        cout << "Sin lecturas en el intervalo." << endl;
+                    } else {
+                        cout << sensor->getNombre() << ": " << r.lecturas << " lecturas, promedio "
+                             << r.promedio << ", mínimo " << r.minimo << ", máximo " << r.maximo << endl;
+                        if (r.resolucionMs > 0) {
+                            cout << "(bordes aproximados a " << r.resolucionMs / 1000 << " s)" << endl;
+                        }
+                    }
+                }
+                break;
+            }
+            
             default:
                 cout << "Opción inválida." << endl;
         }
         
     } while (opcion != 7);
     
+    // El exportador hace su última escritura antes de que se destruyan los sensores
+    delete exportador;
+    // Los segmentos se confirman al destruir cada sensor (fin de gestorSensores)
+    delete almacen;
     return 0;
 }
\ No newline at end of file